@@ -0,0 +1,276 @@
+#include "bench.h"
+#include "../src/address.h"
+#include "../src/batch.h"
+#include "../src/bip39.h"
+#include "../src/electrum.h"
+#include "../src/mnemonic.h"
+#include "../src/pbkdf2_sha512/hash160_lanes.h"
+#include "../src/screen.h"
+#include "../src/utils.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace
+{
+std::atomic<uint64_t> allocCount{0};
+std::atomic<uint64_t> allocBytes{0};
+
+void* countedAlloc(size_t size, size_t alignment = 0)
+{
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(size, std::memory_order_relaxed);
+    if (size == 0)
+        size = 1;
+    void* p = nullptr;
+    if (alignment > alignof(std::max_align_t)) {
+        // aligned_alloc wants the size rounded up to the alignment
+        p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    } else {
+        p = std::malloc(size);
+    }
+    return p;
+}
+}    // namespace
+
+void* operator new(size_t size)
+{
+    if (void* p = countedAlloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    if (void* p = countedAlloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    if (void* p = countedAlloc(size, static_cast<size_t>(alignment)))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    if (void* p = countedAlloc(size, static_cast<size_t>(alignment)))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+AllocStats allocStats() noexcept
+{
+    return {allocCount.load(), allocBytes.load()};
+}
+
+int benchAlloc(const BenchOptions& options)
+{
+    struct Case
+    {
+        const char* name;
+        size_t itemsPerCall;
+        size_t iterations;
+        std::function<void()> op;
+    };
+
+    static const char entropy[] =
+        "68a79eaca2324873eacc50cb9c6eca8cc68ea5d936f98787c60c7ebc74e6ce7c";
+    Mnemonic mnemonic = BIP39::Entropy(entropy);
+    const std::string phrase = BIP39_Utils::Join(mnemonic.words, " ");
+    std::vector<Mnemonic> mnemonics;
+    std::vector<std::string> phrases;
+    // fixed entropies: phrase lengths drive string growth, so random ones would make counts drift
+    for (int i = 0; i < 64; i++) {
+        std::string hex(32 + 8 * (i % 5), '0');
+        for (size_t k = 0; k < hex.size(); k++) {
+            hex[k] = "0123456789abcdef"[(i * 7 + k * 3) % 16];
+        }
+        mnemonics.emplace_back(BIP39::Entropy(hex));
+        phrases.emplace_back(BIP39_Utils::Join(mnemonics.back().words, " "));
+    }
+    // one thread keeps thread-start allocations out of the counts and the counts host-independent
+    BatchConfig single = SeedBatch::defaultConfig();
+    single.threads = 1;
+    SeedBatch::configure(single);
+    const SeedClassifier classifier;
+
+    std::vector<std::string> screened;
+    for (uint32_t i = 0; i < 100000; i++) {
+        std::string e(16, '\0');
+        memcpy(&e[0], &i, sizeof(i));
+        screened.push_back(e);
+    }
+    const std::string screenFile = "bench-screen.bin";
+    MnemonicScreen::build(screened, screenFile);
+    const MnemonicScreen screen(screenFile);
+    std::remove(screenFile.c_str());
+    const std::string probe = BIP39_Utils::base16Decode(entropy);
+    auto probeBytes = reinterpret_cast<const uint8_t*>(probe.data());
+    std::vector<uint8_t> pubkeys(1024 * HASH160_COMPRESSED_PUBKEY_LENGTH);
+    for (size_t i = 0; i < pubkeys.size(); i++) {
+        pubkeys[i] = (uint8_t)(i * 167);
+    }
+    std::vector<uint8_t> hash160s(1024 * HASH160_DIGEST_LENGTH);
+    std::vector<int> indices(mnemonic.words.size());
+
+    const std::vector<Case> cases = {
+        {"BIP39::Entropy", 1, 2000, [&] { BIP39::Entropy(entropy); }},
+        {"BIP39::Generate", 1, 2000, [&] { BIP39::Generate(24); }},
+        {"BIP39::Words", 1, 2000, [&] { BIP39::Words(phrase); }},
+        {"Wordlist::findIndexCT",
+         1,
+         200000,
+         [&] { Wordlist::english()->findIndexCT(mnemonic.words[3]); }},
+        {"Wordlist::findIndexCT[]",
+         mnemonic.words.size(),
+         20000,
+         [&] {
+             Wordlist::english()->findIndexCT(
+                 mnemonic.words.data(), mnemonic.words.size(), indices.data());
+         }},
+        {"Mnemonic::generateSeed", 1, 20, [&] { mnemonic.generateSeed("TREZOR"); }},
+        {"SeedBatch::generateSeeds",
+         mnemonics.size(),
+         1,
+         [&] { SeedBatch::generateSeeds(mnemonics, "TREZOR"); }},
+        {"MnemonicScreen::contains",
+         1,
+         200000,
+         [&] { screen.contains(probeBytes, probe.size()); }},
+        {"hash160_compressed_lanes",
+         1024,
+         20,
+         [&] {
+             hash160_compressed_lanes(
+                 sha512_kernel_default(), 1024, pubkeys.data(), hash160s.data());
+         }},
+        {"AddressCodec::base58Addresses",
+         1024,
+         20,
+         [&] { AddressCodec::base58Addresses(0, hash160s.data(), 1024); }},
+        {"AddressCodec::segwitAddresses",
+         1024,
+         20,
+         [&] { AddressCodec::segwitAddresses("bc", hash160s.data(), 1024); }},
+        {"SeedClassifier::classify",
+         phrases.size(),
+         20,
+         [&] { classifier.classify(phrases); }},
+    };
+
+    std::vector<BenchResult> results;
+    for (const auto& c : cases) {
+        c.op();    // first use loads the wordlist
+        const size_t items = c.itemsPerCall * c.iterations;
+        const AllocStats before = allocStats();
+        for (size_t i = 0; i < c.iterations; i++) {
+            c.op();
+        }
+        const AllocStats after = allocStats();
+
+        BenchResult r;
+        r.name = c.name;
+        r.unit = "ns/op";
+        for (int k = 0; k < options.repeat; k++) {
+            r.samples.push_back(timePerOp(c.op, c.iterations) / c.itemsPerCall);
+        }
+        r.metrics.emplace_back("allocs_per_op", double(after.count - before.count) / items);
+        r.metrics.emplace_back("bytes_per_op", double(after.bytes - before.bytes) / items);
+        results.push_back(std::move(r));
+    }
+
+    printResults("alloc", results);
+    if (!options.json.empty() && !writeJson(options.json, "alloc", results)) {
+        fprintf(stderr, "cannot write %s\n", options.json.c_str());
+        return 2;
+    }
+    static const char* const counted[] = {"allocs_per_op", "bytes_per_op", nullptr};
+    if (!options.writeBaseline.empty() &&
+        !writeBaseline(options.writeBaseline, results, counted)) {
+        fprintf(stderr, "cannot write %s\n", options.writeBaseline.c_str());
+        return 2;
+    }
+    if (options.baseline.empty())
+        return 0;
+
+    std::map<std::string, double> baseline;
+    if (!readBaseline(options.baseline, baseline)) {
+        fprintf(stderr, "cannot read %s\n", options.baseline.c_str());
+        return 2;
+    }
+    int regressions = 0;
+    for (const auto& r : results) {
+        for (const auto& m : r.metrics) {
+            auto it = baseline.find(r.name + " " + m.first);
+            if (it == baseline.end())
+                continue;
+            // baselines are printed with limited precision, allow for the rounding
+            if (m.second > it->second * (1 + options.tolerance) + 0.01) {
+                printf(
+                    "REGRESSION %s %s: %.2f > baseline %.2f\n",
+                    r.name.c_str(),
+                    m.first.c_str(),
+                    m.second,
+                    it->second);
+                ++regressions;
+            }
+        }
+    }
+    return regressions ? 1 : 0;
+}
@@ -0,0 +1,64 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct BenchResult
+{
+    std::string name;
+    std::string unit;
+    bool higherIsBetter{false};
+    std::vector<double> samples;    // one per repetition, in `unit`
+    std::vector<std::pair<std::string, double>> metrics;
+};
+
+struct BenchOptions
+{
+    int repeat{5};
+    std::string json;             // write results here as JSON
+    std::string baseline;         // fail when results regress above this file
+    std::string writeBaseline;    // record results as the new baseline
+    double tolerance{0};          // allowed relative growth over the baseline
+    std::vector<std::string> args;
+};
+
+struct AllocStats
+{
+    uint64_t count;
+    uint64_t bytes;
+};
+
+// Totals of the interposed operator new since process start.
+AllocStats allocStats() noexcept;
+
+// Time of one call of `op`, in nanoseconds, averaged over `iterations` calls.
+double timePerOp(const std::function<void()>& op, size_t iterations);
+
+double mean(const std::vector<double>& v);
+double stddev(const std::vector<double>& v);
+
+void printResults(const std::string& suite, const std::vector<BenchResult>& results);
+bool writeJson(
+    const std::string& path, const std::string& suite, const std::vector<BenchResult>& results);
+
+// Reads "name metric value" lines; returns false when the file cannot be read.
+bool readBaseline(const std::string& path, std::map<std::string, double>& baseline);
+bool writeBaseline(
+    const std::string& path, const std::vector<BenchResult>& results, const char* const* metrics);
+
+int benchAlloc(const BenchOptions& options);
+int benchScaling(const BenchOptions& options);
+// `self` is the path of this executable, re-run for every cold-start sample.
+int benchColdstart(const BenchOptions& options, const char* self);
+int coldstartChild(const std::string& mode);
+int benchLoad(const BenchOptions& options);
+// Exits 1 when a benchmark regressed significantly beyond the threshold.
+int benchCompare(const BenchOptions& options);
+
+#endif // BENCH_H
@@ -0,0 +1,172 @@
+#include "bench.h"
+#include "../src/batch.h"
+#include "../src/bip39.h"
+#include "../src/mnemonic.h"
+
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+#    include <sys/wait.h>
+#    include <unistd.h>
+#endif
+
+/*
+ * Cold start: every sample is a fresh process (this executable re-run as
+ * "bench coldstart-child <mode>"), timed from just before fork() to the child's milestones.
+ * steady_clock is CLOCK_MONOTONIC, so parent and child timestamps are comparable. The
+ * wordlist files stay in the page cache between samples, as they would for a busy host.
+ */
+namespace
+{
+uint64_t monotonicNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Child mode name and the milestones it prints, in order.
+struct Mode
+{
+    const char* name;
+    std::vector<const char*> milestones;
+};
+
+const std::vector<Mode>& modes()
+{
+    static const std::vector<Mode> all = {
+        {"lazy", {"main", "first mnemonic", "first seed"}},
+        {"preload", {"main", "preload", "first mnemonic", "first seed"}},
+        {"breakdown",
+         {"main",
+          "wordlist load",
+          "batch config",
+          "entropy + mnemonic",
+          "pbkdf2 seed",
+          "seed batch"}},
+    };
+    return all;
+}
+
+#ifndef _WIN32
+// Runs one child; fills `stamps` with its milestone times relative to `start`, in microseconds.
+bool spawn(const char* self, const char* mode, std::vector<double>& stamps)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+    const uint64_t start = monotonicNs();
+    const pid_t pid = fork();
+    if (pid < 0)
+        return false;
+    if (pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        execl(self, self, "coldstart-child", mode, (char*)nullptr);
+        _exit(127);
+    }
+    close(fds[1]);
+    std::string out;
+    char buf[256];
+    for (ssize_t n; (n = read(fds[0], buf, sizeof(buf))) > 0;) {
+        out.append(buf, n);
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        return false;
+
+    stamps.clear();
+    const char* p = out.c_str();
+    char* end;
+    for (unsigned long long ns; (ns = strtoull(p, &end, 10)), end != p; p = end) {
+        stamps.push_back((double(ns) - double(start)) / 1000);
+    }
+    return true;
+}
+#endif
+}    // namespace
+
+int coldstartChild(const std::string& mode)
+{
+    std::vector<uint64_t> stamps{monotonicNs()};
+    auto mark = [&] { stamps.push_back(monotonicNs()); };
+
+    if (mode == "lazy" || mode == "preload") {
+        if (mode == "preload") {
+            BIP39::preload();
+            mark();
+        }
+        Mnemonic mnemonic = BIP39::Generate(12);
+        mark();
+        mnemonic.generateSeed();
+        mark();
+    } else if (mode == "breakdown") {
+        Wordlist::english();
+        mark();
+        const BatchConfig config = SeedBatch::config();
+        mark();
+        Mnemonic mnemonic = BIP39::Generate(12);
+        mark();
+        mnemonic.generateSeed();
+        mark();
+        SeedBatch::generateSeeds(std::vector<Mnemonic>(config.lanes, mnemonic));
+        mark();
+    } else {
+        return 2;
+    }
+    for (uint64_t ns : stamps) {
+        printf("%llu\n", (unsigned long long)ns);
+    }
+    return 0;
+}
+
+int benchColdstart(const BenchOptions& options, const char* self)
+{
+#ifdef _WIN32
+    (void)options;
+    (void)self;
+    fprintf(stderr, "coldstart needs fork/exec\n");
+    return 2;
+#else
+    if (access("/proc/self/exe", X_OK) == 0)
+        self = "/proc/self/exe";
+    std::vector<BenchResult> results;
+    for (const Mode& mode : modes()) {
+        const size_t count = mode.milestones.size();
+        std::vector<std::vector<double>> samples(count);
+        for (int k = 0; k < options.repeat; k++) {
+            std::vector<double> stamps;
+            if (!spawn(self, mode.name, stamps) || stamps.size() != count) {
+                fprintf(stderr, "coldstart child '%s' failed\n", mode.name);
+                return 2;
+            }
+            for (size_t i = 0; i < count; i++) {
+                // the breakdown reports each step on its own, the other modes time from start
+                const bool step = !strcmp(mode.name, "breakdown") && i > 0;
+                samples[i].push_back(step ? stamps[i] - stamps[i - 1] : stamps[i]);
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            BenchResult r;
+            r.name = std::string(mode.name) + ": " +
+                     (i == 0 ? "start -> main"
+                             : (!strcmp(mode.name, "breakdown") ? "" : "start -> ") +
+                                   std::string(mode.milestones[i]));
+            r.unit = "us";
+            r.samples = std::move(samples[i]);
+            results.push_back(std::move(r));
+        }
+    }
+
+    printResults("coldstart", results);
+    if (!options.json.empty() && !writeJson(options.json, "coldstart", results)) {
+        fprintf(stderr, "cannot write %s\n", options.json.c_str());
+        return 2;
+    }
+    return 0;
+#endif
+}
@@ -0,0 +1,339 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+/*
+ * Compares two sets of bench --json result files. Samples of the same benchmark are pooled
+ * across the files of a side, so several runs of each build can be given comma separated.
+ * A benchmark regresses when Welch's t-test finds the difference significant at 95% and the
+ * mean moved in the wrong direction by more than the threshold.
+ */
+namespace
+{
+// Reads the subset of JSON that writeJson() produces.
+class JsonReader
+{
+public:
+    explicit JsonReader(const std::string& text) : m_text{text} {}
+
+    bool results(std::vector<BenchResult>& out)
+    {
+        if (!expect('{'))
+            return false;
+        while (!peek('}')) {
+            std::string key;
+            if (!quoted(key) || !expect(':'))
+                return false;
+            if (key == "results") {
+                if (!resultList(out))
+                    return false;
+            } else if (!skip()) {
+                return false;
+            }
+            if (!peek('}') && !expect(','))
+                return false;
+        }
+        return expect('}');
+    }
+
+private:
+    bool resultList(std::vector<BenchResult>& out)
+    {
+        if (!expect('['))
+            return false;
+        while (!peek(']')) {
+            BenchResult r;
+            if (!result(r))
+                return false;
+            out.push_back(std::move(r));
+            if (!peek(']') && !expect(','))
+                return false;
+        }
+        return expect(']');
+    }
+
+    bool result(BenchResult& r)
+    {
+        if (!expect('{'))
+            return false;
+        while (!peek('}')) {
+            std::string key;
+            if (!quoted(key) || !expect(':'))
+                return false;
+            bool ok;
+            if (key == "name")
+                ok = quoted(r.name);
+            else if (key == "unit")
+                ok = quoted(r.unit);
+            else if (key == "higher_is_better")
+                ok = boolean(r.higherIsBetter);
+            else if (key == "samples")
+                ok = numbers(r.samples);
+            else
+                ok = skip();
+            if (!ok || (!peek('}') && !expect(',')))
+                return false;
+        }
+        return expect('}');
+    }
+
+    bool numbers(std::vector<double>& out)
+    {
+        if (!expect('['))
+            return false;
+        while (!peek(']')) {
+            double v;
+            if (!number(v))
+                return false;
+            out.push_back(v);
+            if (!peek(']') && !expect(','))
+                return false;
+        }
+        return expect(']');
+    }
+
+    // Skips any value.
+    bool skip()
+    {
+        space();
+        if (m_pos >= m_text.size())
+            return false;
+        const char c = m_text[m_pos];
+        if (c == '"') {
+            std::string s;
+            return quoted(s);
+        }
+        if (c == '{' || c == '[') {
+            const char close = c == '{' ? '}' : ']';
+            ++m_pos;
+            while (!peek(close)) {
+                if (c == '{') {
+                    std::string key;
+                    if (!quoted(key) || !expect(':'))
+                        return false;
+                }
+                if (!skip() || (!peek(close) && !expect(',')))
+                    return false;
+            }
+            return expect(close);
+        }
+        if (c == 't' || c == 'f') {
+            bool b;
+            return boolean(b);
+        }
+        if (m_text.compare(m_pos, 4, "null") == 0) {
+            m_pos += 4;
+            return true;
+        }
+        double v;
+        return number(v);
+    }
+
+    bool quoted(std::string& out)
+    {
+        if (!expect('"'))
+            return false;
+        out.clear();
+        while (m_pos < m_text.size() && m_text[m_pos] != '"') {
+            if (m_text[m_pos] == '\\' && ++m_pos >= m_text.size())
+                return false;
+            out += m_text[m_pos++];
+        }
+        return expect('"');
+    }
+
+    bool boolean(bool& out)
+    {
+        space();
+        if (m_text.compare(m_pos, 4, "true") == 0) {
+            m_pos += 4;
+            out = true;
+            return true;
+        }
+        if (m_text.compare(m_pos, 5, "false") == 0) {
+            m_pos += 5;
+            out = false;
+            return true;
+        }
+        return false;
+    }
+
+    bool number(double& out)
+    {
+        space();
+        const char* begin = m_text.c_str() + m_pos;
+        char* end;
+        out = strtod(begin, &end);
+        if (end == begin)
+            return false;
+        m_pos += end - begin;
+        return true;
+    }
+
+    void space()
+    {
+        while (m_pos < m_text.size() && std::isspace((unsigned char)m_text[m_pos])) {
+            ++m_pos;
+        }
+    }
+
+    bool peek(char c)
+    {
+        space();
+        return m_pos < m_text.size() && m_text[m_pos] == c;
+    }
+
+    bool expect(char c)
+    {
+        if (!peek(c))
+            return false;
+        ++m_pos;
+        return true;
+    }
+
+    const std::string& m_text;
+    size_t m_pos{0};
+};
+
+bool readResults(const std::string& files, std::vector<BenchResult>& pooled)
+{
+    std::istringstream list(files);
+    std::string path;
+    while (std::getline(list, path, ',')) {
+        std::ifstream file(path);
+        std::stringstream text;
+        text << file.rdbuf();
+        std::vector<BenchResult> results;
+        if (!file || !JsonReader(text.str()).results(results)) {
+            fprintf(stderr, "cannot read results from %s\n", path.c_str());
+            return false;
+        }
+        for (auto& r : results) {
+            auto it = std::find_if(pooled.begin(), pooled.end(), [&](const BenchResult& p) {
+                return p.name == r.name;
+            });
+            if (it == pooled.end())
+                pooled.push_back(std::move(r));
+            else
+                it->samples.insert(it->samples.end(), r.samples.begin(), r.samples.end());
+        }
+    }
+    return true;
+}
+
+// Two-sided 95% quantile of Student's t distribution.
+double tQuantile(double df)
+{
+    static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                   2.262,  2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                                   2.110,  2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                                   2.060,  2.056, 2.052, 2.048, 2.045, 2.042};
+    if (df < 1)
+        return table[0];
+    if (df <= 30)
+        return table[(int)df - 1];
+    // the quantile approaches the normal one roughly linearly in 1/df
+    return 1.960 + (table[29] - 1.960) * 30 / df;
+}
+
+struct Comparison
+{
+    double delta;        // relative change of the mean, new vs base
+    double low, high;    // 95% confidence interval of delta
+    bool significant;
+    bool known;    // false when a side has fewer than two samples
+};
+
+Comparison compare(const std::vector<double>& base, const std::vector<double>& next)
+{
+    const double m1 = mean(base), m2 = mean(next);
+    Comparison c{m1 != 0 ? (m2 - m1) / m1 : 0, 0, 0, false, false};
+    if (base.size() < 2 || next.size() < 2 || m1 == 0)
+        return c;
+    const double v1 = stddev(base) * stddev(base) / base.size();
+    const double v2 = stddev(next) * stddev(next) / next.size();
+    const double se = std::sqrt(v1 + v2);
+    c.known = true;
+    if (se == 0) {
+        c.significant = m1 != m2;
+        c.low = c.high = c.delta;
+        return c;
+    }
+    // Welch-Satterthwaite degrees of freedom
+    const double df =
+        (v1 + v2) * (v1 + v2) / (v1 * v1 / (base.size() - 1) + v2 * v2 / (next.size() - 1));
+    const double t = tQuantile(df);
+    c.significant = std::fabs(m2 - m1) > t * se;
+    c.low = (m2 - m1 - t * se) / m1;
+    c.high = (m2 - m1 + t * se) / m1;
+    return c;
+}
+}    // namespace
+
+int benchCompare(const BenchOptions& options)
+{
+    std::vector<std::string> files;
+    double threshold = 5;
+    for (size_t i = 0; i < options.args.size(); i++) {
+        if (options.args[i] == "--threshold" && i + 1 < options.args.size())
+            threshold = atof(options.args[++i].c_str());
+        else
+            files.push_back(options.args[i]);
+    }
+    if (files.size() != 2) {
+        fprintf(stderr, "usage: bench compare BASE.json[,...] NEW.json[,...] [--threshold PCT]\n");
+        return 2;
+    }
+    std::vector<BenchResult> base, next;
+    if (!readResults(files[0], base) || !readResults(files[1], next))
+        return 2;
+
+    printf(
+        "%-40s %14s %14s %9s  %-19s %s\n", "benchmark", "base", "new", "delta", "95% ci", "");
+    int regressions = 0;
+    for (const auto& b : base) {
+        auto it = std::find_if(next.begin(), next.end(), [&](const BenchResult& n) {
+            return n.name == b.name;
+        });
+        if (it == next.end()) {
+            printf("%-40s %14.1f %14s\n", b.name.c_str(), mean(b.samples), "missing");
+            continue;
+        }
+        const Comparison c = compare(b.samples, it->samples);
+        // positive means worse, whichever direction the unit counts
+        const double worse = b.higherIsBetter ? -c.delta : c.delta;
+        const bool regression = c.significant && worse * 100 > threshold;
+        const char* marker = !c.known         ? "?"
+                             : regression     ? "REGRESSION"
+                             : !c.significant ? ""
+                             : worse > 0      ? "worse"
+                                              : "better";
+        char interval[32] = "";
+        if (c.known)
+            snprintf(interval, sizeof(interval), "[%+.1f%%, %+.1f%%]", c.low * 100, c.high * 100);
+        printf(
+            "%-40s %14.1f %14.1f %+8.1f%%  %-19s %s\n",
+            b.name.c_str(),
+            mean(b.samples),
+            mean(it->samples),
+            c.delta * 100,
+            interval,
+            marker);
+        regressions += regression;
+    }
+    for (const auto& n : next) {
+        if (std::none_of(base.begin(), base.end(), [&](const BenchResult& b) {
+                return b.name == n.name;
+            }))
+            printf("%-40s %14s %14.1f\n", n.name.c_str(), "new", mean(n.samples));
+    }
+    if (regressions)
+        printf("%d regression(s) beyond %.1f%%\n", regressions, threshold);
+    return regressions ? 1 : 0;
+}
@@ -0,0 +1,369 @@
+#include "bench.h"
+#include "../src/bip39.h"
+#include "../src/mnemonic.h"
+#include "../src/utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+
+/*
+ * Load generator for a derivation service built on this library. There is no daemon or
+ * transport in the tree, so the service is modelled in process: a FIFO request queue
+ * drained by a fixed pool of workers calling the public API.
+ *
+ * Open loop: requests arrive as a Poisson process at --rate, independent of completions.
+ * Latency is measured from each request's scheduled arrival, so a late dispatcher or a
+ * backed-up queue is charged to the request (coordinated-omission correction); the
+ * uncorrected latency from the actual enqueue is reported next to it.
+ * Closed loop: --clients clients each issue the next request when the previous completes.
+ */
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+enum Op { GENERATE, VALIDATE, SEED, SEED_PASSPHRASE, OP_COUNT };
+const char* const OP_NAMES[OP_COUNT] = {"generate", "validate", "seed", "seed+passphrase"};
+
+struct Request
+{
+    Op op;
+    size_t phrase;
+    Clock::time_point intended;
+    Clock::time_point enqueued;
+};
+
+struct Latencies
+{
+    std::vector<double> corrected[OP_COUNT];      // us from the scheduled arrival
+    std::vector<double> uncorrected[OP_COUNT];    // us from the actual enqueue
+
+    void merge(const Latencies& other)
+    {
+        for (int op = 0; op < OP_COUNT; op++) {
+            append(corrected[op], other.corrected[op]);
+            append(uncorrected[op], other.uncorrected[op]);
+        }
+    }
+
+    static void append(std::vector<double>& to, const std::vector<double>& from)
+    {
+        to.insert(to.end(), from.begin(), from.end());
+    }
+};
+
+struct LoadOptions
+{
+    bool open{true};
+    double rate{100};
+    unsigned clients{4};
+    unsigned workers{std::max(1u, std::thread::hardware_concurrency())};
+    double duration{5};
+    unsigned seed{1};
+    std::vector<double> mix{40, 40, 15, 5};
+};
+
+bool parseMix(const std::string& spec, std::vector<double>& mix)
+{
+    std::vector<double> parsed(OP_COUNT, 0);
+    std::istringstream items(spec);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        const size_t eq = item.find('=');
+        if (eq == std::string::npos)
+            return false;
+        const std::string name = item.substr(0, eq);
+        const auto it = std::find(OP_NAMES, OP_NAMES + OP_COUNT, name);
+        if (it == OP_NAMES + OP_COUNT)
+            return false;
+        parsed[it - OP_NAMES] = atof(item.c_str() + eq + 1);
+    }
+    if (std::all_of(parsed.begin(), parsed.end(), [](double w) { return w <= 0; }))
+        return false;
+    mix = parsed;
+    return true;
+}
+
+double micros(Clock::duration d)
+{
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+class Workload
+{
+public:
+    explicit Workload(size_t phrases)
+    {
+        for (size_t i = 0; i < phrases; i++) {
+            m_mnemonics.emplace_back(BIP39::Generate(i % 2 ? 24 : 12));
+            m_phrases.emplace_back(BIP39_Utils::Join(m_mnemonics.back().words, " "));
+        }
+    }
+
+    size_t size() const
+    {
+        return m_phrases.size();
+    }
+
+    void run(const Request& r)
+    {
+        switch (r.op) {
+        case GENERATE:
+            BIP39::Generate(24);
+            break;
+        case VALIDATE:
+            BIP39::Words(m_phrases[r.phrase]);
+            break;
+        case SEED:
+            m_mnemonics[r.phrase].generateSeed();
+            break;
+        case SEED_PASSPHRASE:
+            m_mnemonics[r.phrase].generateSeed("TREZOR");
+            break;
+        default:
+            break;
+        }
+    }
+
+private:
+    std::vector<Mnemonic> m_mnemonics;
+    std::vector<std::string> m_phrases;
+};
+
+Latencies openLoop(const LoadOptions& o, Workload& work, size_t& sent)
+{
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Request> queue;
+    bool done = false;
+    std::vector<Latencies> perWorker(o.workers);
+
+    auto worker = [&](unsigned w) {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            ready.wait(lock, [&] { return done || !queue.empty(); });
+            if (queue.empty())
+                return;
+            const Request r = queue.front();
+            queue.pop_front();
+            lock.unlock();
+            work.run(r);
+            const auto end = Clock::now();
+            perWorker[w].corrected[r.op].push_back(micros(end - r.intended));
+            perWorker[w].uncorrected[r.op].push_back(micros(end - r.enqueued));
+            lock.lock();
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned w = 0; w < o.workers; w++) {
+        pool.emplace_back(worker, w);
+    }
+
+    std::mt19937_64 rng(o.seed);
+    std::exponential_distribution<double> gap(o.rate);
+    std::discrete_distribution<int> pick(o.mix.begin(), o.mix.end());
+    std::uniform_int_distribution<size_t> phrase(0, work.size() - 1);
+    const auto start = Clock::now();
+    const auto stop = start + std::chrono::duration_cast<Clock::duration>(
+                                  std::chrono::duration<double>(o.duration));
+    auto next = start;
+    sent = 0;
+    for (;;) {
+        next += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(gap(rng)));
+        if (next >= stop)
+            break;
+        std::this_thread::sleep_until(next);
+        Request r{static_cast<Op>(pick(rng)), phrase(rng), next, Clock::now()};
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(r);
+        }
+        ready.notify_one();
+        ++sent;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    ready.notify_all();
+    for (auto& t : pool) {
+        t.join();
+    }
+
+    Latencies all;
+    for (const auto& l : perWorker) {
+        all.merge(l);
+    }
+    return all;
+}
+
+Latencies closedLoop(const LoadOptions& o, Workload& work, size_t& sent)
+{
+    std::vector<Latencies> perClient(o.clients);
+    std::atomic<size_t> total{0};
+    const auto stop = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                         std::chrono::duration<double>(o.duration));
+    auto client = [&](unsigned c) {
+        std::mt19937_64 rng(o.seed + c);
+        std::discrete_distribution<int> pick(o.mix.begin(), o.mix.end());
+        std::uniform_int_distribution<size_t> phrase(0, work.size() - 1);
+        for (auto now = Clock::now(); now < stop; now = Clock::now()) {
+            Request r{static_cast<Op>(pick(rng)), phrase(rng), now, now};
+            work.run(r);
+            const double us = micros(Clock::now() - now);
+            perClient[c].corrected[r.op].push_back(us);
+            perClient[c].uncorrected[r.op].push_back(us);
+            ++total;
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned c = 1; c < o.clients; c++) {
+        pool.emplace_back(client, c);
+    }
+    client(0);
+    for (auto& t : pool) {
+        t.join();
+    }
+    sent = total;
+
+    Latencies all;
+    for (const auto& l : perClient) {
+        all.merge(l);
+    }
+    return all;
+}
+
+double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    const size_t rank = std::min(sorted.size() - 1, (size_t)(p / 100 * sorted.size()));
+    return sorted[rank];
+}
+
+BenchResult summarize(
+    const std::string& name, std::vector<double> corrected, std::vector<double> uncorrected)
+{
+    std::sort(corrected.begin(), corrected.end());
+    std::sort(uncorrected.begin(), uncorrected.end());
+    BenchResult r;
+    r.name = name;
+    r.unit = "us";
+    // one value per run, so compare can pool the runs of several files; the rest are metrics
+    r.samples = {percentile(corrected, 99)};
+    r.metrics = {
+        {"count", (double)corrected.size()},
+        {"p50", percentile(corrected, 50)},
+        {"p90", percentile(corrected, 90)},
+        {"p99", percentile(corrected, 99)},
+        {"p999", percentile(corrected, 99.9)},
+        {"max", corrected.empty() ? 0 : corrected.back()},
+        {"uncorrected_p99", percentile(uncorrected, 99)},
+    };
+    return r;
+}
+}    // namespace
+
+int benchLoad(const BenchOptions& options)
+{
+    LoadOptions o;
+    const auto& args = options.args;
+    for (size_t i = 0; i + 1 < args.size(); i++) {
+        const std::string& key = args[i];
+        const std::string& value = args[++i];
+        if (key == "--mode" && (value == "open" || value == "closed")) {
+            o.open = value == "open";
+        } else if (key == "--rate" && atof(value.c_str()) > 0) {
+            o.rate = atof(value.c_str());
+        } else if (key == "--clients" && atoi(value.c_str()) > 0) {
+            o.clients = atoi(value.c_str());
+        } else if (key == "--workers" && atoi(value.c_str()) > 0) {
+            o.workers = atoi(value.c_str());
+        } else if (key == "--duration" && atof(value.c_str()) > 0) {
+            o.duration = atof(value.c_str());
+        } else if (key == "--seed") {
+            o.seed = (unsigned)strtoul(value.c_str(), nullptr, 10);
+        } else if (!(key == "--mix" && parseMix(value, o.mix))) {
+            fprintf(stderr, "invalid load option %s %s\n", key.c_str(), value.c_str());
+            return 2;
+        }
+    }
+
+    BIP39::preload();
+    Workload work(64);
+    size_t sent = 0;
+    const auto start = Clock::now();
+    Latencies latencies = o.open ? openLoop(o, work, sent) : closedLoop(o, work, sent);
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const std::string mode = o.open ? "open" : "closed";
+    if (o.open) {
+        printf(
+            "[load] open loop, %.1f req/s offered, %u workers, %.1f s\n",
+            o.rate,
+            o.workers,
+            o.duration);
+    } else {
+        printf("[load] closed loop, %u clients, %.1f s\n", o.clients, o.duration);
+    }
+    printf(
+        "%-26s %8s %10s %10s %10s %10s %10s %10s\n",
+        "operation (us)",
+        "count",
+        "p50",
+        "p90",
+        "p99",
+        "p99.9",
+        "max",
+        "p99 uncorr");
+
+    std::vector<BenchResult> results;
+    Latencies all;
+    for (int op = 0; op < OP_COUNT; op++) {
+        Latencies::append(all.corrected[0], latencies.corrected[op]);
+        Latencies::append(all.uncorrected[0], latencies.uncorrected[op]);
+    }
+    for (int op = 0; op <= OP_COUNT; op++) {
+        const bool total = op == OP_COUNT;
+        BenchResult r = summarize(
+            "load " + mode + " " + (total ? "all" : OP_NAMES[op]),
+            total ? all.corrected[0] : latencies.corrected[op],
+            total ? all.uncorrected[0] : latencies.uncorrected[op]);
+        if (r.metrics[0].second == 0)
+            continue;
+        printf("%-26s", total ? "all" : OP_NAMES[op]);
+        for (const auto& m : r.metrics) {
+            printf(m.first == "count" ? " %8.0f" : " %10.1f", m.second);
+        }
+        printf("\n");
+        results.push_back(std::move(r));
+    }
+
+    BenchResult throughput;
+    throughput.name = "load " + mode + " throughput";
+    throughput.unit = "req/s";
+    throughput.higherIsBetter = true;
+    const size_t completed = all.corrected[0].size();
+    throughput.samples = {completed / elapsed};
+    throughput.metrics = {{"sent", (double)sent}, {"offered_rate", o.open ? o.rate : 0}};
+    printf(
+        "achieved %.1f req/s (%zu requests in %.2f s)\n",
+        throughput.samples[0],
+        completed,
+        elapsed);
+    results.push_back(std::move(throughput));
+
+    if (!options.json.empty() && !writeJson(options.json, "load", results)) {
+        fprintf(stderr, "cannot write %s\n", options.json.c_str());
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static void usage()
+{
+    printf(
+        "usage: bench <suite> [options]\n"
+        "suites:\n"
+        "  alloc     allocations, bytes and time per call of the public API\n"
+        "  scaling   throughput, speedup and efficiency from 1 to N threads\n"
+        "            [--max-threads N] [--groups N]\n"
+        "  coldstart process start to first mnemonic and first seed, with a breakdown\n"
+        "  load      open-loop (Poisson) or closed-loop load on an in-process worker pool\n"
+        "            [--mode open|closed] [--rate R] [--clients N] [--workers N]\n"
+        "            [--duration S] [--seed N] [--mix generate=40,validate=40,seed=15,...]\n"
+        "  compare   BASE.json[,...] NEW.json[,...] [--threshold PCT]: Welch t-test per\n"
+        "            benchmark, exit 1 on significant regressions beyond PCT (default 5)\n"
+        "options:\n"
+        "  --repeat N              timed repetitions per benchmark (default 5)\n"
+        "  --json FILE             write results as JSON\n"
+        "  --baseline FILE         exit 1 when counts regress above FILE\n"
+        "  --write-baseline FILE   record the counts as a new baseline\n"
+        "  --tolerance X           allowed relative growth over the baseline (default 0)\n");
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    const std::string suite = argv[1];
+    if (suite == "coldstart-child")
+        return argc == 3 ? coldstartChild(argv[2]) : 2;
+    BenchOptions options;
+    for (int i = 2; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--repeat") && hasValue) {
+            options.repeat = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--json") && hasValue) {
+            options.json = argv[++i];
+        } else if (!strcmp(argv[i], "--baseline") && hasValue) {
+            options.baseline = argv[++i];
+        } else if (!strcmp(argv[i], "--write-baseline") && hasValue) {
+            options.writeBaseline = argv[++i];
+        } else if (!strcmp(argv[i], "--tolerance") && hasValue) {
+            options.tolerance = atof(argv[++i]);
+        } else {
+            options.args.emplace_back(argv[i]);
+        }
+    }
+
+    if (suite == "alloc")
+        return benchAlloc(options);
+    if (suite == "scaling")
+        return benchScaling(options);
+    if (suite == "coldstart")
+        return benchColdstart(options, argv[0]);
+    if (suite == "load")
+        return benchLoad(options);
+    if (suite == "compare")
+        return benchCompare(options);
+    usage();
+    return 2;
+}
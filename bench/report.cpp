@@ -0,0 +1,128 @@
+#include "bench.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+double timePerOp(const std::function<void()>& op, size_t iterations)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        op();
+    }
+    const std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+double mean(const std::vector<double>& v)
+{
+    if (v.empty())
+        return 0;
+    double sum = 0;
+    for (double x : v) {
+        sum += x;
+    }
+    return sum / v.size();
+}
+
+double stddev(const std::vector<double>& v)
+{
+    if (v.size() < 2)
+        return 0;
+    const double m = mean(v);
+    double sum = 0;
+    for (double x : v) {
+        sum += (x - m) * (x - m);
+    }
+    return std::sqrt(sum / (v.size() - 1));
+}
+
+void printResults(const std::string& suite, const std::vector<BenchResult>& results)
+{
+    printf("[%s]\n", suite.c_str());
+    for (const auto& r : results) {
+        printf(
+            "%-36s %14.1f %-8s +-%5.1f%%",
+            r.name.c_str(),
+            mean(r.samples),
+            r.unit.c_str(),
+            mean(r.samples) > 0 ? 100 * stddev(r.samples) / mean(r.samples) : 0.0);
+        for (const auto& m : r.metrics) {
+            printf("  %s=%.2f", m.first.c_str(), m.second);
+        }
+        printf("\n");
+    }
+}
+
+static std::string jsonString(const std::string& s)
+{
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+bool writeJson(
+    const std::string& path, const std::string& suite, const std::vector<BenchResult>& results)
+{
+    std::ofstream file(path, std::ios::trunc);
+    file.precision(17);
+    file << "{\n  \"suite\": " << jsonString(suite) << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& r = results[i];
+        file << (i ? ",\n" : "\n") << "    {\"name\": " << jsonString(r.name)
+             << ", \"unit\": " << jsonString(r.unit)
+             << ", \"higher_is_better\": " << (r.higherIsBetter ? "true" : "false")
+             << ", \"samples\": [";
+        for (size_t k = 0; k < r.samples.size(); k++) {
+            file << (k ? ", " : "") << r.samples[k];
+        }
+        file << "], \"metrics\": {";
+        for (size_t k = 0; k < r.metrics.size(); k++) {
+            file << (k ? ", " : "") << jsonString(r.metrics[k].first) << ": "
+                 << r.metrics[k].second;
+        }
+        file << "}}";
+    }
+    file << "\n  ]\n}\n";
+    return (bool)file;
+}
+
+bool readBaseline(const std::string& path, std::map<std::string, double>& baseline)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        std::string name, metric;
+        double value;
+        if (fields >> name >> metric >> value)
+            baseline[name + " " + metric] = value;
+    }
+    return true;
+}
+
+bool writeBaseline(
+    const std::string& path, const std::vector<BenchResult>& results, const char* const* metrics)
+{
+    std::ofstream file(path, std::ios::trunc);
+    file << "# name metric value\n";
+    for (const auto& r : results) {
+        for (const auto& m : r.metrics) {
+            for (const char* const* wanted = metrics; *wanted; ++wanted) {
+                if (m.first == *wanted)
+                    file << r.name << ' ' << m.first << ' ' << m.second << '\n';
+            }
+        }
+    }
+    return (bool)file;
+}
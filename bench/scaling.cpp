@@ -0,0 +1,281 @@
+#include "bench.h"
+#include "../src/batch.h"
+#include "../src/bip39.h"
+#include "../src/mnemonic.h"
+#include "../src/pbkdf2_sha512/pbkdf2.hpp"
+#include "../src/utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <thread>
+
+namespace
+{
+// Efficiency below this marks the thread count where scaling stops paying off.
+constexpr double KNEE_EFFICIENCY = 0.75;
+// The engine is flagged when it delivers less than this share of independent threads.
+constexpr double ENGINE_SHARE = 0.9;
+constexpr uint32_t ROUNDS = 2048;
+
+unsigned physicalCores()
+{
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::set<std::pair<std::string, std::string>> cores;
+    std::string line, package;
+    while (std::getline(cpuinfo, line)) {
+        const size_t colon = line.find(':');
+        if (colon == std::string::npos)
+            continue;
+        const std::string value = colon + 2 <= line.size() ? line.substr(colon + 2) : "";
+        if (line.rfind("physical id", 0) == 0)
+            package = value;
+        else if (line.rfind("core id", 0) == 0)
+            cores.emplace(package, value);
+    }
+    return cores.empty() ? std::max(1u, std::thread::hardware_concurrency())
+                         : (unsigned)cores.size();
+}
+
+double seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Runs `body(thread)` on `threads` threads released together; returns each thread's seconds.
+std::vector<double> runTogether(unsigned threads, const std::function<void(unsigned)>& body)
+{
+    std::vector<double> elapsed(threads);
+    std::atomic<unsigned> ready{0};
+    std::atomic<bool> go{false};
+    auto run = [&](unsigned t) {
+        ++ready;
+        while (!go.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        const auto start = std::chrono::steady_clock::now();
+        body(t);
+        elapsed[t] = seconds(start);
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; t++) {
+        pool.emplace_back(run, t);
+    }
+    while (ready.load() + 1 < threads) {
+        std::this_thread::yield();
+    }
+    go.store(true, std::memory_order_release);
+    run(0);
+    for (auto& t : pool) {
+        t.join();
+    }
+    return elapsed;
+}
+
+struct Point
+{
+    unsigned threads;
+    std::vector<double> rates;    // items/s per repetition
+    double threadCv;              // spread of per-thread rates, percent of their mean
+    double independent;           // best items/s of plain threads without the engine, 0 if not run
+};
+
+struct Series
+{
+    std::string name;
+    std::string unit;
+    std::vector<Point> points;
+};
+
+void report(const Series& s, unsigned cores, std::vector<BenchResult>& results)
+{
+    printf("\n%s\n", s.name.c_str());
+    printf(" threads %14s  speedup  efficiency  thread-cv  notes\n", s.unit.c_str());
+    const double base = mean(s.points.front().rates);
+    bool knee = false;
+    for (const auto& p : s.points) {
+        const double rate = mean(p.rates);
+        const double speedup = base > 0 ? rate / base : 0;
+        const double efficiency = speedup / p.threads;
+        std::string notes;
+        if (p.threads > std::thread::hardware_concurrency())
+            notes += " oversubscribed";
+        else if (p.threads > cores)
+            notes += " smt";
+        if (!knee && p.threads > 1 && efficiency < KNEE_EFFICIENCY) {
+            notes += " knee";
+            knee = true;
+        }
+        const double best = *std::max_element(p.rates.begin(), p.rates.end());
+        if (p.independent > 0 && best < ENGINE_SHARE * p.independent)
+            notes += " contention(engine)";
+        else if (p.independent == 0 && p.threads > 1 && efficiency < KNEE_EFFICIENCY &&
+                 p.threads <= cores)
+            notes += " contention";
+        printf(
+            " %7u %14.1f %8.2f %11.2f %9.1f%% %s\n",
+            p.threads,
+            rate,
+            speedup,
+            efficiency,
+            p.threadCv,
+            notes.c_str());
+
+        BenchResult r;
+        r.name = s.name + " t=" + std::to_string(p.threads);
+        r.unit = s.unit;
+        r.higherIsBetter = true;
+        r.samples = p.rates;
+        r.metrics.emplace_back("speedup", speedup);
+        r.metrics.emplace_back("efficiency", efficiency);
+        r.metrics.emplace_back("thread_cv_pct", p.threadCv);
+        if (p.independent > 0)
+            r.metrics.emplace_back("independent_rate", p.independent);
+        results.push_back(std::move(r));
+    }
+}
+
+double cv(const std::vector<double>& v)
+{
+    const double m = mean(v);
+    return m > 0 ? 100 * stddev(v) / m : 0;
+}
+
+// SeedBatch throughput with `threads` workers, next to the same kernel on plain threads.
+Series seedScaling(sha512_kernel kernel, unsigned maxThreads, size_t groupsPerRun, int repeat)
+{
+    const size_t lanes = sha512_kernel_width(kernel);
+    std::vector<std::string> phrases;
+    for (size_t i = 0; i < groupsPerRun * lanes; i++) {
+        std::string hex(32, '0');
+        for (size_t k = 0; k < hex.size(); k++) {
+            hex[k] = "0123456789abcdef"[(i * 5 + k * 11) % 16];
+        }
+        phrases.emplace_back(BIP39_Utils::Join(BIP39::Entropy(hex).words, " "));
+    }
+    const std::string salt = "mnemonic";
+    std::vector<uint8_t> seeds(phrases.size() * SeedBatch::SEED_LENGTH);
+
+    Series s{std::string("SeedBatch ") + sha512_kernel_name(kernel), "seeds/s", {}};
+    for (unsigned t = 1; t <= maxThreads; t++) {
+        Point p{t, {}, 0, 0};
+        const BatchConfig config{kernel, lanes, t};
+        for (int k = 0; k < repeat; k++) {
+            const auto start = std::chrono::steady_clock::now();
+            SeedBatch::generateSeeds(phrases, "", seeds.data(), config);
+            p.rates.push_back(phrases.size() / seconds(start));
+        }
+
+        // same work split statically over plain threads: per-thread spread and the engine's cost
+        const size_t perThread = std::max<size_t>(1, groupsPerRun / t);
+        std::vector<double> perThreadRates;
+        for (int k = 0; k < repeat; k++) {
+            const auto elapsed = runTogether(t, [&](unsigned) {
+                const uint8_t* pass[SHA512_MAX_LANES];
+                const uint8_t* salts[SHA512_MAX_LANES];
+                int passlen[SHA512_MAX_LANES];
+                int saltlen[SHA512_MAX_LANES];
+                uint8_t keys[SHA512_MAX_LANES * SeedBatch::SEED_LENGTH];
+                for (size_t l = 0; l < lanes; l++) {
+                    pass[l] = reinterpret_cast<const uint8_t*>(phrases[l].data());
+                    passlen[l] = (int)phrases[l].size();
+                    salts[l] = reinterpret_cast<const uint8_t*>(salt.data());
+                    saltlen[l] = (int)salt.size();
+                }
+                for (size_t g = 0; g < perThread; g++) {
+                    pbkdf2_hmac_sha512_lanes(
+                        kernel, lanes, pass, passlen, salts, saltlen, ROUNDS, keys);
+                }
+            });
+            for (double e : elapsed) {
+                perThreadRates.push_back(perThread * lanes / e);
+            }
+            const double slowest = *std::max_element(elapsed.begin(), elapsed.end());
+            p.independent = std::max(p.independent, t * perThread * lanes / slowest);
+        }
+        p.threadCv = cv(perThreadRates);
+        s.points.push_back(std::move(p));
+    }
+    return s;
+}
+
+// Fixed calls per thread of a cheap API; shared state inside it shows up as lost efficiency.
+Series apiScaling(
+    const char* name,
+    const std::function<void()>& op,
+    unsigned maxThreads,
+    size_t calls,
+    int repeat)
+{
+    Series s{name, "calls/s", {}};
+    for (unsigned t = 1; t <= maxThreads; t++) {
+        Point p{t, {}, 0, 0};
+        std::vector<double> perThreadRates;
+        for (int k = 0; k < repeat; k++) {
+            const auto elapsed = runTogether(t, [&](unsigned) {
+                for (size_t i = 0; i < calls; i++) {
+                    op();
+                }
+            });
+            p.rates.push_back(t * calls / *std::max_element(elapsed.begin(), elapsed.end()));
+            for (double e : elapsed) {
+                perThreadRates.push_back(calls / e);
+            }
+        }
+        p.threadCv = cv(perThreadRates);
+        s.points.push_back(std::move(p));
+    }
+    return s;
+}
+}    // namespace
+
+int benchScaling(const BenchOptions& options)
+{
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t groups = 0;
+    for (size_t i = 0; i + 1 < options.args.size(); i++) {
+        if (options.args[i] == "--max-threads")
+            maxThreads = std::max(1, atoi(options.args[++i].c_str()));
+        else if (options.args[i] == "--groups")
+            groups = std::max(1, atoi(options.args[++i].c_str()));
+    }
+    // enough groups that every thread count divides the work into several pieces per thread
+    if (groups == 0)
+        groups = 4 * maxThreads;
+    const unsigned cores = physicalCores();
+    printf(
+        "[scaling] %u hardware threads, %u physical cores, sweeping 1..%u\n",
+        std::thread::hardware_concurrency(),
+        cores,
+        maxThreads);
+
+    std::vector<BenchResult> results;
+    for (int k = 0; k < SHA512_KERNEL_COUNT; k++) {
+        const auto kernel = static_cast<sha512_kernel>(k);
+        if (sha512_kernel_supported(kernel))
+            report(seedScaling(kernel, maxThreads, groups, options.repeat), cores, results);
+    }
+
+    static const char entropy[] = "7f7f7f7f7f7f7f7f7f7f7f7f7f7f7f7f";
+    const std::string phrase = BIP39_Utils::Join(BIP39::Entropy(entropy).words, " ");
+    Wordlist::english();    // load before threads race on the registry
+    report(
+        apiScaling(
+            "BIP39::Words", [&] { BIP39::Words(phrase); }, maxThreads, 2000, options.repeat),
+        cores,
+        results);
+    report(
+        apiScaling(
+            "BIP39::Generate", [] { BIP39::Generate(24); }, maxThreads, 2000, options.repeat),
+        cores,
+        results);
+
+    if (!options.json.empty() && !writeJson(options.json, "scaling", results)) {
+        fprintf(stderr, "cannot write %s\n", options.json.c_str());
+        return 2;
+    }
+    return 0;
+}
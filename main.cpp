@@ -1,9 +1,35 @@
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
 
+#include "src/address.h"
+#include "src/autotune.h"
+#include "src/batch.h"
 #include "src/bip39.h"
+#include "src/bip39_c.h"
+#include "src/bip85.h"
+#include "src/dedup.h"
+#include "src/electrum.h"
+#include "src/fingerprint.h"
 #include "src/mnemonic.h"
+#include "src/pbkdf2_sha512/hash160_lanes.h"
+#include "src/pbkdf2_sha512/pbkdf2.hpp"
+#include "src/pbkdf2_sha512/ripemd160.h"
+#include "src/recovery.h"
+#include "src/screen.h"
+#include "src/secp256k1.h"
+#include "src/shadow.h"
+#include "src/trace.h"
 #include "src/utils.h"
+#include "src/validator.h"
+#include "src/vanity.h"
+#include "src/watchonly.h"
+#include "src/weakscan.h"
+#include "src/wordlist.h"
 
 static std::string joined_mnemonic(const std::vector<std::string>& s)
 {
@@ -34,6 +60,949 @@ void TestEntropyToMnemnoic(
         printf("%d [Pass]\n", i++);
 }
 
+void TestSeedClassification()
+{
+    struct Case
+    {
+        const char* phrase;
+        bool bip39;
+        ElectrumSeedType electrum;
+    };
+    static const Case cases[] = {
+        {"abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon "
+         "about",
+         true,
+         ElectrumSeedType::None},
+        {"since sick check reward swamp mind board moral cross bounce mutual equip",
+         false,
+         ElectrumSeedType::Standard},
+        {"exchange wonder picnic sort bulk coil strong abstract monitor arm culture panda",
+         false,
+         ElectrumSeedType::Segwit},
+        {"actress park venue ensure cloth winter welcome assist park peace crane toward",
+         false,
+         ElectrumSeedType::TwoFactor},
+        {"hungry  Sword tuna flat critic fiction ready until output dance profit remind ",
+         false,
+         ElectrumSeedType::TwoFactorSegwit},
+        {"split napkin soul liberty budget soup regular elevator youth subway alert siren velvet "
+         "flower august panther mad have vibrant kick popular uncle wild luxury",
+         false,
+         ElectrumSeedType::Standard},
+        {"zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo wrong", true, ElectrumSeedType::None},
+        {"zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo", false, ElectrumSeedType::None},
+    };
+    std::vector<std::string> phrases;
+    for (const auto& c : cases) {
+        phrases.emplace_back(c.phrase);
+    }
+
+    for (int k = 0; k < SHA512_KERNEL_COUNT; k++) {
+        auto kernel = static_cast<sha512_kernel>(k);
+        if (!sha512_kernel_supported(kernel))
+            continue;
+        auto result = SeedClassifier(Wordlist::english(), kernel).classify(phrases);
+        bool ok = true;
+        for (size_t i = 0; i < phrases.size(); i++) {
+            if (result[i].bip39 != cases[i].bip39 || result[i].electrum != cases[i].electrum) {
+                printf(
+                    "Seed classification (%s) [FAIL]: %s\n",
+                    sha512_kernel_name(kernel),
+                    cases[i].phrase);
+                ok = false;
+            }
+        }
+        if (ok)
+            printf("Seed classification (%s) [Pass]\n", sha512_kernel_name(kernel));
+    }
+
+    // other languages, whose lists are not byte sorted
+    bool ok = true;
+    for (Wordlist* list : {Wordlist::french(), Wordlist::spanish()}) {
+        std::vector<std::string> localized;
+        for (const char* hex : {"00000000000000000000000000000000",
+                                "9e885d952ad362caeb4efe34a8e91bd2",
+                                "68a79eaca2324873eacc50cb9c6eca8cc68ea5d936f98787c60c7ebc74e6ce7c",
+                                "c0ba5a8e914111210f2bd131f3d5e08d"}) {
+            const int words = (int)strlen(hex) * 3 / 8;
+            localized.push_back(
+                joined_mnemonic(BIP39(words).useEntropy(hex).wordList(list).mnemonic().words));
+        }
+        // a wrong last word breaks the checksum
+        localized.push_back(localized[0].substr(0, localized[0].rfind(' ') + 1) + list->getWord(1));
+        const auto result = SeedClassifier(list).classify(localized);
+        for (size_t i = 0; i < result.size(); i++) {
+            ok = ok && result[i].bip39 == (i + 1 < result.size());
+        }
+    }
+    printf("Seed classification word lists %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
+void TestPbkdf2Resume()
+{
+    const std::string pass =
+        "legal winner thank year wave sausage worth useful legal winner thank yellow";
+    const std::string salt = "mnemonicTREZOR";
+    auto p = reinterpret_cast<const uint8_t*>(pass.data());
+    auto s = reinterpret_cast<const uint8_t*>(salt.data());
+    uint8_t expected[64], resumed[64], blob[PBKDF2_HMAC_SHA512_STATE_LENGTH];
+    pbkdf2_hmac_sha512(p, pass.size(), s, salt.size(), 2048, expected);
+
+    PBKDF2_HMAC_SHA512_CTX ctx;
+    pbkdf2_hmac_sha512_Init(&ctx, p, pass.size(), s, salt.size());
+    pbkdf2_hmac_sha512_Update(&ctx, 1000);
+    pbkdf2_hmac_sha512_Export(&ctx, blob);
+
+    PBKDF2_HMAC_SHA512_CTX restored;
+    bool ok = pbkdf2_hmac_sha512_Import(&restored, blob, sizeof(blob)) && restored.iterations == 1000;
+    pbkdf2_hmac_sha512_Update(&restored, 2048 - restored.iterations);
+    pbkdf2_hmac_sha512_Final(&restored, resumed);
+    ok = ok && memcmp(expected, resumed, sizeof(expected)) == 0;
+
+    blob[100] ^= 1;
+    ok = ok && !pbkdf2_hmac_sha512_Import(&restored, blob, sizeof(blob));
+    printf("PBKDF2 checkpoint resume %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
+void TestSeedBatch()
+{
+    std::vector<Mnemonic> mnemonics;
+    for (const char* entropy : {"00000000000000000000000000000000",
+                                "7f7f7f7f7f7f7f7f7f7f7f7f7f7f7f7f7f7f7f7f7f7f7f7f",
+                                "9e885d952ad362caeb4efe34a8e91bd2",
+                                "68a79eaca2324873eacc50cb9c6eca8cc68ea5d936f98787c60c7ebc74e6ce7c",
+                                "c0ba5a8e914111210f2bd131f3d5e08d"}) {
+        mnemonics.emplace_back(BIP39::Entropy(entropy));
+    }
+    std::vector<std::string> phrases;
+    std::vector<uint8_t> expected;
+    for (auto& m : mnemonics) {
+        phrases.emplace_back(joined_mnemonic(m.words));
+        auto seed = m.generateSeed("TREZOR");
+        expected.insert(expected.end(), seed.begin(), seed.end());
+    }
+
+    for (int k = 0; k < SHA512_KERNEL_COUNT; k++) {
+        auto kernel = static_cast<sha512_kernel>(k);
+        if (!sha512_kernel_supported(kernel))
+            continue;
+        bool ok = true;
+        for (size_t lanes = sha512_kernel_width(kernel); lanes <= SHA512_MAX_LANES; lanes *= 2) {
+            std::vector<uint8_t> seeds(expected.size());
+            SeedBatch::generateSeeds(phrases, "TREZOR", seeds.data(), {kernel, lanes, 3});
+            ok = ok && seeds == expected;
+        }
+        printf("Seed batch (%s) %s\n", sha512_kernel_name(kernel), ok ? "[Pass]" : "[FAIL]");
+    }
+
+    ShadowCheck::enable(1);
+    SeedBatch::generateSeeds(mnemonics, "TREZOR");
+    ShadowCheck::drain();
+    ShadowCheck::disable();
+    bool shadowOk = ShadowCheck::checked() == mnemonics.size() && ShadowCheck::mismatches() == 0;
+    printf("Seed batch shadow check %s\n", shadowOk ? "[Pass]" : "[FAIL]");
+
+    const std::string cache = "autotune-test.cache";
+    BatchConfig stored{SHA512_KERNEL_SCALAR, 1, 2}, loaded;
+    bool ok = Autotune::store(cache, stored) && Autotune::load(cache, loaded) &&
+              loaded.kernel == stored.kernel && loaded.lanes == stored.lanes &&
+              loaded.threads == stored.threads;
+    std::remove(cache.c_str());
+    printf("Autotune cache %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
+void TestTraceBuffers()
+{
+    const std::vector<std::string> phrases(5, "abandon abandon abandon abandon abandon abandon "
+                                              "abandon abandon abandon abandon abandon about");
+    std::vector<uint8_t> seeds(phrases.size() * SeedBatch::SEED_LENGTH);
+    const BatchConfig config{SHA512_KERNEL_SCALAR, 1, 4};
+    const bool wasEnabled = Trace::enabled();
+    const size_t before = Trace::bufferCount();
+    Trace::enable();
+    for (int i = 0; i < 16; i++) {
+        SeedBatch::generateSeeds(phrases, "", seeds.data(), config);
+    }
+    // each call starts three new workers, which take over the previous call's buffers
+    bool ok = Trace::bufferCount() <= before + config.threads;
+    if (!wasEnabled)
+        Trace::disable();
+    printf("Trace buffers reused across batches %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
+void TestPbkdf2Sha256Batch()
+{
+    uint8_t key[32];
+    pbkdf2_hmac_sha256((const uint8_t*)"password", 8, (const uint8_t*)"salt", 4, 2, key);
+    bool ok = BIP39_Utils::base16Encode(std::string((const char*)key, 32)) ==
+              "ae4d0c95af6b46d32d0adff928f06dd02a303f8ef3c251dfd6e2d85a95474c43";
+    printf("PBKDF2-HMAC-SHA256 vector (SHA-NI %s) %s\n",
+           sha256_shani_supported() ? "on" : "off", ok ? "[Pass]" : "[FAIL]");
+
+    std::vector<Pbkdf2Job> jobs;
+    std::vector<uint8_t> expected;
+    // shared counts, then distinct ones that put different counts in one lane group
+    for (int i = 0; i < 81; i++) {
+        const uint32_t iterations =
+            i >= 41 ? 2 + i * 37 % 97 : (i % 3 == 0 ? 1 : (i % 3 == 1 ? 50 : 7));
+        jobs.push_back({"archive password " + std::to_string(i), "salt" + std::to_string(i * 7),
+                        iterations});
+        pbkdf2_hmac_sha256((const uint8_t*)jobs[i].password.data(), (int)jobs[i].password.size(),
+                           (const uint8_t*)jobs[i].salt.data(), (int)jobs[i].salt.size(),
+                           iterations, key);
+        expected.insert(expected.end(), key, key + 32);
+    }
+    for (int k = 0; k < SHA512_KERNEL_COUNT; k++) {
+        auto kernel = static_cast<sha512_kernel>(k);
+        if (!sha512_kernel_supported(kernel))
+            continue;
+        bool same = true;
+        for (size_t lanes = sha512_kernel_width(kernel); lanes <= SHA512_MAX_LANES; lanes *= 2) {
+            same = same && Pbkdf2Batch::deriveSha256(jobs, {kernel, lanes, 3}) == expected;
+        }
+        printf("PBKDF2-HMAC-SHA256 batch (%s) %s\n", sha512_kernel_name(kernel),
+               same ? "[Pass]" : "[FAIL]");
+    }
+}
+
+void TestPhraseValidator()
+{
+    PhraseValidator v(12);
+    bool ok = true;
+    for (int i = 0; i < 11; i++) {
+        ok = ok && v.push("abandon") == PhraseStatus::Incomplete;
+    }
+    ok = ok && v.push("abandon") == PhraseStatus::BadChecksum && v.errorPosition() == 11;
+    v.pop();
+    ok = ok && v.push("abandonx") == PhraseStatus::UnknownWord && v.errorPosition() == 11 &&
+         v.size() == 11;
+    ok = ok && v.push("about") == PhraseStatus::Complete && v.errorPosition() == -1 &&
+         v.push("about") == PhraseStatus::TooManyWords && v.status() == PhraseStatus::Complete;
+    ok = ok && v.mnemonic().entropy == BIP39::Entropy("00000000000000000000000000000000").entropy;
+    printf("Phrase validator errors %s\n", ok ? "[Pass]" : "[FAIL]");
+
+    ok = true;
+    const std::string hex = "68a79eaca2324873eacc50cb9c6eca8cc68ea5d936f98787c60c7ebc74e6ce7c";
+    for (Wordlist* list : {Wordlist::english(), Wordlist::french(), Wordlist::spanish()}) {
+        const Mnemonic m = BIP39(24).useEntropy(hex).wordList(list).mnemonic();
+        PhraseValidator words(24, list);
+        PhraseStatus status = PhraseStatus::Incomplete;
+        for (const auto& w : m.words) {
+            status = words.push(w);
+        }
+        uint8_t entropy[32];
+        words.entropy(entropy);
+        ok = ok && status == PhraseStatus::Complete && words.mnemonic().words == m.words &&
+             BIP39_Utils::base16Encode(std::string((const char*)entropy, 32)) == hex;
+        words.reset();
+        ok = ok && words.push(m.words[0]) == PhraseStatus::Incomplete && words.size() == 1 &&
+             words.word(0) == m.wordsIndex[0];
+    }
+    printf("Phrase validator word lists %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
+void TestCInterface()
+{
+    const std::vector<std::string> hexes = {
+        "00000000000000000000000000000000", "9e885d952ad362caeb4efe34a8e91bd2",
+        "c0ba5a8e914111210f2bd131f3d5e08d", "7f7f7f7f7f7f7f7f7f7f7f7f7f7f7f7f"};
+    std::vector<uint8_t> entropy;
+    std::vector<uint16_t> expected;
+    std::vector<std::string> phrases;
+    std::vector<uint8_t> seeds;
+    for (const auto& hex : hexes) {
+        const std::string bytes = BIP39_Utils::base16Decode(hex);
+        entropy.insert(entropy.end(), bytes.begin(), bytes.end());
+        Mnemonic m = BIP39::Entropy(hex);
+        expected.insert(expected.end(), m.wordsIndex.begin(), m.wordsIndex.end());
+        phrases.push_back(joined_mnemonic(m.words));
+        auto seed = m.generateSeed("TREZOR");
+        seeds.insert(seeds.end(), seed.begin(), seed.end());
+    }
+    const size_t n = hexes.size();
+    std::vector<uint16_t> indices(n * 12);
+    bool ok = bip39_abi_version() == BIP39_ABI_VERSION &&
+              bip39_entropy_to_indices(entropy.data(), n, 12, indices.data()) == BIP39_OK &&
+              std::equal(indices.begin(), indices.end(), expected.begin());
+
+    std::vector<uint8_t> back(entropy.size());
+    std::vector<int32_t> status(n);
+    indices[12 + 11] ^= 1;
+    ok = ok && bip39_indices_to_entropy(indices.data(), n, 12, back.data(), status.data()) == 0 &&
+         status[0] == BIP39_OK && status[1] == BIP39_ERR_CHECKSUM && status[2] == BIP39_OK &&
+         std::equal(back.begin(), back.begin() + 16, entropy.begin());
+    indices[12 + 11] ^= 1;
+
+    std::vector<const char*> text;
+    for (const auto& p : phrases) {
+        text.push_back(p.c_str());
+    }
+    std::vector<uint16_t> parsed(n * 12);
+    ok = ok &&
+         bip39_phrases_to_indices(text.data(), n, 12, nullptr, parsed.data(), status.data()) ==
+             BIP39_OK &&
+         parsed == indices;
+    const std::string extra = phrases[0] + " about";
+    const char* bad[] = {"abandon abandon", "abandon zzz", extra.c_str()};
+    ok = ok && bip39_phrases_to_indices(bad, 3, 12, "english", parsed.data(), status.data()) == 0 &&
+         status[0] == BIP39_ERR_LENGTH && status[1] == BIP39_ERR_WORD &&
+         status[2] == BIP39_ERR_LENGTH;
+
+    std::vector<uint8_t> out(n * BIP39_SEED_LENGTH);
+    ok = ok &&
+         bip39_batch_seed(indices.data(), n, 12, nullptr, "TREZOR", 6, 2, out.data()) == 0 &&
+         out == seeds;
+
+    char word[16];
+    ok = ok && bip39_word("english", 3, word, sizeof(word)) == 5 && !strcmp(word, "about") &&
+         bip39_word_index(nullptr, "zoo", 3) == 2047 &&
+         bip39_word_index("klingon", "zoo", 3) == BIP39_ERR_WORDLIST &&
+         bip39_word_index("./english", "zoo", 3) == BIP39_ERR_WORDLIST &&
+         bip39_word_index("french", "abaisser", 8) == 0 &&
+         bip39_generate(2, 15, parsed.data()) == BIP39_OK &&
+         bip39_indices_to_entropy(parsed.data(), 2, 15, back.data(), status.data()) == 0 &&
+         status[0] == BIP39_OK && status[1] == BIP39_OK &&
+         bip39_batch_seed(indices.data(), n, 13, nullptr, "", 0, 0, out.data()) ==
+             BIP39_ERR_ARGUMENT;
+    printf("C interface %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
+void TestFingerprints()
+{
+    // SipHash-2-4 reference vectors: key 00..0f, messages 00..0e and empty
+    const FingerprintKey key{0x0706050403020100ULL, 0x0f0e0d0c0b0a0908ULL};
+    uint8_t message[15];
+    for (int i = 0; i < 15; i++) {
+        message[i] = (uint8_t)i;
+    }
+    const Fingerprint128 wide = MnemonicFingerprint::keyed128(key, message, 0);
+    bool ok = MnemonicFingerprint::keyed64(key, message, 15) == 0xa129ca6149be45e5ULL &&
+              MnemonicFingerprint::keyed64(key, message, 0) == 0x726fdb47dd0e0e31ULL &&
+              wide.lo == 0xe6a825ba047f81a3ULL && wide.hi == 0x930255c71472f66dULL;
+    printf("Fingerprint SipHash vectors %s\n", ok ? "[Pass]" : "[FAIL]");
+
+    FingerprintMap<uint32_t> map;
+    FingerprintSet set(100);
+    std::vector<uint64_t> fingerprints;
+    for (uint32_t i = 0; i < 5000; i++) {
+        const std::string entropy = BIP39_Utils::base16Decode(BIP39::Generate(12).entropy);
+        fingerprints.push_back(MnemonicFingerprint::hash64(
+            reinterpret_cast<const uint8_t*>(entropy.data()), entropy.size()));
+        ok = ok && map.insert(fingerprints.back(), i).second &&
+             set.insert(fingerprints.back()).second;
+    }
+    fingerprints.push_back(0);
+    map[0] = 7;
+    ok = ok && map.size() == 5001 && set.size() == 5000 && *map.find(0) == 7 &&
+         !map.insert(fingerprints[17], 99).second && !set.contains(0);
+    for (uint32_t i = 0; i < 5000; i++) {
+        ok = ok && map.find(fingerprints[i]) && *map.find(fingerprints[i]) == i &&
+             set.contains(fingerprints[i]);
+    }
+    size_t visited = 0;
+    map.forEach([&](uint64_t, uint32_t) { visited++; });
+    map.clear();
+    ok = ok && visited == 5001 && map.empty() && !map.contains(fingerprints[3]);
+    printf("Fingerprint map %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
+void TestWeakSeedScan()
+{
+    bool ok = true;
+    for (uint32_t seed : {0u, 1u, 5489u, 0xdeadbeefu}) {
+        uint8_t be[32], le[32], low[32], lcg[16];
+        WeakSeedScan::entropy(WeakGenerator::Mt19937, WeakByteOrder::BigEndian, seed, be, 32);
+        WeakSeedScan::entropy(WeakGenerator::Mt19937, WeakByteOrder::LittleEndian, seed, le, 16);
+        WeakSeedScan::entropy(WeakGenerator::Mt19937, WeakByteOrder::LowByte, seed, low, 32);
+        WeakSeedScan::entropy(WeakGenerator::Minstd, WeakByteOrder::BigEndian, seed, lcg, 16);
+        std::mt19937 mt(seed);
+        std::minstd_rand minstd(seed);
+        for (int i = 0; i < 32; i++) {
+            const uint32_t x = mt();
+            ok = ok && low[i] == (uint8_t)x;
+            if (i < 8)
+                ok = ok && be[4 * i] == (uint8_t)(x >> 24) && be[4 * i + 3] == (uint8_t)x;
+            if (i < 4) {
+                const uint32_t y = (uint32_t)minstd();
+                ok = ok && le[4 * i] == (uint8_t)x && le[4 * i + 3] == (uint8_t)(x >> 24) &&
+                     lcg[4 * i] == (uint8_t)(y >> 24) && lcg[4 * i + 3] == (uint8_t)y;
+            }
+        }
+    }
+    printf("Weak generator entropy %s\n", ok ? "[Pass]" : "[FAIL]");
+
+    // the second receive address of seed 1033's BIP84 account, in shard 1 of 2 of [1000, 1040)
+    uint8_t entropy[16];
+    WeakSeedScan::entropy(WeakGenerator::Mt19937, WeakByteOrder::BigEndian, 1033, entropy, 16);
+    WatchOnlyOptions watch;
+    watch.purposes = {84};
+    watch.gap = 2;
+    const auto wallets = WatchOnlyExport::derive(
+        {BIP39::Entropy(BIP39_Utils::base16Encode(std::string((const char*)entropy, 16)))},
+        watch);
+    const std::string targets = "weakscan-test.screen", checkpoint = "weakscan-test.checkpoint";
+    std::remove(checkpoint.c_str());
+    ok = WeakSeedScan::buildTargets(
+             {wallets[0].accounts[0].receive[1], "1BvBMSEYstWetqTFn5Au4m4GFg7xJaNVN2"}, targets) ==
+         2;
+    MnemonicScreen screen(targets);
+    WeakScanOptions options;
+    options.seedBegin = 1000;
+    options.seedEnd = 1040;
+    options.shard = 1;
+    options.shards = 2;
+    options.purposes = {44, 84};
+    options.addresses = 2;
+    options.threads = 2;
+    options.batch = 8;
+    options.checkpointPath = checkpoint;
+    std::vector<WeakScanMatch> found;
+    WeakSeedScan scan(options, screen);
+    ok = ok && scan.next() == 1020 && scan.end() == 1040 &&
+         scan.run([&](const WeakScanMatch& m) { found.push_back(m); }) == 1 &&
+         found.size() == 1 && found[0].seed == 1033 && found[0].purpose == 84 &&
+         found[0].index == 1 && scan.next() == 1040;
+    // resumed from the checkpoint there is nothing left; other options refuse it
+    ok = ok && WeakSeedScan(options, screen).run({}) == 0;
+    options.addresses = 3;
+    try {
+        WeakSeedScan mismatched(options, screen);
+        ok = false;
+    } catch (const MnemonicException&) {
+    }
+    // so do another passphrase and other targets, without the passphrase in the file
+    options.addresses = 2;
+    options.passphrase = "TREZOR";
+    try {
+        WeakSeedScan mismatched(options, screen);
+        ok = false;
+    } catch (const MnemonicException&) {
+    }
+    std::ifstream saved(checkpoint);
+    const std::string text((std::istreambuf_iterator<char>(saved)), {});
+    ok = ok && text.find("TREZOR") == std::string::npos;
+    options.passphrase.clear();
+    const std::string others = "weakscan-test-others.screen";
+    WeakSeedScan::buildTargets({"1BvBMSEYstWetqTFn5Au4m4GFg7xJaNVN2"}, others);
+    MnemonicScreen otherScreen(others);
+    try {
+        WeakSeedScan mismatched(options, otherScreen);
+        ok = false;
+    } catch (const MnemonicException&) {
+    }
+    std::remove(checkpoint.c_str());
+    std::remove(targets.c_str());
+    std::remove(others.c_str());
+
+    // entropy targets skip the derivation entirely
+    uint8_t weak[32];
+    WeakSeedScan::entropy(WeakGenerator::Minstd, WeakByteOrder::LowByte, 41, weak, 32);
+    MnemonicScreen::build({std::string((const char*)weak, 32)}, targets);
+    MnemonicScreen entropies(targets);
+    WeakScanOptions direct;
+    direct.generator = WeakGenerator::Minstd;
+    direct.byteOrder = WeakByteOrder::LowByte;
+    direct.wordCount = 24;
+    direct.target = WeakScanTarget::Entropy;
+    direct.seedEnd = 4096;
+    found.clear();
+    ok = ok && WeakSeedScan(direct, entropies).run([&](const WeakScanMatch& m) {
+        found.push_back(m);
+    }) == 1 && found[0].seed == 41;
+    std::remove(targets.c_str());
+    printf("Weak seed scan %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
+void TestPreload()
+{
+    BIP39::preload({"english", "french"});
+    bool ok = Wordlist::french()->language() == "french" &&
+              Wordlist::english() == Wordlist::english();
+    try {
+        BIP39::preload({"klingon"});
+        ok = false;
+    } catch (const MnemonicException&) {
+    }
+    BIP39::warmup();
+    printf("Preload wordlists %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
+void TestConstantTimeLookup()
+{
+    bool ok = true;
+    for (Wordlist* list : {Wordlist::english(), Wordlist::french(), Wordlist::spanish()}) {
+        for (int i = 0; i < 2048; i++) {
+            ok = ok && list->findIndexCT(list->getWord(i)) == i;
+        }
+    }
+    Wordlist* english = Wordlist::english();
+    for (const std::string& word : {std::string(), std::string("aban"), std::string("abandons"),
+                                    std::string("zoozoozoo"), std::string("zoo\0", 4)}) {
+        ok = ok && english->findIndexCT(word) == -1;
+    }
+    // batched lookups, more words than one scan serves and some that miss
+    for (Wordlist* list : {Wordlist::english(), Wordlist::french()}) {
+        std::vector<std::string> words;
+        for (int i = 0; i < 21; i++) {
+            words.push_back(list->getWord(i * 97));
+        }
+        words[4] = "zoozoozoozoozoozoozoo";
+        words[13] = std::string("zoo\0", 4);
+        std::vector<int> indices(words.size());
+        list->findIndexCT(words.data(), words.size(), indices.data());
+        for (size_t i = 0; i < words.size(); i++) {
+            ok = ok && indices[i] == list->findIndexCT(words[i]);
+        }
+        ok = ok && indices[20] == 20 * 97 && indices[4] == -1 && indices[13] == -1;
+    }
+    printf("Constant-time wordlist lookup %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
+void TestScreening()
+{
+    // deterministic 16-byte entropies; odd ones are screened, even ones are not
+    auto entropy = [](uint32_t i) {
+        std::string e(16, '\0');
+        for (size_t k = 0; k < e.size(); k++) {
+            e[k] = (char)((i * 2654435761u) >> (k % 4 * 8)) ^ (char)k;
+        }
+        return e;
+    };
+    std::vector<std::string> listed;
+    for (uint32_t i = 1; i < 20000; i += 2) {
+        listed.push_back(entropy(i));
+    }
+    const std::string file = "screen-test.bin";
+    bool ok = MnemonicScreen::build(listed, file) == listed.size();
+    size_t falsePositives = 0;
+    {
+        MnemonicScreen screen(file);
+        for (uint32_t i = 0; i < 20000; i++) {
+            const std::string e = entropy(i);
+            auto p = reinterpret_cast<const uint8_t*>(e.data());
+            ok = ok && screen.contains(p, e.size()) == (i % 2 == 1);
+            falsePositives += i % 2 == 0 && screen.mayContain(p, e.size());
+        }
+        ok = ok && falsePositives < 100;
+
+        const Mnemonic leaked = BIP39::Entropy(BIP39_Utils::base16Encode(listed[7]));
+        const std::string phrase = joined_mnemonic(leaked.words);
+        MnemonicScreen::install(&screen);
+        try {
+            BIP39::Words(phrase);
+            ok = false;
+        } catch (const MnemonicException&) {
+        }
+        ok = ok && BIP39::Generate(12).m_wordsCount == 12;
+        MnemonicScreen::install(nullptr);
+        ok = ok && BIP39::Words(phrase).words == leaked.words;
+    }
+    std::remove(file.c_str());
+    printf("Mnemonic screening %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
+void TestDedup()
+{
+    std::vector<std::string> lines;
+    std::vector<std::string> hexes;
+    for (int i = 0; i < 40; i++) {
+        const Mnemonic m = BIP39::Generate(i % 3 ? 12 : 24);
+        hexes.push_back(m.entropy);
+        lines.push_back(joined_mnemonic(m.words));
+    }
+    // the same entropies again as upper-case hex and as a spaced-out phrase, and noise
+    for (int i = 0; i < 40; i += 4) {
+        std::string upper = hexes[i];
+        std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+        lines.push_back(upper);
+        lines.push_back("  " + lines[i + 1] + " \r");
+    }
+    lines.push_back(lines[5]);
+    lines.push_back("abandon abandon abandon abandon abandon abandon abandon abandon abandon "
+                    "abandon abandon abandon");
+    lines.push_back("not a mnemonic");
+    const std::string input = "dedup-test.txt", output = "dedup-test.out";
+    {
+        std::ofstream file(input);
+        for (size_t i = 0; i < lines.size(); i++) {
+            file << lines[(i * 11) % lines.size()] << '\n';
+        }
+    }
+
+    std::vector<std::string> expected = hexes;
+    std::sort(expected.begin(), expected.end(), [](const std::string& a, const std::string& b) {
+        return a.size() != b.size() ? a.size() < b.size() : a < b;
+    });
+    auto read = [&] {
+        std::ifstream file(output);
+        std::vector<std::string> out;
+        for (std::string line; std::getline(file, line);) {
+            out.push_back(line);
+        }
+        return out;
+    };
+    DedupOptions options;
+    options.threads = 2;
+    const DedupStats memory = MnemonicDedup::run({input}, output, options);
+    bool ok = read() == expected && memory.runs == 0 && memory.unique == 40 &&
+              memory.invalid == 2 && memory.duplicatedKeys == 20 && memory.maxCopies == 3 &&
+              memory.formats.at("hex") == 10;
+    // a tiny memory limit forces sorted runs and the merge
+    options.memoryLimit = 1000;
+    const DedupStats merged = MnemonicDedup::run({input}, output, options);
+    ok = ok && read() == expected && merged.runs > 1 && merged.unique == memory.unique &&
+         merged.copies == memory.copies;
+    // first-seen mode keeps the input order of the first copy of each key
+    std::vector<std::string> firstSeen;
+    for (size_t i = 0; i < lines.size(); i++) {
+        PackedEntropy key;
+        if (!MnemonicDedup::parse(lines[(i * 11) % lines.size()], key))
+            continue;
+        const std::string hex = MnemonicDedup::toHex(key);
+        if (std::find(firstSeen.begin(), firstSeen.end(), hex) == firstSeen.end())
+            firstSeen.push_back(hex);
+    }
+    options.memoryLimit = size_t(1) << 20;
+    options.firstSeen = true;
+    const DedupStats hashed = MnemonicDedup::run({input}, output, options);
+    ok = ok && read() == firstSeen && hashed.unique == memory.unique &&
+         hashed.copies == memory.copies && hashed.invalid == memory.invalid;
+    // French and Spanish phrases, accented words included, whose lists are not byte sorted
+    bool accented = false;
+    for (Wordlist* list : {Wordlist::french(), Wordlist::spanish()}) {
+        for (int i = 0; i < 40; i++) {
+            const int words = (int)hexes[i].size() * 3 / 8;
+            const Mnemonic m = BIP39(words).useEntropy(hexes[i]).wordList(list).mnemonic();
+            const std::string phrase = joined_mnemonic(m.words);
+            accented = accented || std::any_of(phrase.begin(), phrase.end(), [](char c) {
+                           return (unsigned char)c >= 0x80;
+                       });
+            PackedEntropy key;
+            std::string format;
+            ok = ok && MnemonicDedup::parse(phrase, key, &format) &&
+                 MnemonicDedup::toHex(key) == hexes[i] && format == list->language();
+        }
+    }
+    ok = ok && accented;
+
+    std::vector<PackedEntropy> keys(5000);
+    for (size_t i = 0; i < keys.size(); i++) {
+        for (size_t k = 0; k < PackedEntropy::SIZE; k++) {
+            keys[i].key[k] = (uint8_t)((i * 2654435761u) >> (k % 3 * 5));
+        }
+    }
+    std::vector<PackedEntropy> sorted = keys;
+    std::sort(sorted.begin(), sorted.end());
+    MnemonicDedup::sort(keys, 3);
+    ok = ok && std::equal(keys.begin(), keys.end(), sorted.begin());
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+    printf("Mnemonic dedup %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
+void TestHash160()
+{
+    auto hex = [](const uint8_t* p, size_t n) {
+        return BIP39_Utils::base16Encode(std::string((const char*)p, n));
+    };
+    uint8_t digest[RIPEMD160_DIGEST_LENGTH];
+    const std::pair<std::string, std::string> vectors[] = {
+        {"", "9c1185a5c5e9fc54612808977ee8f548b2258d31"},
+        {"abc", "8eb208f7e05d987a9b044a8e98c6b087f15a0bfc"},
+        {"message digest", "5d0689ef49d2fae572b881b123a85ffa21595f36"},
+        {"12345678901234567890123456789012345678901234567890123456789012345678901234567890",
+         "9b752e45573d4b39f4dbd3323cab82bf63326bfb"},
+    };
+    bool ok = true;
+    for (const auto& v : vectors) {
+        ripemd160_Raw((const uint8_t*)v.first.data(), v.first.size(), digest);
+        ok = ok && hex(digest, sizeof(digest)) == v.second;
+    }
+    // compressed public key of private key 1
+    const std::string generator = BIP39_Utils::base16Decode(
+        "0279be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798");
+    hash160_Raw((const uint8_t*)generator.data(), generator.size(), digest);
+    ok = ok && hex(digest, sizeof(digest)) == "751e76e8199196d454941c45d1b3a323f1433bd6";
+
+    // every kernel against hash160_Raw, with a count that leaves a scalar remainder
+    const size_t count = 37;
+    std::vector<uint8_t> keys(count * HASH160_COMPRESSED_PUBKEY_LENGTH);
+    for (size_t i = 0; i < keys.size(); i++) {
+        keys[i] = (uint8_t)(i * 167 + (i >> 5));
+    }
+    std::vector<uint8_t> expected(count * HASH160_DIGEST_LENGTH);
+    for (size_t i = 0; i < count; i++) {
+        hash160_Raw(
+            &keys[i * HASH160_COMPRESSED_PUBKEY_LENGTH],
+            HASH160_COMPRESSED_PUBKEY_LENGTH,
+            &expected[i * HASH160_DIGEST_LENGTH]);
+    }
+    for (int k = 0; k < SHA512_KERNEL_COUNT; k++) {
+        std::vector<uint8_t> digests(expected.size());
+        hash160_compressed_lanes((sha512_kernel)k, count, keys.data(), digests.data());
+        ok = ok && digests == expected;
+    }
+    printf("HASH160 %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
+void TestAddressCodec()
+{
+    const std::string hash = BIP39_Utils::base16Decode("751e76e8199196d454941c45d1b3a323f1433bd6");
+    auto hashBytes = reinterpret_cast<const uint8_t*>(hash.data());
+    const std::string taproot = BIP39_Utils::base16Decode(
+        "79be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798");
+    auto taprootBytes = reinterpret_cast<const uint8_t*>(taproot.data());
+
+    bool ok = AddressCodec::base58Addresses(0, hashBytes, 1)[0] ==
+                  "1BgGZ9tcN4rm9KBzDn7KprQz87SZ26SAMH" &&
+              AddressCodec::segwitAddresses("bc", hashBytes, 1)[0] ==
+                  "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kv8f3t4" &&
+              AddressCodec::segwitEncode("bc", 1, taprootBytes, taproot.size()) ==
+                  "bc1p0xlxvlhemja6c4dqv22uapctqupfhlxm9h8z3k2e72q4k9hcz7vqzk5jj0";
+
+    // the fixed 25-byte encoder against the generic one, with leading zero bytes
+    std::vector<uint8_t> hashes(64 * AddressCodec::HASH160_LENGTH);
+    for (size_t i = 0; i < hashes.size(); i++) {
+        hashes[i] = i % 20 < i / 320 ? 0 : (uint8_t)(i * 131 + 7);
+    }
+    const auto fixed = AddressCodec::base58Addresses(5, hashes.data(), 64);
+    const auto segwit = AddressCodec::segwitAddresses("tb", hashes.data(), 64);
+    std::vector<std::string> targets;
+    for (size_t i = 0; i < 64; i++) {
+        std::vector<uint8_t> payload{5};
+        payload.insert(payload.end(), &hashes[i * 20], &hashes[i * 20 + 20]);
+        ok = ok && fixed[i] == AddressCodec::base58CheckEncode(payload.data(), payload.size());
+        targets.push_back(i % 2 ? fixed[i] : segwit[i]);
+    }
+    const auto decoded = AddressCodec::decodeTargets(targets, "tb");
+    for (size_t i = 0; i < 64; i++) {
+        ok = ok && decoded[i].valid && decoded[i].segwit == (i % 2 == 0) &&
+             decoded[i].version == (i % 2 ? 5 : 0) && decoded[i].length == 20 &&
+             memcmp(decoded[i].program, &hashes[i * 20], 20) == 0;
+    }
+
+    // corrupted checksums, mixed case, wrong hrp and a Bech32 checksum on a v1 program
+    std::string typo = fixed[3];
+    typo[10] = typo[10] == 'z' ? 'y' : 'z';
+    const auto invalid = AddressCodec::decodeTargets(
+        {typo,
+         "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kv8f3t5",
+         "bc1Qw508d6qejxtdg4y5r3zarvary0c5xw7kv8f3t4",
+         "tb1qw508d6qejxtdg4y5r3zarvary0c5xw7kv8f3t4",
+         "bc1pw508d6qejxtdg4y5r3zarvary0c5xw7kw508d6qejxtdg4y5r3zarvary0c5xw7k7grplx"});
+    for (const auto& t : invalid) {
+        ok = ok && !t.valid;
+    }
+    ok = ok && AddressCodec::decodeTargets({"BC1QW508D6QEJXTDG4Y5R3ZARVARY0C5XW7KV8F3T4"})[0].valid;
+    printf("Address codec %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
+void TestWatchOnly()
+{
+    uint8_t keys[64] = {};
+    keys[31] = 1;
+    keys[63] = 3;
+    uint8_t pubs[66];
+    Secp256k1::publicKeys(keys, 2, pubs);
+    bool ok = BIP39_Utils::base16Encode(std::string((const char*)pubs, 66)) ==
+              "0279be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798"
+              "02f9308a019258c31049344f85f89d5229b531c845836f99b08601f113bce036f9";
+
+    // BIP44, BIP49 and BIP84 test vectors of "abandon ... about"
+    const Mnemonic abandon = BIP39::Entropy("00000000000000000000000000000000");
+    WatchOnlyOptions options;
+    options.gap = 2;
+    const auto mainnet = WatchOnlyExport::derive({abandon}, options);
+    const auto& bip44 = mainnet[0].accounts[0];
+    const auto& bip84 = mainnet[0].accounts[2];
+    ok = ok && BIP39_Utils::base16Encode(std::string((const char*)mainnet[0].fingerprint, 4)) ==
+                   "73c5da0a" &&
+         bip44.path == "m/44'/0'/0'" &&
+         bip44.xpub == "xpub6BosfCnifzxcFwrSzQiqu2DBVTshkCXacvNsWGYJVVhhawA7d4R5WSWGFNbi8Aw6ZRc1"
+                       "brxMyWMzG3DSSSSoekkudhUd9yLb6qx39T9nMdj" &&
+         bip44.receive[0] == "1LqBGSKuX5yYUonjxT5qGfpUsXKYYWeabA" &&
+         bip84.xpub == "zpub6rFR7y4Q2AijBEqTUquhVz398htDFrtymD9xYYfG1m4wAcvPhXNfE3EfH1r1ADqtfSdV"
+                       "CToUG868RvUUkgDKf31mGDtKsAYz2oz2AGutZYs" &&
+         bip84.receive[0] == "bc1qcr8te4kr609gcawutmrza0j4xv80jy8z306fyu" &&
+         bip84.receive[1] == "bc1qnjg0jd8228aq7egyzacy8cys3knf9xvrerkf9g" &&
+         bip84.change[0] == "bc1q8c6fshw2dlwun7ekn9qwf37cu2rn755upcp6el";
+    options.purposes = {49};
+    options.testnet = true;
+    const auto testnet = WatchOnlyExport::derive({abandon}, options);
+    ok = ok && testnet[0].accounts[0].path == "m/49'/1'/0'" &&
+         testnet[0].accounts[0].xpub ==
+             "upub5EFU65HtV5TeiSHmZZm7FUffBGy8UKeqp7vw43jYbvZPpoVsgU93oac7Wk3u6moKegAEWtGNF8DehrnHtv"
+             "21XXEMYRUocHqguyjknFHYfgY" &&
+         testnet[0].accounts[0].receive[0] == "2Mww8dCYPUpKHofjgcXcBCEGmniw9CoaiD2";
+
+    // a batch across full lane groups matches wallets derived one at a time
+    std::vector<Mnemonic> batch;
+    for (int i = 0; i < 19; i++) {
+        batch.push_back(BIP39::Generate(i % 2 ? 12 : 24));
+    }
+    options = WatchOnlyOptions{};
+    options.gap = 3;
+    const auto wallets = WatchOnlyExport::derive(batch, options);
+    for (size_t i = 0; i < batch.size(); i += 6) {
+        const auto single = WatchOnlyExport::derive({batch[i]}, options);
+        for (size_t a = 0; a < 3; a++) {
+            ok = ok && single[0].accounts[a].xpub == wallets[i].accounts[a].xpub &&
+                 single[0].accounts[a].receive == wallets[i].accounts[a].receive &&
+                 single[0].accounts[a].change == wallets[i].accounts[a].change;
+        }
+    }
+
+    std::ostringstream jsonl, binary;
+    WatchOnlyExport::writeJsonl(jsonl, mainnet);
+    WatchOnlyExport::writeBinary(binary, wallets);
+    ok = ok && jsonl.str().find("\"receive\":[\"bc1qcr8te4kr609gcawutmrza0j4xv80jy8z306fyu\",") !=
+                   std::string::npos &&
+         binary.str().size() == 12 + batch.size() * (4 + 3 * (4 + 78 + 2 * 3 * 20));
+    printf("Watch-only export %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
+void TestBip85()
+{
+    // BIP85 application 39 test vectors
+    Bip85 bip85(
+        "xprv9s21ZrQH143K2LBWUUQRFXhucrQqBpKdRRxNVq2zBqsx8HVqFk2uYo8kmbaLLHRdqtQpUm98uKfu3vca1Lqd"
+        "GhUtyoFnCNkfmXRyPXLjbKb");
+    const auto twelve = bip85.mnemonics(0, 16, 12);
+    const auto eighteen = bip85.mnemonics(0, 1, 18);
+    const auto twentyFour = bip85.mnemonics(0, 1, 24);
+    bool ok = joined_mnemonic(twelve[0].toMnemonic().words) ==
+                  "girl mad pet galaxy egg matter matrix prison refuse sense ordinary nose" &&
+              joined_mnemonic(eighteen[0].toMnemonic().words) ==
+                  "near account window bike charge season chef number sketch tomorrow excuse "
+                  "sniff circle vital hockey outdoor supply token" &&
+              joined_mnemonic(twentyFour[0].toMnemonic().words) ==
+                  "puppy ocean match cereal symbol another shed magic wrap hammer bulb intact "
+                  "gadget divorce twin tonight reason outdoor destroy simple truth cigar social "
+                  "volcano";
+
+    // a range equals its indices derived one at a time, and round-trips through BIP39
+    for (uint32_t i = 1; i < 16; i += 5) {
+        const auto one = bip85.mnemonics(i, i + 1, 12);
+        ok = ok && one[0].index == i && twelve[i].index == i &&
+             memcmp(one[0].entropy, twelve[i].entropy, 16) == 0 &&
+             BIP39::Entropy(twelve[i].toMnemonic().entropy).words == twelve[i].toMnemonic().words;
+    }
+    const auto french = bip85.mnemonics(0, 1, 12, "french");
+    ok = ok && french[0].wordlist == Wordlist::french() &&
+         memcmp(french[0].entropy, twelve[0].entropy, 16) != 0;
+    try {
+        bip85.mnemonics(0, 1, 15);
+        ok = false;
+    } catch (const MnemonicException&) {
+    }
+    printf("BIP85 child mnemonics %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
+void TestRecoveryEnumerator()
+{
+    // position 3 starts with "a", last word unknown: 2^7 checksum-valid last words each
+    const std::string pattern = "abandon abandon abandon a* abandon abandon abandon abandon "
+                                "abandon abandon abandon ?";
+    RecoveryEnumerator all(RecoveryEnumerator::parsePattern(pattern));
+    std::vector<std::string> found;
+    bool about = false, ok = true;
+    all.enumerate(0, all.size(), [&](const uint16_t* words, const uint8_t* entropy) {
+        found.push_back(BIP39_Utils::base16Encode(std::string((const char*)entropy, 16)));
+        about = about || (words[3] == 0 && words[11] == 3);
+        if (found.size() % 997 == 1) {
+            const Mnemonic m = BIP39::Entropy(found.back());
+            for (size_t w = 0; w < 12; w++) {
+                ok = ok && m.wordsIndex[w] == words[w];
+            }
+        }
+    });
+    ok = ok && about && found.size() == all.size() * 128 && all.expectedMatches() == found.size();
+
+    // shards cover the space exactly once
+    std::vector<std::string> sharded;
+    for (uint64_t part = 0; part < 3; part++) {
+        const auto r = all.range(part, 3);
+        all.enumerate(r.first, r.second, [&](const uint16_t*, const uint8_t* entropy) {
+            sharded.push_back(BIP39_Utils::base16Encode(std::string((const char*)entropy, 16)));
+        });
+    }
+    std::sort(found.begin(), found.end());
+    std::sort(sharded.begin(), sharded.end());
+    ok = ok && sharded == found && std::adjacent_find(found.begin(), found.end()) == found.end();
+
+    // a constrained last word against a direct checksum test
+    RecoveryEnumerator few(RecoveryEnumerator::parsePattern(
+        "? zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo "
+        "vote|wrong|zoo"));
+    uint64_t expected = 0;
+    for (int first = 0; first < 2048; first++) {
+        for (int last : {1967, 2037, 2047}) {
+            uint8_t packed[33] = {};
+            for (int bit = 0; bit < 264; bit++) {
+                const int word = bit < 11 ? first : bit >= 253 ? last : 2047;
+                packed[bit / 8] |= ((word >> (10 - bit % 11)) & 1) << (7 - bit % 8);
+            }
+            uint8_t hash[SHA256_DIGEST_LENGTH];
+            sha256_Raw(packed, 32, hash);
+            expected += hash[0] == packed[32];
+        }
+    }
+    ok = ok && few.size() == 2048 &&
+         few.enumerate(0, few.size(), [](const uint16_t*, const uint8_t*) {}) == expected;
+    printf("Recovery enumerator %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
+void TestVanitySearch()
+{
+    VanityOptions options;
+    options.prefix = "bc1qq";
+    options.threads = 2;
+    const VanityResult address = VanitySearch(options).run();
+    WatchOnlyOptions watch;
+    watch.purposes = {84};
+    watch.gap = 1;
+    bool ok = address.found && address.attempts > 0 && address.match.compare(0, 5, "bc1qq") == 0 &&
+              WatchOnlyExport::derive({address.mnemonic}, watch)[0].accounts[0].receive[0] ==
+                  address.match;
+
+    options.target = VanityTarget::Fingerprint;
+    options.prefix = "f";
+    const VanityResult fingerprint = VanitySearch(options).run();
+    const auto wallet = WatchOnlyExport::derive({fingerprint.mnemonic}, watch)[0];
+    ok = ok && fingerprint.found && fingerprint.match[0] == 'f' &&
+         BIP39_Utils::base16Encode(std::string((const char*)wallet.fingerprint, 4)) ==
+             fingerprint.match;
+
+    // an unreachable prefix stops at maxAttempts, and cancel() stops the search early
+    options.prefix = "00000000";
+    options.maxAttempts = 24;
+    const VanityResult limited = VanitySearch(options).run();
+    options.maxAttempts = 0;
+    VanitySearch endless(options);
+    uint64_t reports = 0;
+    const VanityResult cancelled = endless.run(
+        [&](const VanityProgress& p) {
+            reports++;
+            if (p.attempts > 0 && p.expectedSeconds > 0)
+                endless.cancel();
+        },
+        0.01);
+    ok = ok && !limited.found && limited.attempts == 24 && !cancelled.found && reports > 0;
+    // a cancel() before run() is not lost
+    VanitySearch early(options);
+    early.cancel();
+    const VanityResult skipped = early.run();
+    ok = ok && !skipped.found && skipped.attempts == 0;
+    try {
+        options.target = VanityTarget::Address;
+        options.prefix = "bc1qb";
+        VanitySearch invalid(options);
+        ok = false;
+    } catch (const MnemonicException&) {
+    }
+    printf("Vanity search %s\n", ok ? "[Pass]" : "[FAIL]");
+}
+
 int main()
 {
     TestEntropyToMnemnoic(
@@ -192,5 +1161,25 @@ int main()
         "screen patrol group space point ten exist slush involve unfold",
         "01f5bced59dec48e362f2c45b5de68b9fd6c92c6634f44d6d40aab69056506f0e35524a518034ddc1192e1dacd"
         "32c1ed3eaa3c3b131c88ed8e7e54c49a5d0998");
+
+    TestSeedClassification();
+    TestPbkdf2Resume();
+    TestSeedBatch();
+    TestTraceBuffers();
+    TestPbkdf2Sha256Batch();
+    TestPreload();
+    TestConstantTimeLookup();
+    TestScreening();
+    TestDedup();
+    TestHash160();
+    TestAddressCodec();
+    TestWatchOnly();
+    TestBip85();
+    TestRecoveryEnumerator();
+    TestVanitySearch();
+    TestPhraseValidator();
+    TestCInterface();
+    TestFingerprints();
+    TestWeakSeedScan();
     return 0;
 }
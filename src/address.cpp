@@ -0,0 +1,422 @@
+#include "address.h"
+#include "bip39.h"
+#include "pbkdf2_sha512/sha2.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace
+{
+const char BASE58[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+const char BECH32[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+constexpr uint32_t BASE58_5 = 58 * 58 * 58 * 58 * 58;    // five digits per 32-bit remainder
+constexpr uint32_t BECH32M_CONST = 0x2bc830a3;
+constexpr size_t ADDRESS_PAYLOAD = 1 + AddressCodec::HASH160_LENGTH;
+constexpr size_t MAX_BECH32_LENGTH = 90;
+
+// Big-endian 32-bit limbs of data, the first one holding the length % 4 leading bytes.
+void loadLimbs(const uint8_t* data, size_t length, uint32_t* limbs)
+{
+    const size_t count = (length + 3) / 4;
+    size_t byte = 0;
+    for (size_t i = 0; i < count; i++) {
+        const size_t take = i == 0 ? length - 4 * (count - 1) : 4;
+        uint32_t v = 0;
+        for (size_t k = 0; k < take; k++) {
+            v = v << 8 | data[byte++];
+        }
+        limbs[i] = v;
+    }
+}
+
+// Divides the limbs by 58^5 in place and returns the remainder.
+inline uint32_t divideBase58_5(uint32_t* limbs, size_t count)
+{
+    uint64_t rem = 0;
+    for (size_t i = 0; i < count; i++) {
+        const uint64_t cur = rem << 32 | limbs[i];
+        limbs[i] = (uint32_t)(cur / BASE58_5);
+        rem = cur % BASE58_5;
+    }
+    return (uint32_t)rem;
+}
+
+inline void remainderDigits(uint32_t rem, char* digits)
+{
+    for (int k = 0; k < 5; k++) {
+        digits[k] = (char)(rem % 58);
+        rem /= 58;
+    }
+}
+
+// Leading zero bytes become '1's, then `digits` (least significant first) without its zeros.
+std::string assemble(const uint8_t* data, size_t length, const char* digits, size_t count)
+{
+    size_t zeros = 0;
+    while (zeros < length && data[zeros] == 0) {
+        ++zeros;
+    }
+    while (count > 0 && digits[count - 1] == 0) {
+        --count;
+    }
+    std::string out(zeros + count, '1');
+    for (size_t i = 0; i < count; i++) {
+        out[zeros + i] = BASE58[(int)digits[count - 1 - i]];
+    }
+    return out;
+}
+
+std::string base58Encode(const uint8_t* data, size_t length)
+{
+    std::vector<uint32_t> limbs((length + 3) / 4);
+    loadLimbs(data, length, limbs.data());
+    std::vector<char> digits;
+    size_t first = 0;
+    while (first < limbs.size()) {
+        digits.resize(digits.size() + 5);
+        remainderDigits(
+            divideBase58_5(limbs.data() + first, limbs.size() - first), &digits[digits.size() - 5]);
+        while (first < limbs.size() && limbs[first] == 0) {
+            ++first;
+        }
+    }
+    return assemble(data, length, digits.data(), digits.size());
+}
+
+// Fixed-size encoder: every pass divides all the limbs, so the loops have constant trip counts
+// and unroll; N bytes need ceil(N * log58(256)) digits.
+template <size_t N>
+std::string base58EncodeFixed(const uint8_t* data)
+{
+    constexpr size_t LIMBS = (N + 3) / 4;
+    constexpr size_t PASSES = ((N * 1366 + 999) / 1000 + 4) / 5;
+    uint32_t limbs[LIMBS];
+    loadLimbs(data, N, limbs);
+    char digits[PASSES * 5];
+    for (size_t p = 0; p < PASSES; p++) {
+        remainderDigits(divideBase58_5(limbs, LIMBS), digits + 5 * p);
+    }
+    return assemble(data, N, digits, sizeof(digits));
+}
+
+bool base58Decode(const std::string& text, std::vector<uint8_t>& out)
+{
+    static const struct Map
+    {
+        int8_t value[256];
+        Map()
+        {
+            memset(value, -1, sizeof(value));
+            for (int i = 0; i < 58; i++) {
+                value[(uint8_t)BASE58[i]] = (int8_t)i;
+            }
+        }
+    } map;
+    size_t zeros = 0;
+    while (zeros < text.size() && text[zeros] == '1') {
+        ++zeros;
+    }
+    // little-endian 32-bit limbs, fed five digits at a time
+    std::vector<uint32_t> limbs;
+    for (size_t i = zeros; i < text.size();) {
+        uint32_t chunk = 0, scale = 1;
+        for (size_t end = std::min(text.size(), i + 5); i < end; i++) {
+            const int8_t d = map.value[(uint8_t)text[i]];
+            if (d < 0)
+                return false;
+            chunk = chunk * 58 + d;
+            scale *= 58;
+        }
+        uint64_t carry = chunk;
+        for (auto& l : limbs) {
+            carry += (uint64_t)l * scale;
+            l = (uint32_t)carry;
+            carry >>= 32;
+        }
+        if (carry)
+            limbs.push_back((uint32_t)carry);
+    }
+    out.assign(zeros, 0);
+    bool leading = true;
+    for (auto it = limbs.rbegin(); it != limbs.rend(); ++it) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            const uint8_t b = (uint8_t)(*it >> shift);
+            if (leading && b == 0)
+                continue;
+            leading = false;
+            out.push_back(b);
+        }
+    }
+    return true;
+}
+
+// First word of SHA-256(SHA-256(data)). Payloads up to 55 bytes are one block each, and the
+// second hash reads the first one's state words as its big-endian message words directly.
+uint32_t checksumWord(const uint8_t* data, size_t length)
+{
+    uint32_t state[8];
+    if (length <= 55) {
+        uint8_t block[SHA256_BLOCK_LENGTH] = {};
+        memcpy(block, data, length);
+        block[length] = 0x80;
+        uint32_t words[16];
+        for (int i = 0; i < 16; i++) {
+            words[i] = (uint32_t)block[4 * i] << 24 | (uint32_t)block[4 * i + 1] << 16 |
+                       (uint32_t)block[4 * i + 2] << 8 | block[4 * i + 3];
+        }
+        words[15] = (uint32_t)length * 8;
+        sha256_Transform(sha256_initial_hash_value, words, state);
+    } else {
+        uint8_t digest[SHA256_DIGEST_LENGTH];
+        sha256_Raw(data, length, digest);
+        for (int i = 0; i < 8; i++) {
+            state[i] = (uint32_t)digest[4 * i] << 24 | (uint32_t)digest[4 * i + 1] << 16 |
+                       (uint32_t)digest[4 * i + 2] << 8 | digest[4 * i + 3];
+        }
+    }
+    uint32_t words[16] = {};
+    memcpy(words, state, sizeof(state));
+    words[8] = 0x80000000;
+    words[15] = SHA256_DIGEST_LENGTH * 8;
+    sha256_Transform(sha256_initial_hash_value, words, state);
+    return state[0];
+}
+
+void appendChecksum(uint8_t* checksum, uint32_t word)
+{
+    for (int i = 0; i < 4; i++) {
+        checksum[i] = (uint8_t)(word >> (24 - 8 * i));
+    }
+}
+
+// BIP173 polymod, five bits per step: the generator terms of the five bits shifted out are
+// looked up at once.
+const uint32_t* polymodTable()
+{
+    static const struct Table
+    {
+        uint32_t value[32];
+        Table()
+        {
+            static const uint32_t GEN[5] = {
+                0x3b6a57b2, 0x26508e6d, 0x1ea119fa, 0x3d4233dd, 0x2a1462b3};
+            for (uint32_t top = 0; top < 32; top++) {
+                value[top] = 0;
+                for (int i = 0; i < 5; i++) {
+                    if ((top >> i) & 1)
+                        value[top] ^= GEN[i];
+                }
+            }
+        }
+    } table;
+    return table.value;
+}
+
+inline uint32_t polymodStep(const uint32_t* table, uint32_t chk, uint8_t value)
+{
+    return ((chk & 0x1ffffff) << 5 ^ value) ^ table[chk >> 25];
+}
+
+std::string lower(const std::string& s)
+{
+    std::string out = s;
+    std::transform(out.begin(), out.end(), out.begin(), [](unsigned char c) {
+        return (char)std::tolower(c);
+    });
+    return out;
+}
+
+// Checksum state after the expanded human-readable part.
+uint32_t hrpState(const std::string& hrp)
+{
+    const uint32_t* table = polymodTable();
+    uint32_t chk = 1;
+    for (unsigned char c : hrp) {
+        chk = polymodStep(table, chk, c >> 5);
+    }
+    chk = polymodStep(table, chk, 0);
+    for (unsigned char c : hrp) {
+        chk = polymodStep(table, chk, c & 31);
+    }
+    return chk;
+}
+
+bool validProgram(int version, size_t length)
+{
+    return version >= 0 && version <= 16 && length >= 2 && length <= 40 &&
+           (version != 0 || length == 20 || length == 32);
+}
+
+// Appends data, the witness version then the program in 5-bit groups, and the checksum.
+void appendSegwit(
+    std::string& out, uint32_t chk, int version, const uint8_t* program, size_t length)
+{
+    const uint32_t* table = polymodTable();
+    chk = polymodStep(table, chk, (uint8_t)version);
+    out += BECH32[version];
+    uint32_t acc = 0;
+    int bits = 0;
+    for (size_t i = 0; i < length; i++) {
+        acc = acc << 8 | program[i];
+        for (bits += 8; bits >= 5; bits -= 5) {
+            const uint8_t v = (acc >> (bits - 5)) & 31;
+            chk = polymodStep(table, chk, v);
+            out += BECH32[v];
+        }
+    }
+    if (bits) {
+        const uint8_t v = (acc << (5 - bits)) & 31;
+        chk = polymodStep(table, chk, v);
+        out += BECH32[v];
+    }
+    for (int i = 0; i < 6; i++) {
+        chk = polymodStep(table, chk, 0);
+    }
+    chk ^= version == 0 ? 1 : BECH32M_CONST;
+    for (int i = 0; i < 6; i++) {
+        out += BECH32[(chk >> (5 * (5 - i))) & 31];
+    }
+}
+}    // namespace
+
+std::string AddressCodec::base58CheckEncode(const uint8_t* payload, size_t length)
+{
+    std::vector<uint8_t> data(payload, payload + length);
+    data.resize(length + 4);
+    appendChecksum(&data[length], checksumWord(payload, length));
+    return base58Encode(data.data(), data.size());
+}
+
+bool AddressCodec::base58CheckDecode(const std::string& text, std::vector<uint8_t>& payload)
+{
+    std::vector<uint8_t> data;
+    if (!base58Decode(text, data) || data.size() < 4)
+        return false;
+    const size_t length = data.size() - 4;
+    uint8_t checksum[4];
+    appendChecksum(checksum, checksumWord(data.data(), length));
+    if (memcmp(checksum, &data[length], 4) != 0)
+        return false;
+    payload.assign(data.begin(), data.begin() + length);
+    return true;
+}
+
+std::vector<std::string> AddressCodec::base58Addresses(
+    uint8_t version, const uint8_t* hash160s, size_t count)
+{
+    std::vector<std::string> out;
+    out.reserve(count);
+    uint8_t data[ADDRESS_PAYLOAD + 4];
+    data[0] = version;
+    for (size_t i = 0; i < count; i++) {
+        memcpy(data + 1, hash160s + i * HASH160_LENGTH, HASH160_LENGTH);
+        appendChecksum(data + ADDRESS_PAYLOAD, checksumWord(data, ADDRESS_PAYLOAD));
+        out.push_back(base58EncodeFixed<sizeof(data)>(data));
+    }
+    return out;
+}
+
+std::string AddressCodec::segwitEncode(
+    const std::string& hrp, int version, const uint8_t* program, size_t length)
+{
+    if (!validProgram(version, length))
+        throw MnemonicException("Invalid witness program");
+    const std::string prefix = lower(hrp);
+    std::string out = prefix + '1';
+    appendSegwit(out, hrpState(prefix), version, program, length);
+    return out;
+}
+
+bool AddressCodec::segwitDecode(
+    const std::string& hrp,
+    const std::string& address,
+    int& version,
+    std::vector<uint8_t>& program)
+{
+    if (address.size() > MAX_BECH32_LENGTH)
+        return false;
+    bool hasLower = false, hasUpper = false;
+    for (unsigned char c : address) {
+        if (c < 33 || c > 126)
+            return false;
+        hasLower |= c >= 'a' && c <= 'z';
+        hasUpper |= c >= 'A' && c <= 'Z';
+    }
+    if (hasLower && hasUpper)
+        return false;
+    const std::string text = lower(address);
+    const size_t separator = text.rfind('1');
+    const std::string prefix = lower(hrp);
+    if (separator == std::string::npos || separator + 8 > text.size() ||
+        text.compare(0, separator, prefix) != 0 || separator != prefix.size())
+        return false;
+
+    const uint32_t* table = polymodTable();
+    uint32_t chk = hrpState(prefix);
+    std::vector<uint8_t> data;
+    for (size_t i = separator + 1; i < text.size(); i++) {
+        const char* p = strchr(BECH32, text[i]);
+        if (p == nullptr || *p == '\0')
+            return false;
+        data.push_back((uint8_t)(p - BECH32));
+        chk = polymodStep(table, chk, data.back());
+    }
+    version = data[0];
+    if (chk != (version == 0 ? 1 : BECH32M_CONST))
+        return false;
+
+    program.clear();
+    uint32_t acc = 0;
+    int bits = 0;
+    for (size_t i = 1; i + 6 < data.size(); i++) {
+        acc = acc << 5 | data[i];
+        bits += 5;
+        if (bits >= 8) {
+            bits -= 8;
+            program.push_back((uint8_t)(acc >> bits));
+        }
+    }
+    // padding must be under a byte and all zero
+    if (bits >= 5 || (acc & ((1u << bits) - 1)) != 0)
+        return false;
+    return validProgram(version, program.size());
+}
+
+std::vector<std::string> AddressCodec::segwitAddresses(
+    const std::string& hrp, const uint8_t* hash160s, size_t count)
+{
+    const std::string prefix = lower(hrp) + '1';
+    const uint32_t chk = hrpState(lower(hrp));
+    std::vector<std::string> out(count);
+    for (size_t i = 0; i < count; i++) {
+        out[i].reserve(prefix.size() + 39);
+        out[i] = prefix;
+        appendSegwit(out[i], chk, 0, hash160s + i * HASH160_LENGTH, HASH160_LENGTH);
+    }
+    return out;
+}
+
+std::vector<AddressTarget> AddressCodec::decodeTargets(
+    const std::vector<std::string>& addresses, const std::string& hrp)
+{
+    std::vector<AddressTarget> targets(addresses.size());
+    std::vector<uint8_t> bytes;
+    for (size_t i = 0; i < addresses.size(); i++) {
+        AddressTarget& t = targets[i];
+        int version;
+        if (segwitDecode(hrp, addresses[i], version, bytes)) {
+            t.valid = t.segwit = true;
+            t.version = (uint8_t)version;
+        } else if (base58CheckDecode(addresses[i], bytes) && bytes.size() == ADDRESS_PAYLOAD) {
+            t.valid = true;
+            t.version = bytes[0];
+            bytes.erase(bytes.begin());
+        } else {
+            continue;
+        }
+        t.length = bytes.size();
+        memcpy(t.program, bytes.data(), bytes.size());
+    }
+    return targets;
+}
@@ -0,0 +1,52 @@
+#ifndef ADDRESS_H
+#define ADDRESS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Raw form of an address to match derived keys against.
+struct AddressTarget
+{
+    bool valid{false};
+    bool segwit{false};
+    uint8_t version{0};    // Base58 version byte, or the witness version
+    uint8_t program[40];   // HASH160 of P2PKH/P2SH and P2WPKH, or the witness program
+    size_t length{0};
+};
+
+class AddressCodec
+{
+public:
+    static constexpr size_t HASH160_LENGTH = 20;
+
+    // Base58Check of `payload` (the version byte included).
+    static std::string base58CheckEncode(const uint8_t* payload, size_t length);
+    static bool base58CheckDecode(const std::string& text, std::vector<uint8_t>& payload);
+
+    // Base58Check addresses of `count` back to back HASH160s under one version byte
+    // (0 for P2PKH, 5 for P2SH on mainnet). Uses a 25-byte fixed-size encoder.
+    static std::vector<std::string> base58Addresses(
+        uint8_t version, const uint8_t* hash160s, size_t count);
+
+    // Segwit addresses: Bech32 for witness version 0 and Bech32m above (BIP173, BIP350).
+    // Throws MnemonicException on a bad version or program length.
+    static std::string segwitEncode(
+        const std::string& hrp, int version, const uint8_t* program, size_t length);
+    static bool segwitDecode(
+        const std::string& hrp,
+        const std::string& address,
+        int& version,
+        std::vector<uint8_t>& program);
+
+    // P2WPKH addresses of `count` back to back HASH160s; the hrp is folded into the checksum
+    // state once for the batch.
+    static std::vector<std::string> segwitAddresses(
+        const std::string& hrp, const uint8_t* hash160s, size_t count);
+
+    // Decodes Base58Check and segwit addresses for `hrp`; unparsable ones come back invalid.
+    static std::vector<AddressTarget> decodeTargets(
+        const std::vector<std::string>& addresses, const std::string& hrp = "bc");
+};
+
+#endif // ADDRESS_H
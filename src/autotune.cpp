@@ -0,0 +1,254 @@
+#include "autotune.h"
+#include "pbkdf2_sha512/pbkdf2.hpp"
+#include "trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#    include <cpuid.h>
+#endif
+
+namespace
+{
+const char CACHE_HEADER[] = "# bip39-cxx autotune v1";
+
+// Short PBKDF2 runs keep each sample well below the per-candidate time slice.
+constexpr uint32_t SAMPLE_ITERATIONS = 256;
+
+// Throughput in SHA-512 compressions per second of `config` over `slice`.
+double measure(const BatchConfig& config, std::chrono::nanoseconds slice)
+{
+    std::atomic<uint64_t> total{0};
+    const auto deadline = std::chrono::steady_clock::now() + slice;
+    auto worker = [&]() {
+        static const uint8_t pass[] = "abandon abandon abandon abandon abandon abandon abandon "
+                                      "abandon abandon abandon abandon about";
+        static const uint8_t salt[] = "mnemonic";
+        const uint8_t* passes[SHA512_MAX_LANES];
+        const uint8_t* salts[SHA512_MAX_LANES];
+        int passlen[SHA512_MAX_LANES];
+        int saltlen[SHA512_MAX_LANES];
+        uint8_t keys[SHA512_MAX_LANES * SHA512_DIGEST_LENGTH];
+        for (size_t l = 0; l < config.lanes; l++) {
+            passes[l] = pass;
+            passlen[l] = sizeof(pass) - 1;
+            salts[l] = salt;
+            saltlen[l] = sizeof(salt) - 1;
+        }
+        uint64_t done = 0;
+        do {
+            pbkdf2_hmac_sha512_lanes(
+                config.kernel,
+                config.lanes,
+                passes,
+                passlen,
+                salts,
+                saltlen,
+                SAMPLE_ITERATIONS,
+                keys);
+            done += config.lanes * SAMPLE_ITERATIONS * 2;
+        } while (std::chrono::steady_clock::now() < deadline);
+        total += done;
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < config.threads; t++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : pool) {
+        t.join();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return total / elapsed.count();
+}
+
+bool parseKernel(const std::string& name, sha512_kernel& kernel)
+{
+    for (int k = 0; k < SHA512_KERNEL_COUNT; k++) {
+        if (name == sha512_kernel_name(static_cast<sha512_kernel>(k))) {
+            kernel = static_cast<sha512_kernel>(k);
+            return true;
+        }
+    }
+    return false;
+}
+}    // namespace
+
+std::string Autotune::cpuModel()
+{
+    std::string model;
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    unsigned int regs[12];
+    if (__get_cpuid(0x80000000, &regs[0], &regs[1], &regs[2], &regs[3]) &&
+        regs[0] >= 0x80000004) {
+        for (unsigned int leaf = 0; leaf < 3; leaf++) {
+            __get_cpuid(0x80000002 + leaf, &regs[0], &regs[1], &regs[2], &regs[3]);
+            model.append(reinterpret_cast<const char*>(regs), 16);
+        }
+        model = model.c_str();
+    }
+#endif
+    if (model.empty()) {
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line)) {
+            if (line.compare(0, 10, "model name") == 0 || line.compare(0, 9, "Processor") == 0) {
+                model = line.substr(line.find(':') + 1);
+                break;
+            }
+        }
+    }
+    std::string key;
+    std::istringstream words(model);
+    for (std::string word; words >> word;) {
+        key += key.empty() ? word : " " + word;
+    }
+    if (key.empty())
+        key = "unknown";
+    return key + " x" + std::to_string(std::thread::hardware_concurrency());
+}
+
+std::string Autotune::defaultCacheFile()
+{
+    if (const char* dir = std::getenv("XDG_CACHE_HOME"))
+        return std::string(dir) + "/bip39-cxx/autotune";
+    if (const char* home = std::getenv("HOME"))
+        return std::string(home) + "/.cache/bip39-cxx/autotune";
+    return "bip39-cxx-autotune";
+}
+
+BatchConfig Autotune::run(std::chrono::milliseconds budget)
+{
+    BIP39_TRACE_SCOPE("autotune");
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<BatchConfig> lanesCandidates;
+    for (int k = 0; k < SHA512_KERNEL_COUNT; k++) {
+        auto kernel = static_cast<sha512_kernel>(k);
+        if (!sha512_kernel_supported(kernel))
+            continue;
+        const size_t width = sha512_kernel_width(kernel);
+        // the scalar kernel walks lanes one by one, so wider groups cannot help it
+        const size_t maxLanes = width == 1 ? 1 : SHA512_MAX_LANES;
+        for (size_t lanes = width; lanes <= maxLanes; lanes *= 2) {
+            lanesCandidates.push_back({kernel, lanes, 1});
+        }
+    }
+    std::vector<unsigned> threadCandidates{hardware};
+    if (hardware >= 2)
+        threadCandidates.push_back(hardware / 2);
+
+    // first pick the lane count per kernel on one thread, then the thread count per kernel
+    const size_t kernels = SHA512_KERNEL_COUNT;
+    const size_t slices = lanesCandidates.size() + kernels * threadCandidates.size();
+    const auto slice = std::chrono::duration_cast<std::chrono::nanoseconds>(budget) / slices;
+
+    BatchConfig perKernel[SHA512_KERNEL_COUNT];
+    double perKernelRate[SHA512_KERNEL_COUNT] = {};
+    for (const auto& candidate : lanesCandidates) {
+        const double rate = measure(candidate, slice);
+        if (rate > perKernelRate[candidate.kernel]) {
+            perKernelRate[candidate.kernel] = rate;
+            perKernel[candidate.kernel] = candidate;
+        }
+    }
+
+    BatchConfig best = SeedBatch::defaultConfig();
+    double bestRate = 0;
+    for (size_t k = 0; k < kernels; k++) {
+        if (perKernelRate[k] == 0)
+            continue;
+        for (unsigned threads : threadCandidates) {
+            BatchConfig candidate = perKernel[k];
+            candidate.threads = threads;
+            const double rate = threads == 1 ? perKernelRate[k] : measure(candidate, slice);
+            if (rate > bestRate) {
+                bestRate = rate;
+                best = candidate;
+            }
+        }
+    }
+    return best;
+}
+
+bool Autotune::load(const std::string& cacheFile, BatchConfig& config)
+{
+    std::ifstream file(cacheFile);
+    std::string line;
+    if (!std::getline(file, line) || line != CACHE_HEADER)
+        return false;
+    const std::string model = cpuModel();
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string key, kernelName;
+        BatchConfig cached;
+        if (!std::getline(fields, key, '\t') || key != model)
+            continue;
+        if (std::getline(fields, kernelName, '\t') && parseKernel(kernelName, cached.kernel) &&
+            fields >> cached.lanes >> cached.threads && SeedBatch::isValid(cached)) {
+            config = cached;
+            return true;
+        }
+        return false;
+    }
+    return false;
+}
+
+bool Autotune::store(const std::string& cacheFile, const BatchConfig& config)
+{
+    const std::string model = cpuModel();
+    std::vector<std::string> lines;
+    {
+        std::ifstream file(cacheFile);
+        std::string line;
+        if (std::getline(file, line) && line == CACHE_HEADER) {
+            while (std::getline(file, line)) {
+                if (line.compare(0, model.size() + 1, model + "\t") != 0)
+                    lines.push_back(line);
+            }
+        }
+    }
+    std::ostringstream entry;
+    entry << model << '\t' << sha512_kernel_name(config.kernel) << '\t' << config.lanes << '\t'
+          << config.threads;
+    lines.push_back(entry.str());
+
+    BIP39_TRACE_SCOPE("autotune cache write");
+    std::error_code ec;
+    const auto parent = std::filesystem::path(cacheFile).parent_path();
+    if (!parent.empty())
+        std::filesystem::create_directories(parent, ec);
+    // write a sibling file and rename it so concurrent startups never read a torn cache
+    const std::string tmp = cacheFile + ".tmp" + std::to_string(std::random_device{}());
+    {
+        std::ofstream file(tmp, std::ios::trunc);
+        file << CACHE_HEADER << '\n';
+        for (const auto& line : lines) {
+            file << line << '\n';
+        }
+        if (!file)
+            return false;
+    }
+    std::filesystem::rename(tmp, cacheFile, ec);
+    return !ec;
+}
+
+BatchConfig Autotune::apply(const std::string& cacheFile, std::chrono::milliseconds budget)
+{
+    BatchConfig config;
+    if (!load(cacheFile, config)) {
+        config = run(budget);
+        store(cacheFile, config);
+    }
+    SeedBatch::configure(config);
+    return config;
+}
@@ -0,0 +1,30 @@
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <chrono>
+#include <string>
+
+#include "batch.h"
+
+class Autotune
+{
+public:
+    static constexpr std::chrono::milliseconds DEFAULT_BUDGET{300};
+
+    // Microbenchmarks kernels, lane counts and thread counts within roughly `budget`.
+    static BatchConfig run(std::chrono::milliseconds budget = DEFAULT_BUDGET);
+
+    // Applies the configuration cached for this CPU, running and caching a new one when missing.
+    static BatchConfig apply(
+        const std::string& cacheFile = defaultCacheFile(),
+        std::chrono::milliseconds budget = DEFAULT_BUDGET);
+
+    static bool load(const std::string& cacheFile, BatchConfig& config);
+    static bool store(const std::string& cacheFile, const BatchConfig& config);
+
+    // Cache key: CPU brand string and logical CPU count.
+    static std::string cpuModel();
+    static std::string defaultCacheFile();
+};
+
+#endif // AUTOTUNE_H
@@ -0,0 +1,210 @@
+#include "batch.h"
+#include "bip39.h"
+#include "mnemonic.h"
+#include "pbkdf2_sha512/memzero.h"
+#include "pbkdf2_sha512/pbkdf2.hpp"
+#include "probes.h"
+#include "shadow.h"
+#include "trace.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+std::mutex configMutex;
+
+BatchConfig& currentConfig()
+{
+    static BatchConfig config = SeedBatch::defaultConfig();
+    return config;
+}
+}    // namespace
+
+BatchConfig SeedBatch::defaultConfig()
+{
+    BatchConfig config;
+    config.kernel = sha512_kernel_default();
+    config.lanes = sha512_kernel_width(config.kernel);
+    config.threads = std::max(1u, std::thread::hardware_concurrency());
+    return config;
+}
+
+bool SeedBatch::isValid(const BatchConfig& config) noexcept
+{
+    if (config.kernel >= SHA512_KERNEL_COUNT || !sha512_kernel_supported(config.kernel))
+        return false;
+    const size_t width = sha512_kernel_width(config.kernel);
+    return config.lanes >= width && config.lanes <= SHA512_MAX_LANES &&
+           config.lanes % width == 0 && config.threads > 0;
+}
+
+BatchConfig SeedBatch::config()
+{
+    std::lock_guard<std::mutex> lock(configMutex);
+    return currentConfig();
+}
+
+void SeedBatch::configure(const BatchConfig& config)
+{
+    if (!isValid(config))
+        throw MnemonicException("Invalid batch configuration");
+    std::lock_guard<std::mutex> lock(configMutex);
+    currentConfig() = config;
+}
+
+std::vector<uint8_t> SeedBatch::generateSeeds(
+    const std::vector<Mnemonic>& mnemonics, const std::string& passphrase)
+{
+    std::vector<std::string> phrases;
+    phrases.reserve(mnemonics.size());
+    for (const auto& m : mnemonics) {
+        phrases.emplace_back(BIP39_Utils::Join(m.words, " "));
+    }
+    std::vector<uint8_t> seeds(mnemonics.size() * SEED_LENGTH);
+    generateSeeds(phrases, passphrase, seeds.data(), config());
+    return seeds;
+}
+
+void SeedBatch::generateSeeds(
+    const std::vector<std::string>& phrases,
+    const std::string& passphrase,
+    uint8_t* out,
+    const BatchConfig& requested)
+{
+    BatchConfig config = requested;
+    // a kernel disabled at runtime (e.g. by shadow mode) falls back to the scalar reference
+    if (config.kernel < SHA512_KERNEL_COUNT && !sha512_kernel_supported(config.kernel))
+        config.kernel = SHA512_KERNEL_SCALAR;
+    if (!isValid(config))
+        throw MnemonicException("Invalid batch configuration");
+    BIP39_TRACE_SCOPE("seed batch");
+
+    static constexpr int rounds = 2048;
+    const std::string salt{"mnemonic" + passphrase};
+    const size_t lanes = config.lanes;
+    const size_t groups = (phrases.size() + lanes - 1) / lanes;
+    std::atomic<size_t> next{0};
+    BIP39_PROBE4(batch__dispatch, phrases.size(), (int)config.kernel, lanes, config.threads);
+
+    auto worker = [&]() {
+        const uint8_t* pass[SHA512_MAX_LANES];
+        const uint8_t* salts[SHA512_MAX_LANES];
+        int passlen[SHA512_MAX_LANES];
+        int saltlen[SHA512_MAX_LANES];
+        uint8_t keys[SHA512_MAX_LANES * SEED_LENGTH];
+        Trace::nameThread("seed batch worker");
+        for (size_t g; (g = next.fetch_add(1)) < groups;) {
+            BIP39_TRACE_SCOPE("pbkdf2 group");
+            const size_t first = g * lanes;
+            const size_t used = std::min(lanes, phrases.size() - first);
+            for (size_t l = 0; l < lanes; l++) {
+                // idle lanes of the last group repeat its first phrase
+                const std::string& phrase = phrases[first + (l < used ? l : 0)];
+                pass[l] = reinterpret_cast<const uint8_t*>(phrase.data());
+                passlen[l] = (int)phrase.size();
+                salts[l] = reinterpret_cast<const uint8_t*>(salt.data());
+                saltlen[l] = (int)salt.size();
+            }
+            pbkdf2_hmac_sha512_lanes(
+                config.kernel, lanes, pass, passlen, salts, saltlen, rounds, keys);
+            memcpy(out + first * SEED_LENGTH, keys, used * SEED_LENGTH);
+            if (ShadowCheck::enabled()) {
+                for (size_t l = 0; l < used; l++) {
+                    ShadowCheck::sample(
+                        config.kernel, phrases[first + l], salt, keys + l * SEED_LENGTH);
+                }
+            }
+        }
+        memzero(keys, sizeof(keys));
+    };
+
+    const size_t threads = std::min<size_t>(config.threads, groups);
+    if (threads <= 1) {
+        worker();
+        BIP39_PROBE1(batch__done, phrases.size());
+        return;
+    }
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (size_t t = 1; t < threads; t++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : pool) {
+        t.join();
+    }
+    BIP39_PROBE1(batch__done, phrases.size());
+}
+
+std::vector<uint8_t> Pbkdf2Batch::deriveSha256(
+    const std::vector<Pbkdf2Job>& jobs, const BatchConfig& requested)
+{
+    BatchConfig config = requested;
+    if (config.kernel < SHA512_KERNEL_COUNT && !sha512_kernel_supported(config.kernel))
+        config.kernel = SHA512_KERNEL_SCALAR;
+    if (!SeedBatch::isValid(config))
+        throw MnemonicException("Invalid batch configuration");
+    BIP39_TRACE_SCOPE("pbkdf2-sha256 batch");
+
+    const size_t lanes = std::min<size_t>(
+        SHA256_MAX_LANES,
+        config.lanes / sha512_kernel_width(config.kernel) * sha256_kernel_width(config.kernel));
+    // a lane group runs as long as its highest count, so neighbours by count share groups
+    std::vector<size_t> order(jobs.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return jobs[a].iterations > jobs[b].iterations;
+    });
+    const size_t groups = (order.size() + lanes - 1) / lanes;
+
+    std::vector<uint8_t> out(jobs.size() * KEY_LENGTH);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        const uint8_t* pass[SHA256_MAX_LANES];
+        const uint8_t* salts[SHA256_MAX_LANES];
+        int passlen[SHA256_MAX_LANES];
+        int saltlen[SHA256_MAX_LANES];
+        uint32_t iterations[SHA256_MAX_LANES];
+        uint8_t keys[SHA256_MAX_LANES * KEY_LENGTH];
+        Trace::nameThread("pbkdf2-sha256 worker");
+        for (size_t g; (g = next.fetch_add(1)) < groups;) {
+            BIP39_TRACE_SCOPE("pbkdf2-sha256 group");
+            const size_t first = g * lanes;
+            const size_t used = std::min(lanes, order.size() - first);
+            for (size_t l = 0; l < lanes; l++) {
+                // idle lanes of the last group repeat its first job
+                const Pbkdf2Job& job = jobs[order[first + (l < used ? l : 0)]];
+                pass[l] = reinterpret_cast<const uint8_t*>(job.password.data());
+                passlen[l] = (int)job.password.size();
+                salts[l] = reinterpret_cast<const uint8_t*>(job.salt.data());
+                saltlen[l] = (int)job.salt.size();
+                iterations[l] = job.iterations;
+            }
+            pbkdf2_hmac_sha256_lanes(
+                config.kernel, lanes, pass, passlen, salts, saltlen, iterations, keys);
+            for (size_t l = 0; l < used; l++) {
+                memcpy(
+                    out.data() + order[first + l] * KEY_LENGTH, keys + l * KEY_LENGTH, KEY_LENGTH);
+            }
+        }
+        memzero(keys, sizeof(keys));
+    };
+
+    const size_t threads = std::min<size_t>(config.threads, groups);
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; t++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : pool) {
+        t.join();
+    }
+    return out;
+}
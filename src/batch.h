@@ -0,0 +1,64 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "pbkdf2_sha512/sha512_lanes.h"
+
+class Mnemonic;
+
+struct BatchConfig
+{
+    sha512_kernel kernel{SHA512_KERNEL_SCALAR};
+    size_t lanes{1};
+    unsigned threads{1};
+};
+
+class SeedBatch
+{
+public:
+    static constexpr int SEED_LENGTH = 64;
+
+    // Process-wide configuration used by the batch APIs, initially the widest kernel on all cores.
+    static BatchConfig config();
+    static void configure(const BatchConfig& config);
+    static BatchConfig defaultConfig();
+    static bool isValid(const BatchConfig& config) noexcept;
+
+    // Seeds of all mnemonics, SEED_LENGTH bytes each, concatenated in input order.
+    static std::vector<uint8_t> generateSeeds(
+        const std::vector<Mnemonic>& mnemonics, const std::string& passphrase = "");
+
+    // Same for space separated phrases, writing phrases.size() * SEED_LENGTH bytes to out.
+    static void generateSeeds(
+        const std::vector<std::string>& phrases,
+        const std::string& passphrase,
+        uint8_t* out,
+        const BatchConfig& config);
+};
+
+struct Pbkdf2Job
+{
+    std::string password;
+    std::string salt;
+    uint32_t iterations;
+};
+
+class Pbkdf2Batch
+{
+public:
+    static constexpr int KEY_LENGTH = 32;
+
+    /*
+     * PBKDF2-HMAC-SHA256 keys of all jobs, KEY_LENGTH bytes each, in input order. Jobs are
+     * grouped into lanes by descending iteration count, so each group runs about as long as
+     * its jobs need, on the kernel of `config` at the SHA-256 width: twice the lanes of its
+     * SHA-512 configuration.
+     */
+    static std::vector<uint8_t> deriveSha256(
+        const std::vector<Pbkdf2Job>& jobs, const BatchConfig& config = SeedBatch::config());
+};
+
+#endif // BATCH_H
@@ -1,6 +1,10 @@
 #include "bip39.h"
+#include "batch.h"
 #include "mnemonic.h"
+#include "pbkdf2_sha512/memzero.h"
 #include "pbkdf2_sha512/sha2.hpp"
+#include "probes.h"
+#include "screen.h"
 #include "utils.h"
 
 #include <iostream>
@@ -20,6 +24,13 @@
 #    define NT_SUCCESS(Status) (((NTSTATUS)(Status)) >= 0)
 #endif
 
+// Generated and imported mnemonics are refused when an installed screen lists them.
+static bool screened(const Mnemonic& mnemonic)
+{
+    const MnemonicScreen* screen = MnemonicScreen::installed();
+    return screen && screen->contains(mnemonic);
+}
+
 BIP39::BIP39(int wordCount)
 {
     if (wordCount < 12 || wordCount > 24) {
@@ -47,7 +58,11 @@ Mnemonic BIP39::Entropy(const std::string& entropy)
     auto checksumBits = ((entropyBits - 128) / 32) + 4;
     auto wordsCount = (entropyBits + checksumBits) / 11;
     try {
-        return BIP39(wordsCount).useEntropy(entropy).wordList(Wordlist::english()).mnemonic();
+        auto mnemonic =
+            BIP39(wordsCount).useEntropy(entropy).wordList(Wordlist::english()).mnemonic();
+        if (screened(mnemonic))
+            throw MnemonicException("Mnemonic is on a screening list");
+        return mnemonic;
     } catch (...) {
         throw;
     }
@@ -55,7 +70,42 @@ Mnemonic BIP39::Entropy(const std::string& entropy)
 
 Mnemonic BIP39::Generate(int wordCount)
 {
-    return BIP39(wordCount).generateSecureEntropy().wordList(Wordlist::english()).mnemonic();
+    BIP39_PROBE1(generate__entry, wordCount);
+    auto mnemonic =
+        BIP39(wordCount).generateSecureEntropy().wordList(Wordlist::english()).mnemonic();
+    // a hit means the entropy source is reproducing a known output, so retry only a few times
+    for (int attempt = 1; screened(mnemonic); attempt++) {
+        if (attempt == 4)
+            throw MnemonicException("Generated mnemonics keep hitting the screening list");
+        mnemonic =
+            BIP39(wordCount).generateSecureEntropy().wordList(Wordlist::english()).mnemonic();
+    }
+    BIP39_PROBE1(generate__return, wordCount);
+    return mnemonic;
+}
+
+void BIP39::preload(const std::vector<std::string>& languages)
+{
+    BIP39_PROBE1(preload__entry, languages.size());
+    for (const auto& language : languages) {
+        if (Wordlist::getLanguage(language.c_str()) == nullptr)
+            throw MnemonicException("Failed to load wordlist: " + language);
+    }
+    SeedBatch::config();
+    BIP39_PROBE1(preload__return, languages.size());
+}
+
+void BIP39::warmup(const std::vector<std::string>& languages)
+{
+    preload(languages);
+    const Mnemonic mnemonic = Generate(12);
+    const std::string phrase = BIP39_Utils::Join(mnemonic.words, " ");
+    BatchConfig config = SeedBatch::config();
+    config.threads = 1;
+    std::vector<std::string> phrases(config.lanes, phrase);
+    std::vector<uint8_t> seeds(phrases.size() * SeedBatch::SEED_LENGTH);
+    SeedBatch::generateSeeds(phrases, "", seeds.data(), config);
+    memzero(seeds.data(), seeds.size());
 }
 
 bool BIP39::validateEntropy(const std::string& entropy) noexcept
@@ -88,9 +138,15 @@ Mnemonic BIP39::Words(const std::string& words, Wordlist* wordlist, bool verifyC
         spWords.emplace_back(word);
     }
     auto wordCount = spWords.size();
+    BIP39_PROBE2(words__entry, wordCount, verifyChecksum);
     try {
-        return BIP39(wordCount).wordList(wordlist).reverse(spWords, verifyChecksum);
+        auto mnemonic = BIP39(wordCount).wordList(wordlist).reverse(spWords, verifyChecksum);
+        if (screened(mnemonic))
+            throw MnemonicException("Mnemonic is on a screening list");
+        BIP39_PROBE2(words__return, wordCount, 1);
+        return mnemonic;
     } catch (const MnemonicException& e) {
+        BIP39_PROBE2(words__return, wordCount, 0);
         throw e;
     }
 }
@@ -130,6 +186,7 @@ BIP39 BIP39::generateSecureEntropy()
         ret = NT_SUCCESS(BCryptGenRandom(bcrypt_algo, bytes, (ulong)size, 0));
     }
     if (!ret) {
+        free(bytes);
         throw MnemonicException("Failed to get random bytes on windows");
     }
 
@@ -138,6 +195,7 @@ BIP39 BIP39::generateSecureEntropy()
     ssize_t n;
     size_t size = m_entropyBits / 8;
     unsigned char* bytes = (unsigned char*)malloc(size);
+    BIP39_PROBE1(entropy__refill__entry, size);
     while (read_bytes < size) {
         size_t amount_to_read = size - read_bytes;
         n = syscall(SYS_getrandom, bytes + read_bytes, amount_to_read, 0);
@@ -159,10 +217,15 @@ BIP39 BIP39::generateSecureEntropy()
         }
         read_bytes += (size_t)n;
     }
-    std::string bin_rand{reinterpret_cast<char*>(bytes)};
+    BIP39_PROBE2(entropy__refill__return, size, read_bytes);
 #endif
+    std::string bin_rand{reinterpret_cast<char*>(bytes), size};
+    memzero(bytes, size);
+    free(bytes);
     auto hex_rand = BIP39_Utils::base16Encode(bin_rand);
+    memzero(&bin_rand[0], bin_rand.size());
     useEntropy(hex_rand);
+    memzero(&hex_rand[0], hex_rand.size());
     return *this;
 }
 
@@ -27,6 +27,12 @@ public:
     static Mnemonic Entropy(const std::string& entropy);
     static Mnemonic Generate(int wordCount);
     static bool validateEntropy(const std::string& entropy) noexcept;
+    // Loads the wordlists and resolves the SHA-512 kernel and batch configuration now, so the
+    // first mnemonic or seed does not pay for them. Throws if a wordlist cannot be loaded.
+    static void preload(const std::vector<std::string>& languages = {"english"});
+    // preload() plus one throwaway entropy read and lane group of seeds, which open the
+    // entropy source and fault in the code of the configured kernel.
+    static void warmup(const std::vector<std::string>& languages = {"english"});
     static Mnemonic Words(
         const std::string& words, Wordlist* wordlist = Wordlist::english(), bool verifyChecksum = true);
     Mnemonic reverse(const std::vector<std::string>& words, bool verifyChecksum = true);
@@ -0,0 +1,253 @@
+#include "bip39_c.h"
+#include "batch.h"
+#include "bip39.h"
+#include "pbkdf2_sha512/memzero.h"
+#include "utils.h"
+#include "validator.h"
+#include "wordlist.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr uint16_t WORDLIST_SIZE = 2048;
+
+bool validWordCount(size_t wordCount)
+{
+    return wordCount >= 12 && wordCount <= 24 && wordCount % 3 == 0;
+}
+
+// Only the built-in languages: any other name would be opened as a file and kept loaded.
+Wordlist* wordlistFor(const char* language)
+{
+    if (language == nullptr || strcmp(language, "english") == 0)
+        return Wordlist::english();
+    if (strcmp(language, "french") == 0)
+        return Wordlist::french();
+    if (strcmp(language, "italian") == 0)
+        return Wordlist::italian();
+    if (strcmp(language, "spanish") == 0)
+        return Wordlist::spanish();
+    return nullptr;
+}
+
+bool validIndices(const uint16_t* indices, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (indices[i] >= WORDLIST_SIZE)
+            return false;
+    }
+    return true;
+}
+
+int statusCode(PhraseStatus status)
+{
+    switch (status) {
+    case PhraseStatus::Complete:
+        return BIP39_OK;
+    case PhraseStatus::UnknownWord:
+        return BIP39_ERR_WORD;
+    case PhraseStatus::BadChecksum:
+        return BIP39_ERR_CHECKSUM;
+    case PhraseStatus::Screened:
+        return BIP39_ERR_SCREENED;
+    default:
+        return BIP39_ERR_LENGTH;
+    }
+}
+}    // namespace
+
+int bip39_abi_version(void)
+{
+    return BIP39_ABI_VERSION;
+}
+
+const char* bip39_strerror(int code)
+{
+    switch (code) {
+    case BIP39_OK:
+        return "ok";
+    case BIP39_ERR_ARGUMENT:
+        return "invalid argument";
+    case BIP39_ERR_WORDLIST:
+        return "wordlist not available";
+    case BIP39_ERR_WORD:
+        return "word not in wordlist";
+    case BIP39_ERR_LENGTH:
+        return "wrong number of words";
+    case BIP39_ERR_CHECKSUM:
+        return "checksum mismatch";
+    case BIP39_ERR_SCREENED:
+        return "mnemonic is on a screening list";
+    case BIP39_ERR_INTERNAL:
+        return "internal error";
+    default:
+        return "unknown error";
+    }
+}
+
+int bip39_generate(size_t n, size_t word_count, uint16_t* indices)
+{
+    if (!validWordCount(word_count) || (n > 0 && indices == nullptr))
+        return BIP39_ERR_ARGUMENT;
+    try {
+        for (size_t i = 0; i < n; i++) {
+            const Mnemonic mnemonic = BIP39::Generate((int)word_count);
+            for (size_t p = 0; p < word_count; p++) {
+                indices[i * word_count + p] = (uint16_t)mnemonic.wordsIndex[p];
+            }
+        }
+    } catch (...) {
+        return BIP39_ERR_INTERNAL;
+    }
+    return BIP39_OK;
+}
+
+int bip39_entropy_to_indices(
+    const uint8_t* entropy, size_t n, size_t word_count, uint16_t* indices)
+{
+    if (!validWordCount(word_count) || (n > 0 && (entropy == nullptr || indices == nullptr)))
+        return BIP39_ERR_ARGUMENT;
+    const size_t length = word_count * 4 / 3;
+    for (size_t i = 0; i < n; i++) {
+        BIP39_Utils::entropyToWordIndices(
+            entropy + i * length, length, indices + i * word_count);
+    }
+    return BIP39_OK;
+}
+
+int bip39_indices_to_entropy(
+    const uint16_t* indices, size_t n, size_t word_count, uint8_t* entropy, int32_t* status)
+{
+    if (!validWordCount(word_count) ||
+        (n > 0 && (indices == nullptr || entropy == nullptr || status == nullptr)) ||
+        !validIndices(indices, n * word_count))
+        return BIP39_ERR_ARGUMENT;
+    const size_t length = word_count * 4 / 3;
+    for (size_t i = 0; i < n; i++) {
+        const bool valid = BIP39_Utils::wordIndicesToEntropy(
+            indices + i * word_count, word_count, entropy + i * length);
+        status[i] = valid ? BIP39_OK : BIP39_ERR_CHECKSUM;
+    }
+    return BIP39_OK;
+}
+
+int bip39_phrases_to_indices(
+    const char* const* phrases,
+    size_t n,
+    size_t word_count,
+    const char* language,
+    uint16_t* indices,
+    int32_t* status)
+{
+    if (!validWordCount(word_count) ||
+        (n > 0 && (phrases == nullptr || indices == nullptr || status == nullptr)))
+        return BIP39_ERR_ARGUMENT;
+    Wordlist* wordlist = wordlistFor(language);
+    if (wordlist == nullptr)
+        return BIP39_ERR_WORDLIST;
+    try {
+        PhraseValidator validator((int)word_count, wordlist);
+        for (size_t i = 0; i < n; i++) {
+            validator.reset();
+            PhraseStatus result = PhraseStatus::Incomplete;
+            const char* word = phrases[i];
+            if (word == nullptr)
+                return BIP39_ERR_ARGUMENT;
+            // single spaces between words, as BIP39::Words expects
+            for (const char* end = word;; end++) {
+                if (*end != ' ' && *end != '\0')
+                    continue;
+                result = validator.push(word, (size_t)(end - word));
+                if (*end == '\0' || result == PhraseStatus::UnknownWord ||
+                    result == PhraseStatus::TooManyWords)
+                    break;
+                word = end + 1;
+            }
+            status[i] = statusCode(result);
+            uint16_t* out = indices + i * word_count;
+            for (size_t p = 0; p < word_count; p++) {
+                out[p] = status[i] == BIP39_OK ? validator.word(p) : 0;
+            }
+        }
+    } catch (...) {
+        return BIP39_ERR_INTERNAL;
+    }
+    return BIP39_OK;
+}
+
+int bip39_batch_seed(
+    const uint16_t* indices,
+    size_t n,
+    size_t word_count,
+    const char* language,
+    const char* passphrase,
+    size_t passphrase_len,
+    unsigned threads,
+    uint8_t* out)
+{
+    if (!validWordCount(word_count) || (n > 0 && (indices == nullptr || out == nullptr)) ||
+        (passphrase == nullptr && passphrase_len > 0) || !validIndices(indices, n * word_count))
+        return BIP39_ERR_ARGUMENT;
+    Wordlist* wordlist = wordlistFor(language);
+    if (wordlist == nullptr)
+        return BIP39_ERR_WORDLIST;
+    std::vector<std::string> phrases;
+    std::string salt;
+    int result = BIP39_OK;
+    try {
+        phrases.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            std::string& phrase = phrases[i];
+            for (size_t p = 0; p < word_count; p++) {
+                if (p > 0)
+                    phrase += ' ';
+                phrase += wordlist->getWord(indices[i * word_count + p]);
+            }
+        }
+        if (passphrase_len > 0)
+            salt.assign(passphrase, passphrase_len);
+        BatchConfig config = SeedBatch::config();
+        if (threads > 0)
+            config.threads = threads;
+        SeedBatch::generateSeeds(phrases, salt, out, config);
+    } catch (...) {
+        result = BIP39_ERR_INTERNAL;
+    }
+    for (auto& phrase : phrases) {
+        memzero(&phrase[0], phrase.size());
+    }
+    memzero(&salt[0], salt.size());
+    return result;
+}
+
+int bip39_word_index(const char* language, const char* word, size_t len)
+{
+    if (word == nullptr && len > 0)
+        return BIP39_ERR_ARGUMENT;
+    Wordlist* wordlist = wordlistFor(language);
+    if (wordlist == nullptr)
+        return BIP39_ERR_WORDLIST;
+    const int index = wordlist->findIndexCT(word, len);
+    return index < 0 ? BIP39_ERR_WORD : index;
+}
+
+int bip39_word(const char* language, uint16_t index, char* out, size_t out_len)
+{
+    if (index >= WORDLIST_SIZE || out == nullptr)
+        return BIP39_ERR_ARGUMENT;
+    Wordlist* wordlist = wordlistFor(language);
+    if (wordlist == nullptr)
+        return BIP39_ERR_WORDLIST;
+    try {
+        const std::string word = wordlist->getWord(index);
+        if (word.size() + 1 > out_len)
+            return BIP39_ERR_ARGUMENT;
+        memcpy(out, word.c_str(), word.size() + 1);
+        return (int)word.size();
+    } catch (...) {
+        return BIP39_ERR_INTERNAL;
+    }
+}
@@ -0,0 +1,112 @@
+#ifndef BIP39_C_H
+#define BIP39_C_H
+
+/*
+ * C interface for FFI callers (Python ctypes/cffi, Go cgo, Rust).
+ *
+ * Every batch call works on flat, caller-owned buffers of `n` fixed-size records, so one
+ * call can convert or derive thousands of mnemonics without marshalling strings. Mnemonics
+ * are passed as wordlist indices, `word_count` uint16_t per record. No call keeps a pointer
+ * it was given or hands out memory the caller must free, and no C++ exception crosses the
+ * interface: each call returns BIP39_OK or a negative BIP39_ERR_* code.
+ *
+ * Thread safety: all functions may be called from any number of threads at once. They share
+ * only the wordlists, which are loaded once and read-only after, and the process-wide batch
+ * configuration, which is read at the start of each call. Buffers passed to concurrent calls
+ * must not overlap.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Exported from the bip39c shared library, whose other symbols are hidden. */
+#if defined(_WIN32) && defined(BIP39_C_EXPORTS)
+#    define BIP39_C_API __declspec(dllexport)
+#elif defined(__GNUC__) || defined(__clang__)
+#    define BIP39_C_API __attribute__((visibility("default")))
+#else
+#    define BIP39_C_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BIP39_ABI_VERSION 1
+#define BIP39_SEED_LENGTH 64
+
+#define BIP39_OK 0
+#define BIP39_ERR_ARGUMENT -1     /* null buffer, bad word count or index */
+#define BIP39_ERR_WORDLIST -2     /* unknown language or wordlist file not found */
+#define BIP39_ERR_WORD -3         /* a word is not in the wordlist */
+#define BIP39_ERR_LENGTH -4       /* a phrase does not have word_count words */
+#define BIP39_ERR_CHECKSUM -5     /* the checksum word does not match */
+#define BIP39_ERR_SCREENED -6     /* the entropy is on the installed screening list */
+#define BIP39_ERR_INTERNAL -7     /* entropy source or allocation failure */
+
+/* BIP39_ABI_VERSION of the library, to check against the header the caller was built with. */
+BIP39_C_API int bip39_abi_version(void);
+
+/* Static description of a BIP39_OK or BIP39_ERR_* code. */
+BIP39_C_API const char* bip39_strerror(int code);
+
+/*
+ * `language` is "english", "french", "italian" or "spanish"; NULL means english.
+ * `word_count` is 12, 15, 18, 21 or 24 and entropy records are word_count * 4 / 3 bytes.
+ */
+
+/* n new random mnemonics from the system entropy source, as indices. */
+BIP39_C_API int bip39_generate(size_t n, size_t word_count, uint16_t* indices);
+
+/* Indices of the mnemonics of n entropies. */
+BIP39_C_API int bip39_entropy_to_indices(
+    const uint8_t* entropy, size_t n, size_t word_count, uint16_t* indices);
+
+/*
+ * Entropies of n mnemonics. status[i] receives BIP39_OK or BIP39_ERR_CHECKSUM for each
+ * record; the call itself fails only on bad arguments.
+ */
+BIP39_C_API int bip39_indices_to_entropy(
+    const uint16_t* indices, size_t n, size_t word_count, uint8_t* entropy, int32_t* status);
+
+/*
+ * Parses n NUL-terminated, space-separated phrases into indices. status[i] receives
+ * BIP39_OK, BIP39_ERR_WORD, BIP39_ERR_LENGTH, BIP39_ERR_CHECKSUM or BIP39_ERR_SCREENED.
+ */
+BIP39_C_API int bip39_phrases_to_indices(
+    const char* const* phrases,
+    size_t n,
+    size_t word_count,
+    const char* language,
+    uint16_t* indices,
+    int32_t* status);
+
+/*
+ * BIP39_SEED_LENGTH-byte seeds of n mnemonics with one passphrase, on the lane-parallel
+ * PBKDF2 kernels. `threads` 0 uses the batch configuration's threads. Checksums are not
+ * verified, as in Mnemonic::generateSeed.
+ */
+BIP39_C_API int bip39_batch_seed(
+    const uint16_t* indices,
+    size_t n,
+    size_t word_count,
+    const char* language,
+    const char* passphrase,
+    size_t passphrase_len,
+    unsigned threads,
+    uint8_t* out);
+
+/* Index of a word of `len` bytes, or BIP39_ERR_WORD / BIP39_ERR_WORDLIST. */
+BIP39_C_API int bip39_word_index(const char* language, const char* word, size_t len);
+
+/*
+ * Copies word `index` and a terminating NUL into out[0..out_len). Returns the word's length
+ * or BIP39_ERR_ARGUMENT if it does not fit.
+ */
+BIP39_C_API int bip39_word(const char* language, uint16_t index, char* out, size_t out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BIP39_C_H */
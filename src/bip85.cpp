@@ -0,0 +1,157 @@
+#include "bip85.h"
+#include "address.h"
+#include "bip39.h"
+#include "mnemonic.h"
+#include "pbkdf2_sha512/hmac.h"
+#include "pbkdf2_sha512/memzero.h"
+#include "pbkdf2_sha512/sha2.hpp"
+#include "secp256k1.h"
+#include "trace.h"
+#include "utils.h"
+#include "wordlist.h"
+
+#include <cstring>
+
+namespace
+{
+constexpr uint32_t BIP85_PURPOSE = 83696968;
+constexpr uint32_t BIP39_APPLICATION = 39;
+
+struct Language
+{
+    const char* name;
+    uint32_t code;
+};
+
+// BIP85 language codes of the wordlists the library ships.
+const Language languages[] = {{"english", 0}, {"spanish", 3}, {"french", 6}, {"italian", 7}};
+}    // namespace
+
+Mnemonic Bip85Mnemonic::toMnemonic() const
+{
+    Mnemonic mnemonic;
+    mnemonic.entropy = BIP39_Utils::base16Encode(
+        std::string(reinterpret_cast<const char*>(entropy), length));
+    for (size_t w = 0; w < wordCount; w++) {
+        mnemonic.wordsIndex.emplace_back(words[w]);
+        mnemonic.words.emplace_back(wordlist->getWord(words[w]));
+        mnemonic.rawBinaryChunks.emplace_back(words[w]);
+        ++mnemonic.m_wordsCount;
+    }
+    return mnemonic;
+}
+
+Bip85::Bip85(const uint8_t* seed, size_t length)
+{
+    auto masters = HDBatch::masters(HDBatch::config(), seed, 1, length);
+    m_root = masters[0];
+    HDBatch::wipe(masters);
+}
+
+Bip85::Bip85(const std::string& xprv)
+{
+    std::vector<uint8_t> payload;
+    const bool ok = AddressCodec::base58CheckDecode(xprv, payload) && payload.size() == 78 &&
+                    (memcmp(payload.data(), "\x04\x88\xad\xe4", 4) == 0 ||
+                     memcmp(payload.data(), "\x04\x35\x83\x94", 4) == 0) &&
+                    payload[45] == 0 && Secp256k1::isValidPrivateKey(&payload[46]);
+    if (ok) {
+        memcpy(m_root.chain, &payload[13], 32);
+        memcpy(m_root.key, &payload[46], 32);
+    }
+    memzero(payload.data(), payload.size());
+    if (!ok)
+        throw MnemonicException("Invalid extended private key");
+}
+
+Bip85::~Bip85()
+{
+    memzero(&m_root, sizeof(m_root));
+    for (auto& p : m_parents) {
+        memzero(&p.second, sizeof(p.second));
+    }
+}
+
+HDNode Bip85::parent(uint32_t languageCode, uint32_t wordCount)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint64_t key = (uint64_t)languageCode << 32 | wordCount;
+    auto cached = m_parents.find(key);
+    if (cached != m_parents.end())
+        return cached->second;
+
+    const BatchConfig config = HDBatch::config();
+    std::vector<HDNode> node{m_root};
+    for (uint32_t index : {BIP85_PURPOSE, BIP39_APPLICATION, languageCode, wordCount}) {
+        auto child = HDBatch::children(config, node, {index | HDBatch::HARDENED});
+        HDBatch::wipe(node);
+        node.swap(child);
+    }
+    m_parents[key] = node[0];
+    HDBatch::wipe(node);
+    return m_parents[key];
+}
+
+std::vector<Bip85Mnemonic> Bip85::mnemonics(
+    uint32_t first, uint32_t last, int wordCount, const std::string& language)
+{
+    if (wordCount != 12 && wordCount != 18 && wordCount != 24)
+        throw MnemonicException("Invalid word count");
+    if (first > last || last > HDBatch::HARDENED)
+        throw MnemonicException("Invalid index range");
+    const Language* lang = nullptr;
+    for (const auto& l : languages) {
+        if (language == l.name)
+            lang = &l;
+    }
+    Wordlist* wordlist = lang ? Wordlist::getLanguage(lang->name) : nullptr;
+    if (wordlist == nullptr || wordlist->empty())
+        throw MnemonicException("Unsupported language: " + language);
+    BIP39_TRACE_SCOPE("bip85 mnemonics");
+
+    const BatchConfig config = HDBatch::config();
+    std::vector<HDNode> parents{parent(lang->code, (uint32_t)wordCount)};
+    std::vector<uint32_t> indices;
+    indices.reserve(last - first);
+    for (uint32_t i = first; i < last; i++) {
+        indices.push_back(i | HDBatch::HARDENED);
+    }
+    std::vector<HDNode> children = HDBatch::children(config, parents, indices);
+    HDBatch::wipe(parents);
+
+    // entropy = HMAC-SHA512(key "bip-entropy-from-k", child key), truncated
+    static const char hmacKey[] = "bip-entropy-from-k";
+    uint64_t inner[8], outer[8];
+    hmac_sha512_prepare(
+        reinterpret_cast<const uint8_t*>(hmacKey), sizeof(hmacKey) - 1, outer, inner);
+    const size_t count = children.size();
+    std::vector<uint8_t> keys(count * Secp256k1::PRIVATE_KEY_LENGTH);
+    for (size_t i = 0; i < count; i++) {
+        memcpy(&keys[i * Secp256k1::PRIVATE_KEY_LENGTH], children[i].key, 32);
+    }
+    HDBatch::wipe(children);
+    std::vector<const uint64_t*> innerStates(count, inner), outerStates(count, outer);
+    std::vector<uint8_t> digests(count * SHA512_DIGEST_LENGTH);
+    HDBatch::hmac(
+        config,
+        count,
+        innerStates.data(),
+        outerStates.data(),
+        keys.data(),
+        Secp256k1::PRIVATE_KEY_LENGTH,
+        digests.data());
+    memzero(keys.data(), keys.size());
+
+    std::vector<Bip85Mnemonic> result(count);
+    for (size_t i = 0; i < count; i++) {
+        Bip85Mnemonic& child = result[i];
+        child.index = first + (uint32_t)i;
+        child.length = (size_t)wordCount * 4 / 3;
+        child.wordCount = (size_t)wordCount;
+        child.wordlist = wordlist;
+        memcpy(child.entropy, &digests[i * SHA512_DIGEST_LENGTH], child.length);
+        BIP39_Utils::entropyToWordIndices(child.entropy, child.length, child.words);
+    }
+    memzero(digests.data(), digests.size());
+    return result;
+}
@@ -0,0 +1,59 @@
+#ifndef BIP85_H
+#define BIP85_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "hdnode.h"
+
+class Mnemonic;
+class Wordlist;
+
+// A BIP85 child mnemonic, packed: its entropy and 11-bit word indices.
+struct Bip85Mnemonic
+{
+    uint32_t index;
+    uint8_t entropy[32];
+    size_t length;    // entropy bytes: 16, 24 or 32
+    uint16_t words[24];
+    size_t wordCount;
+    Wordlist* wordlist;
+
+    Mnemonic toMnemonic() const;
+};
+
+/*
+ * BIP85 child mnemonics (application 39) of one root key. The parent node of each language
+ * and word count is derived once and kept; a range of indices is derived as one batch, its
+ * HMAC-SHA512s on the SHA-512 lane kernels, and the words come straight from the entropy
+ * bytes. The root and cached nodes are wiped on destruction.
+ */
+class Bip85
+{
+public:
+    // Root key from a BIP32 seed (16 to 64 bytes), or a BIP32 extended private key
+    // (xprv, tprv). Throws MnemonicException on a bad seed or key.
+    Bip85(const uint8_t* seed, size_t length);
+    explicit Bip85(const std::string& xprv);
+    Bip85(const Bip85&) = delete;
+    Bip85& operator=(const Bip85&) = delete;
+    ~Bip85();
+
+    // Children first..last-1 at m/83696968'/39'/language'/words'/index'. wordCount is 12,
+    // 18 or 24, language a BIP39 wordlist the library ships (english, french, italian,
+    // spanish).
+    std::vector<Bip85Mnemonic> mnemonics(
+        uint32_t first, uint32_t last, int wordCount, const std::string& language = "english");
+
+private:
+    HDNode parent(uint32_t languageCode, uint32_t wordCount);
+
+    HDNode m_root;
+    std::map<uint64_t, HDNode> m_parents;
+    std::mutex m_mutex;
+};
+
+#endif // BIP85_H
@@ -0,0 +1,507 @@
+#include "dedup.h"
+#include "bip39.h"
+#include "electrum.h"
+#include "fingerprint.h"
+#include "pbkdf2_sha512/memzero.h"
+#include "utils.h"
+#include "wordlist.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <random>
+#include <thread>
+
+namespace
+{
+// Bytes of memory an input line costs while its chunk is parsed and sorted: the line itself,
+// the key and the radix sort's second buffer.
+constexpr size_t BYTES_PER_LINE = 192;
+constexpr size_t SMALL_BUCKET = 64;
+constexpr size_t RUN_RECORD = PackedEntropy::SIZE + sizeof(uint64_t);
+// Bytes per unique key in first-seen mode: the key, its count and two map slots.
+constexpr size_t BYTES_PER_UNIQUE = PackedEntropy::SIZE + sizeof(uint64_t) + 2 * 12;
+
+unsigned threadCount(unsigned threads)
+{
+    return threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Runs body(t) for t in [0, threads), the last one on the calling thread.
+template <typename Body>
+void parallel(unsigned threads, Body body)
+{
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t + 1 < threads; t++) {
+        pool.emplace_back(body, t);
+    }
+    body(threads - 1);
+    for (auto& th : pool) {
+        th.join();
+    }
+}
+
+// Sorts a[0, n) by the bytes from `byte` on; all keys agree on the bytes before it.
+void radixSort(PackedEntropy* a, PackedEntropy* tmp, size_t n, size_t byte)
+{
+    if (n < SMALL_BUCKET || byte == PackedEntropy::SIZE) {
+        std::sort(a, a + n);
+        return;
+    }
+    size_t offsets[257] = {};
+    for (size_t i = 0; i < n; i++) {
+        ++offsets[a[i].key[byte] + 1];
+    }
+    for (int b = 0; b < 256; b++) {
+        offsets[b + 1] += offsets[b];
+    }
+    size_t next[256];
+    std::copy(offsets, offsets + 256, next);
+    for (size_t i = 0; i < n; i++) {
+        tmp[next[a[i].key[byte]]++] = a[i];
+    }
+    std::copy(tmp, tmp + n, a);
+    for (int b = 0; b < 256; b++) {
+        const size_t size = offsets[b + 1] - offsets[b];
+        if (size > 1)
+            radixSort(a + offsets[b], tmp + offsets[b], size, byte + 1);
+    }
+}
+
+const std::vector<Wordlist*>& languages()
+{
+    static const std::vector<Wordlist*> lists = [] {
+        std::vector<Wordlist*> out;
+        for (Wordlist* w : {Wordlist::english(), Wordlist::french(), Wordlist::italian(),
+                            Wordlist::spanish()}) {
+            if (w)
+                out.push_back(w);
+        }
+        return out;
+    }();
+    return lists;
+}
+
+// Looks up `words` in `list` and checks the checksum, as SeedClassifier::isBip39.
+bool packPhrase(Wordlist* list, const std::vector<std::string>& words, PackedEntropy& out)
+{
+    uint16_t indices[24];
+    for (size_t p = 0; p < words.size(); p++) {
+        // exact lookup: the French and Spanish lists are not in byte order
+        const int index = list->findIndexCT(words[p]);
+        if (index < 0) {
+            memzero(indices, sizeof(indices));
+            return false;
+        }
+        indices[p] = (uint16_t)index;
+    }
+    uint8_t entropy[32];
+    const bool valid = BIP39_Utils::wordIndicesToEntropy(indices, words.size(), entropy);
+    if (valid) {
+        const size_t length = words.size() * 4 / 3;
+        memset(out.key, 0, sizeof(out.key));
+        out.key[0] = (uint8_t)length;
+        memcpy(out.key + 1, entropy, length);
+    }
+    memzero(indices, sizeof(indices));
+    memzero(entropy, sizeof(entropy));
+    return valid;
+}
+
+// Removes the spilled runs however run() exits.
+struct TempFiles
+{
+    std::vector<std::string> paths;
+
+    ~TempFiles()
+    {
+        for (const auto& p : paths) {
+            std::remove(p.c_str());
+        }
+    }
+};
+
+struct RunReader
+{
+    std::ifstream file;
+    PackedEntropy key;
+    uint64_t count;
+
+    explicit RunReader(const std::string& path) : file(path, std::ios::binary) {}
+
+    bool next()
+    {
+        char record[RUN_RECORD];
+        if (!file.read(record, sizeof(record)))
+            return false;
+        memcpy(key.key, record, PackedEntropy::SIZE);
+        memcpy(&count, record + PackedEntropy::SIZE, sizeof(count));
+        return true;
+    }
+};
+
+class Writer
+{
+public:
+    Writer(const std::string& output, const DedupOptions& options, DedupStats& stats)
+        : m_out(output, std::ios::binary), m_format{options.format}, m_stats(stats)
+    {
+        if (!m_out)
+            throw MnemonicException("Failed to write dedup output: " + output);
+        if (!options.duplicatesPath.empty()) {
+            m_duplicates.open(options.duplicatesPath);
+            if (!m_duplicates)
+                throw MnemonicException(
+                    "Failed to write duplicate list: " + options.duplicatesPath);
+        }
+    }
+
+    void write(const PackedEntropy& key, uint64_t copies)
+    {
+        ++m_stats.unique;
+        if (copies > 1) {
+            ++m_stats.duplicatedKeys;
+            ++m_stats.copies[copies];
+            m_stats.maxCopies = std::max(m_stats.maxCopies, copies);
+            if (m_duplicates.is_open())
+                m_duplicates << MnemonicDedup::toHex(key) << ' ' << copies << '\n';
+        }
+        switch (m_format) {
+        case DedupFormat::Hex:
+            m_out << MnemonicDedup::toHex(key) << '\n';
+            break;
+        case DedupFormat::Phrase:
+            m_out << MnemonicDedup::toPhrase(key) << '\n';
+            break;
+        case DedupFormat::Binary:
+            m_out.write(reinterpret_cast<const char*>(key.key), sizeof(key.key));
+            break;
+        }
+    }
+
+    void close()
+    {
+        m_out.flush();
+        m_duplicates.flush();
+        if (!m_out || (m_duplicates.is_open() && !m_duplicates))
+            throw MnemonicException("Failed to write dedup output");
+    }
+
+private:
+    std::ofstream m_out;
+    std::ofstream m_duplicates;
+    DedupFormat m_format;
+    DedupStats& m_stats;
+};
+
+// Calls emit(key, copies) for each distinct key of the sorted `keys`.
+template <typename Emit>
+void collapse(const std::vector<PackedEntropy>& keys, Emit emit)
+{
+    for (size_t i = 0; i < keys.size();) {
+        size_t j = i + 1;
+        while (j < keys.size() && keys[j] == keys[i]) {
+            ++j;
+        }
+        emit(keys[i], j - i);
+        i = j;
+    }
+}
+}    // namespace
+
+bool PackedEntropy::operator<(const PackedEntropy& other) const noexcept
+{
+    return memcmp(key, other.key, SIZE) < 0;
+}
+
+bool PackedEntropy::operator==(const PackedEntropy& other) const noexcept
+{
+    return memcmp(key, other.key, SIZE) == 0;
+}
+
+bool MnemonicDedup::parse(const std::string& line, PackedEntropy& out, std::string* format)
+{
+    const std::string normalized = SeedClassifier::normalize(line);
+    if (normalized.empty())
+        return false;
+    if (normalized.find(' ') == std::string::npos) {
+        if (!BIP39::validateEntropy(normalized))
+            return false;
+        const std::string entropy = BIP39_Utils::base16Decode(normalized);
+        memset(out.key, 0, sizeof(out.key));
+        out.key[0] = (uint8_t)entropy.size();
+        memcpy(out.key + 1, entropy.data(), entropy.size());
+        if (format)
+            *format = "hex";
+        return true;
+    }
+
+    std::vector<std::string> words;
+    for (size_t start = 0; start <= normalized.size();) {
+        size_t end = normalized.find(' ', start);
+        if (end == std::string::npos)
+            end = normalized.size();
+        words.push_back(normalized.substr(start, end - start));
+        start = end + 1;
+    }
+    if (words.size() < 12 || words.size() > 24 || words.size() % 3 != 0)
+        return false;
+    for (Wordlist* list : languages()) {
+        if (packPhrase(list, words, out)) {
+            if (format)
+                *format = list->language();
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string MnemonicDedup::toHex(const PackedEntropy& key)
+{
+    return BIP39_Utils::base16Encode(
+        std::string(reinterpret_cast<const char*>(key.entropy()), key.length()));
+}
+
+std::string MnemonicDedup::toPhrase(const PackedEntropy& key)
+{
+    // built here rather than with BIP39::Entropy, which an installed screen may refuse
+    Wordlist* english = Wordlist::english();
+    if (english == nullptr)
+        throw MnemonicException("Invalid wordlist");
+    const size_t length = key.length();
+    uint16_t indices[24];
+    BIP39_Utils::entropyToWordIndices(key.entropy(), length, indices);
+    std::string phrase;
+    for (size_t w = 0; w < length * 3 / 4; w++) {
+        if (w)
+            phrase += ' ';
+        phrase += english->getWord(indices[w]);
+    }
+    memzero(indices, sizeof(indices));
+    return phrase;
+}
+
+void MnemonicDedup::sort(std::vector<PackedEntropy>& keys, unsigned threads)
+{
+    threads = threadCount(threads);
+    const size_t n = keys.size();
+    if (n < SMALL_BUCKET * 4 || threads == 1) {
+        std::vector<PackedEntropy> tmp(n);
+        radixSort(keys.data(), tmp.data(), n, 0);
+        return;
+    }
+
+    // first pass on the length and first entropy byte, histogrammed and scattered per thread
+    constexpr size_t BUCKETS = 1 << 16;
+    auto bucketOf = [](const PackedEntropy& k) { return ((size_t)k.key[0] << 8) | k.key[1]; };
+    std::vector<std::vector<size_t>> counts(threads, std::vector<size_t>(BUCKETS, 0));
+    auto chunk = [&](unsigned t) {
+        return std::make_pair(n * t / threads, n * (t + 1) / threads);
+    };
+    parallel(threads, [&](unsigned t) {
+        const auto range = chunk(t);
+        for (size_t i = range.first; i < range.second; i++) {
+            ++counts[t][bucketOf(keys[i])];
+        }
+    });
+    std::vector<size_t> starts(BUCKETS + 1, 0);
+    size_t offset = 0;
+    for (size_t b = 0; b < BUCKETS; b++) {
+        starts[b] = offset;
+        for (unsigned t = 0; t < threads; t++) {
+            const size_t c = counts[t][b];
+            counts[t][b] = offset;
+            offset += c;
+        }
+    }
+    starts[BUCKETS] = n;
+    std::vector<PackedEntropy> tmp(n);
+    parallel(threads, [&](unsigned t) {
+        const auto range = chunk(t);
+        for (size_t i = range.first; i < range.second; i++) {
+            tmp[counts[t][bucketOf(keys[i])]++] = keys[i];
+        }
+    });
+    counts.clear();
+
+    // then the buckets, handed out largest first
+    std::vector<size_t> order;
+    for (size_t b = 0; b < BUCKETS; b++) {
+        if (starts[b + 1] - starts[b] > 1)
+            order.push_back(b);
+    }
+    std::sort(order.begin(), order.end(), [&](size_t x, size_t y) {
+        return starts[x + 1] - starts[x] > starts[y + 1] - starts[y];
+    });
+    std::atomic<size_t> next{0};
+    parallel(threads, [&](unsigned) {
+        for (size_t i = next++; i < order.size(); i = next++) {
+            const size_t b = order[i];
+            radixSort(&tmp[starts[b]], &keys[starts[b]], starts[b + 1] - starts[b], 2);
+        }
+    });
+    keys.swap(tmp);
+}
+
+DedupStats MnemonicDedup::run(
+    const std::vector<std::string>& inputs, const std::string& output, const DedupOptions& options)
+{
+    const unsigned threads = threadCount(options.threads);
+    const size_t chunkLines = std::max<size_t>(1, options.memoryLimit / BYTES_PER_LINE);
+    DedupStats stats;
+    TempFiles runs;
+    std::random_device random;
+    const std::string tag = std::to_string(random());
+    std::vector<PackedEntropy> keys;
+    bool spilled = false;
+
+    std::vector<std::string> lines;
+    lines.reserve(std::min<size_t>(chunkLines, 1 << 20));
+    // parses `lines` into `keys` and wipes them
+    auto parseLines = [&]() {
+        std::vector<PackedEntropy> parsed(lines.size());
+        std::vector<uint8_t> valid(lines.size(), 0);
+        std::vector<std::map<std::string, uint64_t>> formats(threads);
+        parallel(threads, [&](unsigned t) {
+            std::string format;
+            for (size_t i = lines.size() * t / threads; i < lines.size() * (t + 1) / threads;
+                 i++) {
+                if (parse(lines[i], parsed[i], &format)) {
+                    valid[i] = 1;
+                    ++formats[t][format];
+                }
+            }
+        });
+        for (const auto& f : formats) {
+            for (const auto& entry : f) {
+                stats.formats[entry.first] += entry.second;
+            }
+        }
+        keys.clear();
+        for (size_t i = 0; i < lines.size(); i++) {
+            if (valid[i])
+                keys.push_back(parsed[i]);
+            else
+                ++stats.invalid;
+        }
+        memzero(parsed.data(), parsed.size() * sizeof(PackedEntropy));
+        for (auto& l : lines) {
+            memzero(&l[0], l.size());
+        }
+        lines.clear();
+        stats.records += keys.size();
+    };
+
+    // first-seen mode: a fingerprint map points at the first record of each key; keys whose
+    // fingerprint another key already holds are rare enough for an ordered map
+    std::vector<PackedEntropy> firstKeys;
+    std::vector<uint64_t> firstCopies;
+    FingerprintMap<uint32_t> firstIndex;
+    std::map<PackedEntropy, size_t> collided;
+    const FingerprintKey fingerprintKey = FingerprintKey::random();
+    auto addFirstSeen = [&]() {
+        for (const auto& key : keys) {
+            const uint64_t fp =
+                MnemonicFingerprint::keyed64(fingerprintKey, key.entropy(), key.length());
+            const auto slot = firstIndex.insert(fp, (uint32_t)firstKeys.size());
+            size_t index = *slot.first;
+            if (!slot.second && !(firstKeys[index] == key)) {
+                auto it = collided.emplace(key, firstKeys.size()).first;
+                index = it->second;
+            }
+            if (index < firstKeys.size()) {
+                ++firstCopies[index];
+                continue;
+            }
+            if ((firstKeys.size() + 1) * BYTES_PER_UNIQUE > options.memoryLimit ||
+                firstKeys.size() >= UINT32_MAX)
+                throw MnemonicException("Too many unique keys for first-seen mode in memory");
+            firstKeys.push_back(key);
+            firstCopies.push_back(1);
+        }
+        memzero(keys.data(), keys.size() * sizeof(PackedEntropy));
+        keys.clear();
+    };
+
+    // parses and sorts `lines` into `keys`; spills them to a run when more input follows
+    auto flush = [&](bool last) {
+        parseLines();
+        if (options.firstSeen) {
+            addFirstSeen();
+            return;
+        }
+        sort(keys, threads);
+        if (last && !spilled)
+            return;
+
+        spilled = true;
+        const std::string path =
+            options.tempDir + "/bip39-dedup-" + tag + "-" + std::to_string(runs.paths.size());
+        runs.paths.push_back(path);
+        std::ofstream run(path, std::ios::binary);
+        collapse(keys, [&](const PackedEntropy& key, uint64_t copies) {
+            run.write(reinterpret_cast<const char*>(key.key), PackedEntropy::SIZE);
+            run.write(reinterpret_cast<const char*>(&copies), sizeof(copies));
+        });
+        if (!run.flush())
+            throw MnemonicException("Failed to write dedup run: " + path);
+        memzero(keys.data(), keys.size() * sizeof(PackedEntropy));
+        keys.clear();
+    };
+
+    for (const auto& input : inputs) {
+        std::ifstream in(input);
+        if (!in)
+            throw MnemonicException("Failed to read dedup input: " + input);
+        for (std::string line; std::getline(in, line);) {
+            ++stats.lines;
+            lines.push_back(std::move(line));
+            if (lines.size() == chunkLines)
+                flush(false);
+        }
+    }
+    flush(true);
+
+    Writer writer(output, options, stats);
+    if (options.firstSeen) {
+        for (size_t i = 0; i < firstKeys.size(); i++) {
+            writer.write(firstKeys[i], firstCopies[i]);
+        }
+        memzero(firstKeys.data(), firstKeys.size() * sizeof(PackedEntropy));
+    } else if (!spilled) {
+        collapse(keys, [&](const PackedEntropy& key, uint64_t copies) {
+            writer.write(key, copies);
+        });
+        memzero(keys.data(), keys.size() * sizeof(PackedEntropy));
+    } else {
+        // k-way merge of the runs, adding up the copies of keys found in several of them
+        std::vector<std::unique_ptr<RunReader>> readers;
+        auto later = [&](size_t x, size_t y) { return readers[y]->key < readers[x]->key; };
+        std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heap(later);
+        for (const auto& path : runs.paths) {
+            readers.emplace_back(new RunReader(path));
+            if (readers.back()->next())
+                heap.push(readers.size() - 1);
+        }
+        while (!heap.empty()) {
+            const PackedEntropy key = readers[heap.top()]->key;
+            uint64_t copies = 0;
+            while (!heap.empty() && readers[heap.top()]->key == key) {
+                const size_t r = heap.top();
+                heap.pop();
+                copies += readers[r]->count;
+                if (readers[r]->next())
+                    heap.push(r);
+            }
+            writer.write(key, copies);
+        }
+        stats.runs = runs.paths.size();
+    }
+    writer.close();
+    stats.duplicateRecords = stats.records - stats.unique;
+    return stats;
+}
@@ -0,0 +1,82 @@
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Canonical form of a mnemonic: entropy length in bytes, then the entropy zero padded.
+// Byte-wise order is (length, entropy), which is also the order of dedup output.
+struct PackedEntropy
+{
+    static constexpr size_t SIZE = 33;
+    uint8_t key[SIZE];
+
+    size_t length() const noexcept
+    {
+        return key[0];
+    }
+    const uint8_t* entropy() const noexcept
+    {
+        return key + 1;
+    }
+    bool operator<(const PackedEntropy& other) const noexcept;
+    bool operator==(const PackedEntropy& other) const noexcept;
+};
+
+enum class DedupFormat
+{
+    Hex,       // lowercase hex entropy per line
+    Phrase,    // English mnemonic per line
+    Binary,    // PackedEntropy::SIZE byte records
+};
+
+struct DedupOptions
+{
+    unsigned threads{0};                  // 0: all cores
+    size_t memoryLimit{size_t(1) << 30};  // beyond this, sorted runs are spilled to tempDir
+    std::string tempDir{"."};
+    DedupFormat format{DedupFormat::Hex};
+    std::string duplicatesPath;    // when set, "hex copies" lines for every repeated key
+    // Hash instead of sort: unique keys in first-seen order, held in memory. No runs are
+    // spilled; more unique keys than memoryLimit holds is an error.
+    bool firstSeen{false};
+};
+
+struct DedupStats
+{
+    uint64_t lines{0};
+    uint64_t invalid{0};    // lines that are neither hex entropy nor a valid mnemonic
+    uint64_t records{0};
+    uint64_t unique{0};
+    uint64_t duplicateRecords{0};    // records - unique
+    uint64_t duplicatedKeys{0};      // unique keys seen more than once
+    uint64_t maxCopies{0};
+    size_t runs{0};                          // spilled runs, 0 when sorted in memory
+    std::map<uint64_t, uint64_t> copies;     // copies per key -> number of keys, for copies > 1
+    std::map<std::string, uint64_t> formats;    // "hex" or the wordlist language -> records
+};
+
+class MnemonicDedup
+{
+public:
+    // Parses hex entropy or a phrase in any loaded wordlist (whitespace and ASCII case are
+    // normalized, the checksum must match). `format` receives "hex" or the language.
+    static bool parse(const std::string& line, PackedEntropy& out, std::string* format = nullptr);
+    static std::string toHex(const PackedEntropy& key);
+    static std::string toPhrase(const PackedEntropy& key);
+
+    // MSD radix sort; the top-level buckets are sorted on `threads` threads.
+    static void sort(std::vector<PackedEntropy>& keys, unsigned threads = 0);
+
+    // Reads every line of `inputs`, writes the unique keys in order (or first-seen order) to
+    // `output` and returns the statistics. Throws MnemonicException when a file cannot be read
+    // or written.
+    static DedupStats run(
+        const std::vector<std::string>& inputs,
+        const std::string& output,
+        const DedupOptions& options = DedupOptions());
+};
+
+#endif // DEDUP_H
@@ -0,0 +1,199 @@
+#include "electrum.h"
+#include "bip39.h"
+#include "pbkdf2_sha512/hmac.h"
+#include "pbkdf2_sha512/memzero.h"
+#include "pbkdf2_sha512/sha2.hpp"
+#include "trace.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <numeric>
+
+static const char SEED_VERSION_KEY[] = "Seed version";
+
+// Number of blocks hashed after the ipad midstate: message, 0x80 and the 128-bit length.
+static size_t inner_blocks(size_t len)
+{
+    return (len + 1 + 16 + SHA512_BLOCK_LENGTH - 1) / SHA512_BLOCK_LENGTH;
+}
+
+// Block `index` of the padded message, as host-order words ready for sha512_Transform.
+static void padded_block(const std::string& msg, size_t index, size_t blocks, uint64_t* words)
+{
+    uint8_t bytes[SHA512_BLOCK_LENGTH];
+    const size_t offset = index * SHA512_BLOCK_LENGTH;
+    for (size_t i = 0; i < SHA512_BLOCK_LENGTH; i++) {
+        const size_t pos = offset + i;
+        bytes[i] = pos < msg.size() ? (uint8_t)msg[pos] : pos == msg.size() ? 0x80 : 0;
+    }
+    for (int i = 0; i < 16; i++) {
+        uint64_t w = 0;
+        for (int k = 0; k < 8; k++) {
+            w = (w << 8) | bytes[i * 8 + k];
+        }
+        words[i] = w;
+    }
+    if (index + 1 == blocks) {
+        // the ipad block was already absorbed by the midstate
+        words[15] = (uint64_t)(SHA512_BLOCK_LENGTH + msg.size()) * 8;
+    }
+    memzero(bytes, sizeof(bytes));
+}
+
+static ElectrumSeedType seed_type(uint64_t digest_word0)
+{
+    const uint64_t prefix = digest_word0 >> 52;
+    if ((prefix >> 4) == 0x01) {
+        return ElectrumSeedType::Standard;
+    }
+    switch (prefix) {
+    case 0x100:
+        return ElectrumSeedType::Segwit;
+    case 0x101:
+        return ElectrumSeedType::TwoFactor;
+    case 0x102:
+        return ElectrumSeedType::TwoFactorSegwit;
+    }
+    return ElectrumSeedType::None;
+}
+
+SeedClassifier::SeedClassifier(Wordlist* wordlist, sha512_kernel kernel)
+{
+    if (wordlist == nullptr)
+        throw MnemonicException("Invalid wordlist");
+    m_wordList = wordlist;
+    m_kernel = sha512_kernel_supported(kernel) ? kernel : SHA512_KERNEL_SCALAR;
+    hmac_sha512_prepare(
+        reinterpret_cast<const uint8_t*>(SEED_VERSION_KEY),
+        sizeof(SEED_VERSION_KEY) - 1,
+        m_odig,
+        m_idig);
+}
+
+std::string SeedClassifier::normalize(const std::string& phrase)
+{
+    std::string out;
+    out.reserve(phrase.size());
+    bool space = false;
+    for (unsigned char c : phrase) {
+        if (std::isspace(c)) {
+            space = !out.empty();
+            continue;
+        }
+        if (space) {
+            out.push_back(' ');
+            space = false;
+        }
+        out.push_back((char)std::tolower(c));
+    }
+    return out;
+}
+
+bool SeedClassifier::isBip39(const std::string& normalized) const
+{
+    uint16_t indices[24];
+    size_t count = 0;
+    bool known = true;
+    for (size_t start = 0; known && start <= normalized.size();) {
+        size_t end = normalized.find(' ', start);
+        if (end == std::string::npos)
+            end = normalized.size();
+        // exact lookup: the French and Spanish lists are not in byte order
+        const int index = count < 24
+                              ? m_wordList->findIndexCT(normalized.data() + start, end - start)
+                              : -1;
+        known = index >= 0;
+        if (known)
+            indices[count++] = (uint16_t)index;
+        start = end + 1;
+    }
+
+    uint8_t entropy[32];
+    const bool valid = known && count >= 12 && count % 3 == 0 &&
+                       BIP39_Utils::wordIndicesToEntropy(indices, count, entropy);
+    memzero(indices, sizeof(indices));
+    memzero(entropy, sizeof(entropy));
+    return valid;
+}
+
+SeedClassification SeedClassifier::classify(const std::string& phrase) const
+{
+    return classify(std::vector<std::string>{phrase}).front();
+}
+
+std::vector<SeedClassification> SeedClassifier::classify(
+    const std::vector<std::string>& phrases) const
+{
+    BIP39_TRACE_SCOPE("classify");
+    const size_t count = phrases.size();
+    std::vector<SeedClassification> result(count);
+    std::vector<std::string> normalized(count);
+    for (size_t i = 0; i < count; i++) {
+        normalized[i] = normalize(phrases[i]);
+        result[i].bip39 = isBip39(normalized[i]);
+    }
+
+    // Group phrases with the same number of inner blocks so every lane stays in lockstep.
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t x, size_t y) {
+        return inner_blocks(normalized[x].size()) < inner_blocks(normalized[y].size());
+    });
+
+    const size_t lanes = sha512_kernel_width(m_kernel);
+    uint64_t state[8 * SHA512_MAX_LANES];
+    uint64_t block[16 * SHA512_MAX_LANES];
+    uint64_t words[16];
+    size_t first = 0;
+    while (first < count) {
+        const size_t blocks = inner_blocks(normalized[order[first]].size());
+        size_t used = 1;
+        while (used < lanes && first + used < count &&
+               inner_blocks(normalized[order[first + used]].size()) == blocks) {
+            ++used;
+        }
+        // idle lanes repeat the first phrase and their output is ignored
+        auto lane_phrase = [&](size_t l) -> const std::string& {
+            return normalized[order[first + (l < used ? l : 0)]];
+        };
+
+        for (size_t l = 0; l < lanes; l++) {
+            for (int i = 0; i < 8; i++) {
+                state[i * lanes + l] = m_idig[i];
+            }
+        }
+        for (size_t b = 0; b < blocks; b++) {
+            for (size_t l = 0; l < lanes; l++) {
+                padded_block(lane_phrase(l), b, blocks, words);
+                for (int i = 0; i < 16; i++) {
+                    block[i * lanes + l] = words[i];
+                }
+            }
+            sha512_Transform_lanes(m_kernel, lanes, state, block, state);
+        }
+
+        for (size_t l = 0; l < lanes; l++) {
+            for (int i = 0; i < 8; i++) {
+                block[i * lanes + l] = state[i * lanes + l];
+                state[i * lanes + l] = m_odig[i];
+            }
+            block[8 * lanes + l] = 0x8000000000000000;
+            for (int i = 9; i < 15; i++) {
+                block[i * lanes + l] = 0;
+            }
+            block[15 * lanes + l] = (SHA512_BLOCK_LENGTH + SHA512_DIGEST_LENGTH) * 8;
+        }
+        sha512_Transform_lanes(m_kernel, lanes, state, block, state);
+
+        for (size_t l = 0; l < used; l++) {
+            result[order[first + l]].electrum = seed_type(state[l]);
+        }
+        first += used;
+    }
+    memzero(words, sizeof(words));
+    memzero(block, sizeof(block));
+    memzero(state, sizeof(state));
+    return result;
+}
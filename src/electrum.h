@@ -0,0 +1,49 @@
+#ifndef ELECTRUM_H
+#define ELECTRUM_H
+
+#include <string>
+#include <vector>
+
+#include "pbkdf2_sha512/sha512_lanes.h"
+#include "wordlist.h"
+
+// Electrum v2 seed versions, encoded as the hex prefix of HMAC-SHA512("Seed version", phrase).
+enum class ElectrumSeedType
+{
+    None,
+    Standard,           // "01"
+    Segwit,             // "100"
+    TwoFactor,          // "101"
+    TwoFactorSegwit,    // "102"
+};
+
+struct SeedClassification
+{
+    bool bip39{};
+    ElectrumSeedType electrum{ElectrumSeedType::None};
+};
+
+class SeedClassifier
+{
+public:
+    SeedClassifier(
+        Wordlist* wordlist = Wordlist::english(), sha512_kernel kernel = sha512_kernel_default());
+
+    SeedClassification classify(const std::string& phrase) const;
+
+    // Classifies all phrases, running the Electrum HMACs for several phrases per SHA-512 pass.
+    std::vector<SeedClassification> classify(const std::vector<std::string>& phrases) const;
+
+    // Lowercases and collapses whitespace; phrases are otherwise expected to be NFKD already.
+    static std::string normalize(const std::string& phrase);
+
+private:
+    bool isBip39(const std::string& normalized) const;
+
+    Wordlist* m_wordList;
+    sha512_kernel m_kernel;
+    uint64_t m_odig[8];
+    uint64_t m_idig[8];
+};
+
+#endif // ELECTRUM_H
@@ -0,0 +1,111 @@
+#include "fingerprint.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace
+{
+inline uint64_t rotl(uint64_t x, unsigned n)
+{
+    return (x << n) | (x >> (64 - n));
+}
+
+inline uint64_t readLE64(const uint8_t* p, size_t n = 8)
+{
+    uint64_t w = 0;
+    for (size_t i = 0; i < n; i++) {
+        w |= (uint64_t)p[i] << (8 * i);
+    }
+    return w;
+}
+
+struct SipState
+{
+    uint64_t v0, v1, v2, v3;
+
+    void round()
+    {
+        v0 += v1;
+        v1 = rotl(v1, 13) ^ v0;
+        v0 = rotl(v0, 32);
+        v2 += v3;
+        v3 = rotl(v3, 16) ^ v2;
+        v0 += v3;
+        v3 = rotl(v3, 21) ^ v0;
+        v2 += v1;
+        v1 = rotl(v1, 17) ^ v2;
+        v2 = rotl(v2, 32);
+    }
+
+    void compress(uint64_t m)
+    {
+        v3 ^= m;
+        round();
+        round();
+        v0 ^= m;
+    }
+
+    uint64_t finish(uint64_t flag)
+    {
+        v2 ^= flag;
+        for (int i = 0; i < 4; i++) {
+            round();
+        }
+        return v0 ^ v1 ^ v2 ^ v3;
+    }
+};
+
+// SipHash-2-4 over the message, up to the finalization.
+SipState sipHash(const FingerprintKey& key, const uint8_t* data, size_t length, bool wide)
+{
+    SipState s{
+        key.k0 ^ 0x736f6d6570736575ULL,
+        key.k1 ^ 0x646f72616e646f6dULL ^ (wide ? 0xee : 0),
+        key.k0 ^ 0x6c7967656e657261ULL,
+        key.k1 ^ 0x7465646279746573ULL};
+    const size_t whole = length & ~size_t{7};
+    for (size_t i = 0; i < whole; i += 8) {
+        s.compress(readLE64(data + i));
+    }
+    s.compress((uint64_t)length << 56 | readLE64(data + whole, length - whole));
+    return s;
+}
+}    // namespace
+
+FingerprintKey FingerprintKey::random()
+{
+    std::random_device device;
+    FingerprintKey key;
+    key.k0 = (uint64_t)device() << 32 | device();
+    key.k1 = (uint64_t)device() << 32 | device();
+    return key;
+}
+
+uint64_t MnemonicFingerprint::hash64(const uint8_t* entropy, size_t length) noexcept
+{
+    uint64_t h = mix64(0x9e3779b97f4a7c15ULL ^ length);
+    for (size_t i = 0; i < length; i += 8) {
+        uint64_t w = 0;
+        memcpy(&w, entropy + i, std::min<size_t>(8, length - i));
+        h = mix64(h ^ w);
+    }
+    return h;
+}
+
+uint64_t MnemonicFingerprint::keyed64(
+    const FingerprintKey& key, const uint8_t* entropy, size_t length) noexcept
+{
+    return sipHash(key, entropy, length, false).finish(0xff);
+}
+
+Fingerprint128 MnemonicFingerprint::keyed128(
+    const FingerprintKey& key, const uint8_t* entropy, size_t length) noexcept
+{
+    SipState s = sipHash(key, entropy, length, true);
+    Fingerprint128 out;
+    out.lo = s.finish(0xee);
+    s.v1 ^= 0xdd;
+    out.hi = s.finish(0);
+    return out;
+}
@@ -0,0 +1,192 @@
+#ifndef FINGERPRINT_H
+#define FINGERPRINT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// SipHash key, two little-endian halves of the 16 key bytes.
+struct FingerprintKey
+{
+    uint64_t k0{0};
+    uint64_t k1{0};
+
+    // Fresh key from std::random_device, for maps that hold untrusted mnemonics.
+    static FingerprintKey random();
+};
+
+struct Fingerprint128
+{
+    uint64_t lo;
+    uint64_t hi;
+
+    bool operator==(const Fingerprint128& other) const noexcept
+    {
+        return lo == other.lo && hi == other.hi;
+    }
+    bool operator!=(const Fingerprint128& other) const noexcept { return !(*this == other); }
+};
+
+/*
+ * Fingerprints of a mnemonic's packed entropy (16 to 32 bytes; the length is hashed too),
+ * for hash maps, dedup and screening instead of phrase strings.
+ *
+ * hash64 is a splitmix64 chain: unkeyed, a few multiplies per 8 bytes, and stable across
+ * processes and versions, since screening files store it. Anyone can construct collisions
+ * for it, so maps fed mnemonics from untrusted input use keyed64/keyed128, SipHash-2-4
+ * under a random key. None of these replaces comparing the entropy when an exact answer
+ * matters; see FingerprintMap.
+ */
+class MnemonicFingerprint
+{
+public:
+    static uint64_t hash64(const uint8_t* entropy, size_t length) noexcept;
+    static uint64_t keyed64(
+        const FingerprintKey& key, const uint8_t* entropy, size_t length) noexcept;
+    static Fingerprint128 keyed128(
+        const FingerprintKey& key, const uint8_t* entropy, size_t length) noexcept;
+
+    // The splitmix64 finalizer hash64 is built from.
+    static uint64_t mix64(uint64_t x) noexcept
+    {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+};
+
+struct FingerprintNone
+{
+};
+
+/*
+ * Open-addressing hash map from 64-bit fingerprints to V: linear probing over a
+ * power-of-two table, kept at most 3/4 full, fingerprints and values in separate arrays so
+ * probes only touch the fingerprints. Fingerprints index the table directly, so keys must
+ * be well mixed, as the MnemonicFingerprint outputs are.
+ *
+ * Collisions: the map knows only fingerprints, so two mnemonics with the same fingerprint
+ * share one entry. Among n random mnemonics that happens with probability about n^2 / 2^65:
+ * negligible for caches of millions, a few percent at billions. Callers that must not
+ * conflate mnemonics check the entropy on a hit (V can point at it) and handle a mismatch
+ * themselves, as MnemonicDedup's first-seen mode does.
+ */
+template <typename V>
+class FingerprintMap
+{
+public:
+    explicit FingerprintMap(size_t expected = 0) { reserve(expected); }
+
+    size_t size() const noexcept { return m_size + (m_hasZero ? 1 : 0); }
+    bool empty() const noexcept { return size() == 0; }
+
+    // Sizes the table for `count` entries without rehashing.
+    void reserve(size_t count)
+    {
+        size_t capacity = 16;
+        while (capacity * 3 / 4 < count) {
+            capacity *= 2;
+        }
+        if (capacity > m_keys.size())
+            rehash(capacity);
+    }
+
+    // Drops the entries, keeping the table.
+    void clear() noexcept
+    {
+        std::fill(m_keys.begin(), m_keys.end(), 0);
+        m_size = 0;
+        m_hasZero = false;
+    }
+
+    V* find(uint64_t fingerprint) noexcept
+    {
+        if (fingerprint == 0)
+            return m_hasZero ? &m_zero : nullptr;
+        for (size_t i = fingerprint & m_mask; m_keys[i] != 0; i = (i + 1) & m_mask) {
+            if (m_keys[i] == fingerprint)
+                return &m_values[i];
+        }
+        return nullptr;
+    }
+    const V* find(uint64_t fingerprint) const noexcept
+    {
+        return const_cast<FingerprintMap*>(this)->find(fingerprint);
+    }
+    bool contains(uint64_t fingerprint) const noexcept { return find(fingerprint) != nullptr; }
+
+    // Inserts `value` unless the fingerprint is present; returns the entry and whether it
+    // is new.
+    std::pair<V*, bool> insert(uint64_t fingerprint, const V& value = V())
+    {
+        if (fingerprint == 0) {
+            const bool added = !m_hasZero;
+            if (added)
+                m_zero = value;
+            m_hasZero = true;
+            return {&m_zero, added};
+        }
+        if ((m_size + 1) * 4 > m_keys.size() * 3)
+            rehash(m_keys.size() * 2);
+        size_t i = fingerprint & m_mask;
+        for (; m_keys[i] != 0; i = (i + 1) & m_mask) {
+            if (m_keys[i] == fingerprint)
+                return {&m_values[i], false};
+        }
+        m_keys[i] = fingerprint;
+        m_values[i] = value;
+        m_size++;
+        return {&m_values[i], true};
+    }
+
+    V& operator[](uint64_t fingerprint) { return *insert(fingerprint).first; }
+
+    // Calls visit(fingerprint, value) for every entry, in table order.
+    template <typename Visit>
+    void forEach(Visit visit) const
+    {
+        if (m_hasZero)
+            visit(uint64_t{0}, m_zero);
+        for (size_t i = 0; i < m_keys.size(); i++) {
+            if (m_keys[i] != 0)
+                visit(m_keys[i], m_values[i]);
+        }
+    }
+
+private:
+    void rehash(size_t capacity)
+    {
+        std::vector<uint64_t> keys(capacity, 0);
+        std::vector<V> values(capacity);
+        const size_t mask = capacity - 1;
+        for (size_t j = 0; j < m_keys.size(); j++) {
+            if (m_keys[j] == 0)
+                continue;
+            size_t i = m_keys[j] & mask;
+            while (keys[i] != 0) {
+                i = (i + 1) & mask;
+            }
+            keys[i] = m_keys[j];
+            values[i] = std::move(m_values[j]);
+        }
+        m_keys.swap(keys);
+        m_values.swap(values);
+        m_mask = mask;
+    }
+
+    std::vector<uint64_t> m_keys;    // 0: empty slot
+    std::vector<V> m_values;
+    size_t m_mask{0};
+    size_t m_size{0};
+    bool m_hasZero{false};    // fingerprint 0 lives outside the table
+    V m_zero{};
+};
+
+// Set of fingerprints: FingerprintMap with a one-byte placeholder value.
+using FingerprintSet = FingerprintMap<FingerprintNone>;
+
+#endif // FINGERPRINT_H
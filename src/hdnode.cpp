@@ -0,0 +1,288 @@
+#include "hdnode.h"
+#include "bip39.h"
+#include "pbkdf2_sha512/hash160_lanes.h"
+#include "pbkdf2_sha512/hmac.h"
+#include "pbkdf2_sha512/memzero.h"
+#include "pbkdf2_sha512/sha2.hpp"
+#include "secp256k1.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+constexpr size_t PUBKEY_CHUNK = 256;    // keys per batch inversion
+
+inline uint64_t loadBE64(const uint8_t* p)
+{
+    uint64_t w = 0;
+    for (int i = 0; i < 8; i++) {
+        w = (w << 8) | p[i];
+    }
+    return w;
+}
+
+inline void storeBE64(uint64_t w, uint8_t* p)
+{
+    for (int i = 7; i >= 0; i--) {
+        p[i] = (uint8_t)w;
+        w >>= 8;
+    }
+}
+
+inline void storeBE32(uint32_t w, uint8_t* p)
+{
+    p[0] = (uint8_t)(w >> 24);
+    p[1] = (uint8_t)(w >> 16);
+    p[2] = (uint8_t)(w >> 8);
+    p[3] = (uint8_t)w;
+}
+
+// Calls fn(begin, end) on up to `threads` contiguous slices of [0, count).
+template <typename Fn>
+void parallelRanges(unsigned threads, size_t count, Fn fn)
+{
+    const size_t used = std::min<size_t>(std::max(1u, threads), count);
+    if (used <= 1) {
+        if (count)
+            fn(size_t{0}, count);
+        return;
+    }
+    std::vector<std::thread> pool;
+    pool.reserve(used - 1);
+    for (size_t t = 1; t < used; t++) {
+        pool.emplace_back(fn, count * t / used, count * (t + 1) / used);
+    }
+    fn(size_t{0}, count / used);
+    for (auto& t : pool) {
+        t.join();
+    }
+}
+
+/*
+ * One SHA-512 compression per job: out[j] = Transform(states[j], blocks[j]). Full groups of
+ * `lanes` jobs are interleaved for the lane kernel, the remainder runs the scalar transform.
+ */
+void transformJobs(
+    const BatchConfig& config,
+    size_t count,
+    const uint64_t* const* states,
+    const uint64_t* blocks,
+    uint64_t* out)
+{
+    const size_t lanes = config.lanes;
+    const size_t groups = lanes > 1 ? count / lanes : 0;
+    parallelRanges(config.threads, groups, [&](size_t begin, size_t end) {
+        uint64_t state[8 * SHA512_MAX_LANES];
+        uint64_t data[16 * SHA512_MAX_LANES];
+        for (size_t g = begin; g < end; g++) {
+            const size_t first = g * lanes;
+            for (size_t l = 0; l < lanes; l++) {
+                for (size_t i = 0; i < 8; i++) {
+                    state[i * lanes + l] = states[first + l][i];
+                }
+                for (size_t i = 0; i < 16; i++) {
+                    data[i * lanes + l] = blocks[(first + l) * 16 + i];
+                }
+            }
+            sha512_Transform_lanes(config.kernel, lanes, state, data, state);
+            for (size_t l = 0; l < lanes; l++) {
+                for (size_t i = 0; i < 8; i++) {
+                    out[(first + l) * 8 + i] = state[i * lanes + l];
+                }
+            }
+        }
+        memzero(state, sizeof(state));
+        memzero(data, sizeof(data));
+    });
+    for (size_t j = groups * lanes; j < count; j++) {
+        sha512_Transform(states[j], blocks + j * 16, out + j * 8);
+    }
+}
+
+// Message words of a single-block message after a 128-byte key block, padding included.
+void packBlock(const uint8_t* message, size_t length, uint64_t* words)
+{
+    uint8_t block[SHA512_BLOCK_LENGTH] = {};
+    memcpy(block, message, length);
+    block[length] = 0x80;
+    for (size_t i = 0; i < 15; i++) {
+        words[i] = loadBE64(block + i * 8);
+    }
+    words[15] = (SHA512_BLOCK_LENGTH + length) * 8;
+    memzero(block, sizeof(block));
+}
+}    // namespace
+
+BatchConfig HDBatch::config()
+{
+    BatchConfig config = SeedBatch::config();
+    if (!sha512_kernel_supported(config.kernel))
+        config.kernel = SHA512_KERNEL_SCALAR;
+    return config;
+}
+
+void HDBatch::wipe(std::vector<HDNode>& nodes)
+{
+    memzero(nodes.data(), nodes.size() * sizeof(HDNode));
+    nodes.clear();
+}
+
+void HDBatch::hmac(
+    const BatchConfig& config,
+    size_t count,
+    const uint64_t* const* innerStates,
+    const uint64_t* const* outerStates,
+    const uint8_t* messages,
+    size_t length,
+    uint8_t* out)
+{
+    std::vector<uint64_t> blocks(count * 16);
+    std::vector<uint64_t> digests(count * 8);
+    for (size_t j = 0; j < count; j++) {
+        packBlock(messages + j * length, length, &blocks[j * 16]);
+    }
+    transformJobs(config, count, innerStates, blocks.data(), digests.data());
+    for (size_t j = 0; j < count; j++) {
+        uint64_t* block = &blocks[j * 16];
+        memcpy(block, &digests[j * 8], 8 * sizeof(uint64_t));
+        block[8] = 0x8000000000000000ull;
+        std::fill(block + 9, block + 15, 0);
+        block[15] = (SHA512_BLOCK_LENGTH + SHA512_DIGEST_LENGTH) * 8;
+    }
+    transformJobs(config, count, outerStates, blocks.data(), digests.data());
+    for (size_t j = 0; j < count; j++) {
+        for (size_t i = 0; i < 8; i++) {
+            storeBE64(digests[j * 8 + i], out + j * SHA512_DIGEST_LENGTH + i * 8);
+        }
+    }
+    memzero(blocks.data(), blocks.size() * sizeof(uint64_t));
+    memzero(digests.data(), digests.size() * sizeof(uint64_t));
+}
+
+std::vector<HDNode> HDBatch::masters(
+    const BatchConfig& config, const uint8_t* seeds, size_t count, size_t seedLength)
+{
+    if (seedLength < 16 || seedLength > 64)
+        throw MnemonicException("Invalid seed length");
+    static const char bitcoinSeed[] = "Bitcoin seed";
+    uint64_t inner[8], outer[8];
+    hmac_sha512_prepare(
+        reinterpret_cast<const uint8_t*>(bitcoinSeed), sizeof(bitcoinSeed) - 1, outer, inner);
+
+    std::vector<const uint64_t*> innerStates(count, inner), outerStates(count, outer);
+    std::vector<uint8_t> digests(count * SHA512_DIGEST_LENGTH);
+    hmac(config, count, innerStates.data(), outerStates.data(), seeds, seedLength, digests.data());
+
+    std::vector<HDNode> masters(count);
+    for (size_t w = 0; w < count; w++) {
+        const uint8_t* digest = &digests[w * SHA512_DIGEST_LENGTH];
+        if (!Secp256k1::isValidPrivateKey(digest))
+            throw MnemonicException("Invalid master key");
+        memcpy(masters[w].key, digest, 32);
+        memcpy(masters[w].chain, digest + 32, 32);
+    }
+    memzero(digests.data(), digests.size());
+    memzero(inner, sizeof(inner));
+    memzero(outer, sizeof(outer));
+    return masters;
+}
+
+std::vector<HDNode> HDBatch::children(
+    const BatchConfig& config,
+    const std::vector<HDNode>& parents,
+    const std::vector<uint32_t>& indices)
+{
+    const size_t fanout = indices.size();
+    const size_t count = parents.size() * fanout;
+
+    // key states: the chain code zero-padded to a block, xored with ipad and then opad
+    std::vector<uint64_t> padBlocks(parents.size() * 2 * 16);
+    std::vector<uint64_t> padStates(parents.size() * 2 * 8);
+    std::vector<const uint64_t*> initial(parents.size() * 2, sha512_initial_hash_value);
+    for (size_t p = 0; p < parents.size(); p++) {
+        uint8_t block[SHA512_BLOCK_LENGTH] = {};
+        memcpy(block, parents[p].chain, 32);
+        for (size_t i = 0; i < 16; i++) {
+            const uint64_t word = loadBE64(block + i * 8);
+            padBlocks[(2 * p) * 16 + i] = word ^ 0x3636363636363636ull;
+            padBlocks[(2 * p + 1) * 16 + i] = word ^ 0x5c5c5c5c5c5c5c5cull;
+        }
+        memzero(block, sizeof(block));
+    }
+    transformJobs(config, parents.size() * 2, initial.data(), padBlocks.data(), padStates.data());
+    memzero(padBlocks.data(), padBlocks.size() * sizeof(uint64_t));
+
+    // messages: 0x00 || key || index when hardened, public key || index otherwise
+    static constexpr size_t MESSAGE_LENGTH = 37;
+    std::vector<uint8_t> messages(count * MESSAGE_LENGTH);
+    std::vector<const uint64_t*> innerStates(count), outerStates(count);
+    for (size_t p = 0; p < parents.size(); p++) {
+        for (size_t k = 0; k < fanout; k++) {
+            const size_t c = p * fanout + k;
+            uint8_t* message = &messages[c * MESSAGE_LENGTH];
+            if (indices[k] & HARDENED) {
+                message[0] = 0;
+                memcpy(message + 1, parents[p].key, 32);
+            } else {
+                memcpy(message, parents[p].pub, 33);
+            }
+            storeBE32(indices[k], message + 33);
+            innerStates[c] = &padStates[(2 * p) * 8];
+            outerStates[c] = &padStates[(2 * p + 1) * 8];
+        }
+    }
+    std::vector<uint8_t> digests(count * SHA512_DIGEST_LENGTH);
+    hmac(
+        config,
+        count,
+        innerStates.data(),
+        outerStates.data(),
+        messages.data(),
+        MESSAGE_LENGTH,
+        digests.data());
+    memzero(messages.data(), messages.size());
+    memzero(padStates.data(), padStates.size() * sizeof(uint64_t));
+
+    std::vector<HDNode> children(count);
+    for (size_t c = 0; c < count; c++) {
+        const uint8_t* digest = &digests[c * SHA512_DIGEST_LENGTH];
+        memcpy(children[c].key, parents[c / fanout].key, 32);
+        // IL >= n or a zero key: the next index would be used, at probability below 2^-127
+        if (!Secp256k1::addTweak(children[c].key, digest)) {
+            memzero(digests.data(), digests.size());
+            wipe(children);
+            throw MnemonicException("Invalid child key");
+        }
+        memcpy(children[c].chain, digest + 32, 32);
+    }
+    memzero(digests.data(), digests.size());
+    return children;
+}
+
+std::vector<uint8_t> HDBatch::publicKeys(const BatchConfig& config, std::vector<HDNode>& nodes)
+{
+    std::vector<uint8_t> pubs(nodes.size() * Secp256k1::PUBLIC_KEY_LENGTH);
+    const size_t chunks = (nodes.size() + PUBKEY_CHUNK - 1) / PUBKEY_CHUNK;
+    parallelRanges(config.threads, chunks, [&](size_t begin, size_t end) {
+        uint8_t keys[PUBKEY_CHUNK * Secp256k1::PRIVATE_KEY_LENGTH];
+        for (size_t chunk = begin; chunk < end; chunk++) {
+            const size_t first = chunk * PUBKEY_CHUNK;
+            const size_t used = std::min(PUBKEY_CHUNK, nodes.size() - first);
+            for (size_t i = 0; i < used; i++) {
+                memcpy(keys + i * 32, nodes[first + i].key, 32);
+            }
+            Secp256k1::publicKeys(keys, used, &pubs[first * Secp256k1::PUBLIC_KEY_LENGTH]);
+        }
+        memzero(keys, sizeof(keys));
+    });
+
+    std::vector<uint8_t> hashes(nodes.size() * HASH160_DIGEST_LENGTH);
+    hash160_compressed_lanes(config.kernel, nodes.size(), pubs.data(), hashes.data());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        memcpy(nodes[i].pub, &pubs[i * Secp256k1::PUBLIC_KEY_LENGTH], 33);
+        memcpy(nodes[i].fingerprint, &hashes[i * HASH160_DIGEST_LENGTH], 4);
+    }
+    return hashes;
+}
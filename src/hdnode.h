@@ -0,0 +1,60 @@
+#ifndef HDNODE_H
+#define HDNODE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "batch.h"
+
+// BIP32 private node; pub and fingerprint are set by HDBatch::publicKeys.
+struct HDNode
+{
+    uint8_t key[32];
+    uint8_t chain[32];
+    uint8_t pub[33];
+    uint8_t fingerprint[4];    // HASH160(pub)[0..4], the parent fingerprint of its children
+};
+
+/*
+ * BIP32 private derivation for many nodes at once. HMAC-SHA512 runs on the SHA-512 lane
+ * kernel of the batch configuration, and the HMAC key states of a parent chain code are
+ * computed once for all its children. Intermediate buffers are wiped; callers wipe the
+ * nodes they get back.
+ */
+class HDBatch
+{
+public:
+    static constexpr uint32_t HARDENED = 0x80000000;
+
+    // SeedBatch::config(), with a kernel disabled at runtime replaced by the scalar one.
+    static BatchConfig config();
+
+    // HMAC-SHA512 of `count` back to back messages of `length` bytes (at most 111) whose
+    // keys' inner and outer hash states (hmac_sha512_prepare) are given per message.
+    static void hmac(
+        const BatchConfig& config,
+        size_t count,
+        const uint64_t* const* innerStates,
+        const uint64_t* const* outerStates,
+        const uint8_t* messages,
+        size_t length,
+        uint8_t* out);
+
+    // Master nodes of `count` back to back seeds of 16 to 64 bytes.
+    static std::vector<HDNode> masters(
+        const BatchConfig& config, const uint8_t* seeds, size_t count, size_t seedLength);
+
+    // Child p * indices.size() + k is parent p at index k. Non-hardened indices need the
+    // parent public keys.
+    static std::vector<HDNode> children(
+        const BatchConfig& config,
+        const std::vector<HDNode>& parents,
+        const std::vector<uint32_t>& indices);
+
+    // Public keys and fingerprints of all nodes; returns their HASH160s back to back.
+    static std::vector<uint8_t> publicKeys(const BatchConfig& config, std::vector<HDNode>& nodes);
+
+    static void wipe(std::vector<HDNode>& nodes);
+};
+
+#endif // HDNODE_H
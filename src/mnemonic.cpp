@@ -1,11 +1,13 @@
 #include "mnemonic.h"
 #include "pbkdf2_sha512/pbkdf2.hpp"
+#include "probes.h"
 #include "utils.h"
 
 #include <cstring>
 
 std::vector<uint8_t> Mnemonic::generateSeed(const std::string& passphrase)
 {
+    BIP39_PROBE2(generate_seed__entry, m_wordsCount, passphrase.size());
     std::string pass{BIP39_Utils::Join(words, " ")};
     std::string salt{"mnemonic" + passphrase};
     std::vector<uint8_t> output(BIP39_SEED_LEN_512);
@@ -19,5 +21,6 @@ std::vector<uint8_t> Mnemonic::generateSeed(const std::string& passphrase)
         salt.length(),
         rounds,
         &output[0]);
+    BIP39_PROBE1(generate_seed__return, m_wordsCount);
     return output;
 }
@@ -0,0 +1,368 @@
+#include "hash160_lanes.h"
+
+#include "ripemd160.h"
+#include "sha2.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#    define HASH160_LANES_X86 1
+#    include <immintrin.h>
+#endif
+
+// SHA-256 block of a compressed key: 33 bytes, the 0x80 pad byte and the 264-bit length.
+static void compressed_block(const uint8_t* pubkey, uint32_t* words, size_t stride)
+{
+    for (int i = 0; i < 8; i++) {
+        words[i * stride] = (uint32_t)pubkey[4 * i] << 24 | (uint32_t)pubkey[4 * i + 1] << 16 |
+                            (uint32_t)pubkey[4 * i + 2] << 8 | pubkey[4 * i + 3];
+    }
+    words[8 * stride] = (uint32_t)pubkey[32] << 24 | 0x800000;
+    for (int i = 9; i < 15; i++) {
+        words[i * stride] = 0;
+    }
+    words[15 * stride] = HASH160_COMPRESSED_PUBKEY_LENGTH * 8;
+}
+
+static void digest_bytes(const uint32_t* state, size_t stride, uint8_t* digest)
+{
+    for (int i = 0; i < 5; i++) {
+        for (int b = 0; b < 4; b++) {
+            digest[4 * i + b] = (uint8_t)(state[i * stride] >> (8 * b));
+        }
+    }
+}
+
+static void hash160_compressed_scalar(const uint8_t* pubkey, uint8_t* digest)
+{
+    uint32_t block[16], state[8];
+    compressed_block(pubkey, block, 1);
+    sha256_Transform(sha256_initial_hash_value, block, state);
+    // the 32-byte digest as little-endian words, then the 0x80 pad and the 256-bit length
+    for (int i = 0; i < 8; i++) {
+        REVERSE32(state[i], block[i]);
+    }
+    block[8] = 0x80;
+    for (int i = 9; i < 16; i++) {
+        block[i] = 0;
+    }
+    block[14] = SHA256_DIGEST_LENGTH * 8;
+    ripemd160_Transform(ripemd160_initial_hash_value, block, state);
+    digest_bytes(state, 1, digest);
+}
+
+#ifdef HASH160_LANES_X86
+
+#    define AVX2_ROR32(x, n) \
+        _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+#    define AVX2_ROL32V(x, n)                            \
+        _mm256_or_si256(                                 \
+            _mm256_sll_epi32((x), _mm_cvtsi32_si128(n)), \
+            _mm256_srl_epi32((x), _mm_cvtsi32_si128(32 - (n))))
+#    define AVX2_XOR3(x, y, z) _mm256_xor_si256(_mm256_xor_si256((x), (y)), (z))
+
+__attribute__((target("avx2"))) static inline __m256i rmd_f_avx2(
+    int round, __m256i x, __m256i y, __m256i z)
+{
+    const __m256i ones = _mm256_set1_epi32(-1);
+    switch (round) {
+    case 0:
+        return AVX2_XOR3(x, y, z);
+    case 1:
+        return _mm256_or_si256(_mm256_and_si256(x, y), _mm256_andnot_si256(x, z));
+    case 2:
+        return _mm256_xor_si256(_mm256_or_si256(x, _mm256_xor_si256(y, ones)), z);
+    case 3:
+        return _mm256_or_si256(_mm256_and_si256(x, z), _mm256_andnot_si256(z, y));
+    default:
+        return _mm256_xor_si256(x, _mm256_or_si256(y, _mm256_xor_si256(z, ones)));
+    }
+}
+
+// 8 keys: `block` holds the interleaved SHA-256 blocks, `out` the interleaved RIPEMD-160 state.
+__attribute__((target("avx2"))) static void hash160_group_avx2(const uint32_t* block, uint32_t* out)
+{
+    __m256i w[16];
+    for (int i = 0; i < 16; i++) {
+        w[i] = _mm256_loadu_si256((const __m256i*)(block + i * 8));
+    }
+    __m256i a = _mm256_set1_epi32((int)sha256_initial_hash_value[0]),
+            b = _mm256_set1_epi32((int)sha256_initial_hash_value[1]),
+            c = _mm256_set1_epi32((int)sha256_initial_hash_value[2]),
+            d = _mm256_set1_epi32((int)sha256_initial_hash_value[3]),
+            e = _mm256_set1_epi32((int)sha256_initial_hash_value[4]),
+            f = _mm256_set1_epi32((int)sha256_initial_hash_value[5]),
+            g = _mm256_set1_epi32((int)sha256_initial_hash_value[6]),
+            h = _mm256_set1_epi32((int)sha256_initial_hash_value[7]);
+    for (int j = 0; j < 64; j++) {
+        __m256i wj;
+        if (j < 16) {
+            wj = w[j];
+        } else {
+            __m256i w1 = w[(j + 1) & 15], w14 = w[(j + 14) & 15];
+            __m256i s0 = AVX2_XOR3(AVX2_ROR32(w1, 7), AVX2_ROR32(w1, 18), _mm256_srli_epi32(w1, 3));
+            __m256i s1 = AVX2_XOR3(
+                AVX2_ROR32(w14, 17), AVX2_ROR32(w14, 19), _mm256_srli_epi32(w14, 10));
+            wj = _mm256_add_epi32(
+                _mm256_add_epi32(w[j & 15], s1), _mm256_add_epi32(w[(j + 9) & 15], s0));
+            w[j & 15] = wj;
+        }
+        __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        __m256i maj =
+            _mm256_or_si256(_mm256_and_si256(_mm256_or_si256(a, b), c), _mm256_and_si256(a, b));
+        __m256i t1 = _mm256_add_epi32(
+            _mm256_add_epi32(h, AVX2_XOR3(AVX2_ROR32(e, 6), AVX2_ROR32(e, 11), AVX2_ROR32(e, 25))),
+            _mm256_add_epi32(_mm256_add_epi32(ch, _mm256_set1_epi32((int)K256[j])), wj));
+        __m256i t2 = _mm256_add_epi32(
+            AVX2_XOR3(AVX2_ROR32(a, 2), AVX2_ROR32(a, 13), AVX2_ROR32(a, 22)), maj);
+        h = g;
+        g = f;
+        f = e;
+        e = _mm256_add_epi32(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm256_add_epi32(t1, t2);
+    }
+
+    // SHA-256 digest bytes as RIPEMD-160 little-endian words: a byte swap per word
+    const __m256i swap = _mm256_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m256i digest[8] = {a, b, c, d, e, f, g, h};
+    __m256i x[16];
+    for (int i = 0; i < 8; i++) {
+        x[i] = _mm256_shuffle_epi8(
+            _mm256_add_epi32(digest[i], _mm256_set1_epi32((int)sha256_initial_hash_value[i])),
+            swap);
+    }
+    x[8] = _mm256_set1_epi32(0x80);
+    for (int i = 9; i < 16; i++) {
+        x[i] = _mm256_setzero_si256();
+    }
+    x[14] = _mm256_set1_epi32(SHA256_DIGEST_LENGTH * 8);
+
+    __m256i s[5];
+    for (int i = 0; i < 5; i++) {
+        s[i] = _mm256_set1_epi32((int)ripemd160_initial_hash_value[i]);
+    }
+    __m256i al = s[0], bl = s[1], cl = s[2], dl = s[3], el = s[4];
+    __m256i ar = al, br = bl, cr = cl, dr = dl, er = el;
+    for (int round = 0; round < 5; round++) {
+        const __m256i kl = _mm256_set1_epi32((int)RMD160_K[0][round]);
+        const __m256i kr = _mm256_set1_epi32((int)RMD160_K[1][round]);
+        for (int j = round * 16; j < round * 16 + 16; j++) {
+            __m256i t = _mm256_add_epi32(
+                _mm256_add_epi32(al, rmd_f_avx2(round, bl, cl, dl)),
+                _mm256_add_epi32(x[RMD160_R[0][j]], kl));
+            t = _mm256_add_epi32(AVX2_ROL32V(t, RMD160_S[0][j]), el);
+            al = el;
+            el = dl;
+            dl = AVX2_ROL32V(cl, 10);
+            cl = bl;
+            bl = t;
+            t = _mm256_add_epi32(
+                _mm256_add_epi32(ar, rmd_f_avx2(4 - round, br, cr, dr)),
+                _mm256_add_epi32(x[RMD160_R[1][j]], kr));
+            t = _mm256_add_epi32(AVX2_ROL32V(t, RMD160_S[1][j]), er);
+            ar = er;
+            er = dr;
+            dr = AVX2_ROL32V(cr, 10);
+            cr = br;
+            br = t;
+        }
+    }
+    const __m256i r[5] = {
+        _mm256_add_epi32(_mm256_add_epi32(s[1], cl), dr),
+        _mm256_add_epi32(_mm256_add_epi32(s[2], dl), er),
+        _mm256_add_epi32(_mm256_add_epi32(s[3], el), ar),
+        _mm256_add_epi32(_mm256_add_epi32(s[4], al), br),
+        _mm256_add_epi32(_mm256_add_epi32(s[0], bl), cr)};
+    for (int i = 0; i < 5; i++) {
+        _mm256_storeu_si256((__m256i*)(out + i * 8), r[i]);
+    }
+}
+
+#    define AVX512_XOR3(x, y, z) _mm512_ternarylogic_epi32((x), (y), (z), 0x96)
+
+// Truth tables for _mm512_ternarylogic_epi32(x, y, z, imm) of the five RIPEMD-160 functions.
+__attribute__((target("avx512f"))) static inline __m512i rmd_f_avx512(
+    int round, __m512i x, __m512i y, __m512i z)
+{
+    switch (round) {
+    case 0:
+        return _mm512_ternarylogic_epi32(x, y, z, 0x96);
+    case 1:
+        return _mm512_ternarylogic_epi32(x, y, z, 0xca);
+    case 2:
+        return _mm512_ternarylogic_epi32(x, y, z, 0x59);
+    case 3:
+        return _mm512_ternarylogic_epi32(x, y, z, 0xe4);
+    default:
+        return _mm512_ternarylogic_epi32(x, y, z, 0x2d);
+    }
+}
+
+// 16 keys, laid out as for hash160_group_avx2.
+__attribute__((target("avx512f"))) static void hash160_group_avx512(
+    const uint32_t* block, uint32_t* out)
+{
+    __m512i w[16];
+    for (int i = 0; i < 16; i++) {
+        w[i] = _mm512_loadu_si512((const void*)(block + i * 16));
+    }
+    __m512i a = _mm512_set1_epi32((int)sha256_initial_hash_value[0]),
+            b = _mm512_set1_epi32((int)sha256_initial_hash_value[1]),
+            c = _mm512_set1_epi32((int)sha256_initial_hash_value[2]),
+            d = _mm512_set1_epi32((int)sha256_initial_hash_value[3]),
+            e = _mm512_set1_epi32((int)sha256_initial_hash_value[4]),
+            f = _mm512_set1_epi32((int)sha256_initial_hash_value[5]),
+            g = _mm512_set1_epi32((int)sha256_initial_hash_value[6]),
+            h = _mm512_set1_epi32((int)sha256_initial_hash_value[7]);
+    for (int j = 0; j < 64; j++) {
+        __m512i wj;
+        if (j < 16) {
+            wj = w[j];
+        } else {
+            __m512i w1 = w[(j + 1) & 15], w14 = w[(j + 14) & 15];
+            __m512i s0 = AVX512_XOR3(
+                _mm512_ror_epi32(w1, 7), _mm512_ror_epi32(w1, 18), _mm512_srli_epi32(w1, 3));
+            __m512i s1 = AVX512_XOR3(
+                _mm512_ror_epi32(w14, 17),
+                _mm512_ror_epi32(w14, 19),
+                _mm512_srli_epi32(w14, 10));
+            wj = _mm512_add_epi32(
+                _mm512_add_epi32(w[j & 15], s1), _mm512_add_epi32(w[(j + 9) & 15], s0));
+            w[j & 15] = wj;
+        }
+        __m512i ch = _mm512_ternarylogic_epi32(e, f, g, 0xca);
+        __m512i maj = _mm512_ternarylogic_epi32(a, b, c, 0xe8);
+        __m512i t1 = _mm512_add_epi32(
+            _mm512_add_epi32(
+                h,
+                AVX512_XOR3(
+                    _mm512_ror_epi32(e, 6), _mm512_ror_epi32(e, 11), _mm512_ror_epi32(e, 25))),
+            _mm512_add_epi32(_mm512_add_epi32(ch, _mm512_set1_epi32((int)K256[j])), wj));
+        __m512i t2 = _mm512_add_epi32(
+            AVX512_XOR3(_mm512_ror_epi32(a, 2), _mm512_ror_epi32(a, 13), _mm512_ror_epi32(a, 22)),
+            maj);
+        h = g;
+        g = f;
+        f = e;
+        e = _mm512_add_epi32(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm512_add_epi32(t1, t2);
+    }
+
+    // byte swap without AVX512BW: bytes 0 and 2 from a left rotation, 1 and 3 from a right one
+    const __m512i even = _mm512_set1_epi32(0x00ff00ff);
+    const __m512i digest[8] = {a, b, c, d, e, f, g, h};
+    __m512i x[16];
+    for (int i = 0; i < 8; i++) {
+        const __m512i v =
+            _mm512_add_epi32(digest[i], _mm512_set1_epi32((int)sha256_initial_hash_value[i]));
+        x[i] = _mm512_ternarylogic_epi32(
+            even, _mm512_rol_epi32(v, 8), _mm512_ror_epi32(v, 8), 0xca);
+    }
+    x[8] = _mm512_set1_epi32(0x80);
+    for (int i = 9; i < 16; i++) {
+        x[i] = _mm512_setzero_si512();
+    }
+    x[14] = _mm512_set1_epi32(SHA256_DIGEST_LENGTH * 8);
+
+    __m512i s[5];
+    for (int i = 0; i < 5; i++) {
+        s[i] = _mm512_set1_epi32((int)ripemd160_initial_hash_value[i]);
+    }
+    __m512i al = s[0], bl = s[1], cl = s[2], dl = s[3], el = s[4];
+    __m512i ar = al, br = bl, cr = cl, dr = dl, er = el;
+    for (int round = 0; round < 5; round++) {
+        const __m512i kl = _mm512_set1_epi32((int)RMD160_K[0][round]);
+        const __m512i kr = _mm512_set1_epi32((int)RMD160_K[1][round]);
+        for (int j = round * 16; j < round * 16 + 16; j++) {
+            __m512i t = _mm512_add_epi32(
+                _mm512_add_epi32(al, rmd_f_avx512(round, bl, cl, dl)),
+                _mm512_add_epi32(x[RMD160_R[0][j]], kl));
+            t = _mm512_add_epi32(
+                _mm512_rolv_epi32(t, _mm512_set1_epi32(RMD160_S[0][j])), el);
+            al = el;
+            el = dl;
+            dl = _mm512_rol_epi32(cl, 10);
+            cl = bl;
+            bl = t;
+            t = _mm512_add_epi32(
+                _mm512_add_epi32(ar, rmd_f_avx512(4 - round, br, cr, dr)),
+                _mm512_add_epi32(x[RMD160_R[1][j]], kr));
+            t = _mm512_add_epi32(
+                _mm512_rolv_epi32(t, _mm512_set1_epi32(RMD160_S[1][j])), er);
+            ar = er;
+            er = dr;
+            dr = _mm512_rol_epi32(cr, 10);
+            cr = br;
+            br = t;
+        }
+    }
+    const __m512i r[5] = {
+        _mm512_add_epi32(_mm512_add_epi32(s[1], cl), dr),
+        _mm512_add_epi32(_mm512_add_epi32(s[2], dl), er),
+        _mm512_add_epi32(_mm512_add_epi32(s[3], el), ar),
+        _mm512_add_epi32(_mm512_add_epi32(s[4], al), br),
+        _mm512_add_epi32(_mm512_add_epi32(s[0], bl), cr)};
+    for (int i = 0; i < 5; i++) {
+        _mm512_storeu_si512((void*)(out + i * 16), r[i]);
+    }
+}
+
+#endif /* HASH160_LANES_X86 */
+
+void hash160_Raw(const uint8_t* data, size_t len, uint8_t digest[HASH160_DIGEST_LENGTH])
+{
+    uint8_t sha[SHA256_DIGEST_LENGTH];
+    sha256_Raw(data, len, sha);
+    ripemd160_Raw(sha, sizeof(sha), digest);
+}
+
+size_t hash160_kernel_width(sha512_kernel kernel)
+{
+    switch (kernel) {
+    case SHA512_KERNEL_AVX2:
+        return 8;
+    case SHA512_KERNEL_AVX512:
+        return 16;
+    default:
+        return 1;
+    }
+}
+
+void hash160_compressed_lanes(
+    sha512_kernel kernel, size_t count, const uint8_t* pubkeys, uint8_t* digests)
+{
+    if (!sha512_kernel_supported(kernel)) {
+        kernel = SHA512_KERNEL_SCALAR;
+    }
+    size_t i = 0;
+#ifdef HASH160_LANES_X86
+    const size_t width = hash160_kernel_width(kernel);
+    if (width > 1) {
+        uint32_t block[16 * 16], state[5 * 16];
+        for (; i + width <= count; i += width) {
+            for (size_t l = 0; l < width; l++) {
+                compressed_block(
+                    pubkeys + (i + l) * HASH160_COMPRESSED_PUBKEY_LENGTH, block + l, width);
+            }
+            if (kernel == SHA512_KERNEL_AVX512) {
+                hash160_group_avx512(block, state);
+            } else {
+                hash160_group_avx2(block, state);
+            }
+            for (size_t l = 0; l < width; l++) {
+                digest_bytes(state + l, width, digests + (i + l) * HASH160_DIGEST_LENGTH);
+            }
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        hash160_compressed_scalar(
+            pubkeys + i * HASH160_COMPRESSED_PUBKEY_LENGTH, digests + i * HASH160_DIGEST_LENGTH);
+    }
+}
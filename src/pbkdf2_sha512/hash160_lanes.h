@@ -0,0 +1,29 @@
+#ifndef __HASH160_LANES_H__
+#define __HASH160_LANES_H__
+
+#include "sha512_lanes.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#define HASH160_DIGEST_LENGTH 20
+#define HASH160_COMPRESSED_PUBKEY_LENGTH 33
+
+// RIPEMD-160(SHA-256(data)).
+void hash160_Raw(const uint8_t* data, size_t len, uint8_t digest[HASH160_DIGEST_LENGTH]);
+
+// Keys hashed per vector by the kernel: 1, or 8 and 16 32-bit lanes for AVX2 and AVX-512.
+// Kernel selection, support and the kill switch are shared with the SHA-512 lanes.
+size_t hash160_kernel_width(sha512_kernel kernel);
+
+/*
+ * HASH160 of `count` 33-byte compressed public keys, stored back to back in `pubkeys`;
+ * `digests` receives 20 * count bytes. Each key is one SHA-256 block whose digest is one
+ * RIPEMD-160 block, so both run fused in registers across the kernel's lanes. Any count is
+ * accepted: the remainder after the last full vector, and disabled or unsupported kernels,
+ * run the scalar code.
+ */
+void hash160_compressed_lanes(
+    sha512_kernel kernel, size_t count, const uint8_t* pubkeys, uint8_t* digests);
+
+#endif
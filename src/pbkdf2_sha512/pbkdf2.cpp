@@ -23,6 +23,7 @@
 
 #include "pbkdf2.hpp"
 
+#include "common.h"
 #include "hmac.h"
 #include "memzero.h"
 #include "sha2.hpp"
@@ -60,8 +61,8 @@ void pbkdf2_hmac_sha256_Init(PBKDF2_HMAC_SHA256_CTX* pctx, const uint8_t* pass,
 void pbkdf2_hmac_sha256_Update(PBKDF2_HMAC_SHA256_CTX *pctx, uint32_t iterations)
 {
 	for (uint32_t i = pctx->first; i < iterations; i++) {
-		sha256_Transform(pctx->idig, pctx->g, pctx->g);
-		sha256_Transform(pctx->odig, pctx->g, pctx->g);
+		sha256_Transform_single(pctx->idig, pctx->g, pctx->g);
+		sha256_Transform_single(pctx->odig, pctx->g, pctx->g);
 		for (uint32_t j = 0; j < SHA256_DIGEST_LENGTH/sizeof(uint32_t); j++) {
 			pctx->f[j] ^= pctx->g[j];
 		}
@@ -88,6 +89,59 @@ void pbkdf2_hmac_sha256(const uint8_t *pass, int passlen, const uint8_t *salt, i
 	pbkdf2_hmac_sha256_Final(&pctx, key);
 }
 
+void pbkdf2_hmac_sha256_lanes(sha512_kernel kernel, size_t lanes, const uint8_t *const *pass, const int *passlen, const uint8_t *const *salt, const int *saltlen, const uint32_t *iterations, uint8_t *keys)
+{
+	const size_t words = SHA256_DIGEST_LENGTH / sizeof(uint32_t);
+	PBKDF2_HMAC_SHA256_CTX pctx;
+	uint32_t odig[8 * SHA256_MAX_LANES];
+	uint32_t idig[8 * SHA256_MAX_LANES];
+	uint32_t f[8 * SHA256_MAX_LANES];
+	uint32_t g[16 * SHA256_MAX_LANES];
+
+	/* the salt block and first iteration differ in length per lane, run them one by one */
+	for (size_t l = 0; l < lanes; l++) {
+		pbkdf2_hmac_sha256_Init(&pctx, pass[l], passlen[l], salt[l], saltlen[l]);
+		for (size_t k = 0; k < SHA256_BLOCK_LENGTH / sizeof(uint32_t); k++) {
+			g[k * lanes + l] = pctx.g[k];
+		}
+		for (size_t k = 0; k < words; k++) {
+			odig[k * lanes + l] = pctx.odig[k];
+			idig[k * lanes + l] = pctx.idig[k];
+			f[k * lanes + l] = pctx.f[k];
+		}
+	}
+	memzero(&pctx, sizeof(pctx));
+
+	/* all lanes run to the highest count; each key is taken when its own count is reached */
+	for (uint32_t done = 1;;) {
+		uint32_t next = UINT32_MAX;
+		for (size_t l = 0; l < lanes; l++) {
+			const uint32_t count = iterations[l] > 1 ? iterations[l] : 1;
+			if (count == done) {
+				for (size_t k = 0; k < words; k++) {
+					WriteBE32(keys + l * SHA256_DIGEST_LENGTH + k * sizeof(uint32_t), f[k * lanes + l]);
+				}
+			} else if (count > done && count < next) {
+				next = count;
+			}
+		}
+		if (next == UINT32_MAX)
+			break;
+		for (; done < next; done++) {
+			sha256_Transform_lanes(kernel, lanes, idig, g, g);
+			sha256_Transform_lanes(kernel, lanes, odig, g, g);
+			for (size_t j = 0; j < words * lanes; j++) {
+				f[j] ^= g[j];
+			}
+		}
+	}
+
+	memzero(odig, sizeof(odig));
+	memzero(idig, sizeof(idig));
+	memzero(f, sizeof(f));
+	memzero(g, sizeof(g));
+}
+
 void pbkdf2_hmac_sha512_Init(PBKDF2_HMAC_SHA512_CTX *pctx, const uint8_t *pass, int passlen, const uint8_t *salt, int saltlen)
 {
     trezor::SHA512_CTX ctx;
@@ -115,6 +169,7 @@ void pbkdf2_hmac_sha512_Init(PBKDF2_HMAC_SHA512_CTX *pctx, const uint8_t *pass,
 	sha512_Transform(pctx->odig, pctx->g, pctx->g);
 	memcpy(pctx->f, pctx->g, SHA512_DIGEST_LENGTH);
 	pctx->first = 1;
+	pctx->iterations = 1;
 }
 
 void pbkdf2_hmac_sha512_Update(PBKDF2_HMAC_SHA512_CTX *pctx, uint32_t iterations)
@@ -126,6 +181,9 @@ void pbkdf2_hmac_sha512_Update(PBKDF2_HMAC_SHA512_CTX *pctx, uint32_t iterations
 			pctx->f[j] ^= pctx->g[j];
 		}
 	}
+	if (iterations > (uint32_t)pctx->first) {
+		pctx->iterations += iterations - pctx->first;
+	}
 	pctx->first = 0;
 }
 
@@ -147,3 +205,105 @@ void pbkdf2_hmac_sha512(const uint8_t *pass, int passlen, const uint8_t *salt, i
 	pbkdf2_hmac_sha512_Update(&pctx, iterations);
 	pbkdf2_hmac_sha512_Final(&pctx, key);
 }
+
+void pbkdf2_hmac_sha512_lanes(sha512_kernel kernel, size_t lanes, const uint8_t *const *pass, const int *passlen, const uint8_t *const *salt, const int *saltlen, uint32_t iterations, uint8_t *keys)
+{
+	const size_t words = SHA512_DIGEST_LENGTH / sizeof(uint64_t);
+	PBKDF2_HMAC_SHA512_CTX pctx;
+	uint64_t odig[8 * SHA512_MAX_LANES];
+	uint64_t idig[8 * SHA512_MAX_LANES];
+	uint64_t f[8 * SHA512_MAX_LANES];
+	uint64_t g[16 * SHA512_MAX_LANES];
+
+	/* the salt block and first iteration differ in length per lane, run them one by one */
+	for (size_t l = 0; l < lanes; l++) {
+		pbkdf2_hmac_sha512_Init(&pctx, pass[l], passlen[l], salt[l], saltlen[l]);
+		for (size_t k = 0; k < SHA512_BLOCK_LENGTH / sizeof(uint64_t); k++) {
+			g[k * lanes + l] = pctx.g[k];
+		}
+		for (size_t k = 0; k < words; k++) {
+			odig[k * lanes + l] = pctx.odig[k];
+			idig[k * lanes + l] = pctx.idig[k];
+			f[k * lanes + l] = pctx.f[k];
+		}
+	}
+	memzero(&pctx, sizeof(pctx));
+
+	for (uint32_t i = 1; i < iterations; i++) {
+		sha512_Transform_lanes(kernel, lanes, idig, g, g);
+		sha512_Transform_lanes(kernel, lanes, odig, g, g);
+		for (size_t j = 0; j < words * lanes; j++) {
+			f[j] ^= g[j];
+		}
+	}
+
+	for (size_t l = 0; l < lanes; l++) {
+		for (size_t k = 0; k < words; k++) {
+			WriteBE64(keys + l * SHA512_DIGEST_LENGTH + k * sizeof(uint64_t), f[k * lanes + l]);
+		}
+	}
+	memzero(odig, sizeof(odig));
+	memzero(idig, sizeof(idig));
+	memzero(f, sizeof(f));
+	memzero(g, sizeof(g));
+}
+
+static const uint8_t pbkdf2_state_magic[4] = {'P', 'B', 'K', 'S'};
+
+static void pbkdf2_state_checksum(const uint8_t *in, uint8_t check[4])
+{
+	uint8_t hash[SHA256_DIGEST_LENGTH];
+	sha256_Raw(in, PBKDF2_HMAC_SHA512_STATE_LENGTH - 4, hash);
+	memcpy(check, hash, 4);
+	memzero(hash, sizeof(hash));
+}
+
+void pbkdf2_hmac_sha512_Export(const PBKDF2_HMAC_SHA512_CTX *pctx, uint8_t out[PBKDF2_HMAC_SHA512_STATE_LENGTH])
+{
+	const uint64_t *words[4] = {pctx->odig, pctx->idig, pctx->f, pctx->g};
+	uint8_t *p = out;
+
+	memcpy(p, pbkdf2_state_magic, sizeof(pbkdf2_state_magic));
+	p[4] = PBKDF2_HMAC_SHA512_STATE_VERSION;
+	p[5] = pctx->first ? 1 : 0;
+	p[6] = p[7] = 0;
+	WriteBE32(p + 8, pctx->iterations);
+	p += 12;
+	for (int i = 0; i < 4; i++) {
+		for (uint32_t k = 0; k < SHA512_DIGEST_LENGTH / sizeof(uint64_t); k++) {
+			WriteBE64(p, words[i][k]);
+			p += sizeof(uint64_t);
+		}
+	}
+	pbkdf2_state_checksum(out, p);
+}
+
+int pbkdf2_hmac_sha512_Import(PBKDF2_HMAC_SHA512_CTX *pctx, const uint8_t *in, size_t inlen)
+{
+	uint8_t check[4];
+
+	if (inlen != PBKDF2_HMAC_SHA512_STATE_LENGTH || memcmp(in, pbkdf2_state_magic, sizeof(pbkdf2_state_magic)) != 0 ||
+	    in[4] != PBKDF2_HMAC_SHA512_STATE_VERSION || in[5] > 1 || in[6] != 0 || in[7] != 0) {
+		return 0;
+	}
+	pbkdf2_state_checksum(in, check);
+	if (memcmp(check, in + PBKDF2_HMAC_SHA512_STATE_LENGTH - 4, sizeof(check)) != 0) {
+		return 0;
+	}
+
+	uint64_t *words[4] = {pctx->odig, pctx->idig, pctx->f, pctx->g};
+	const uint8_t *p = in + 12;
+	for (int i = 0; i < 4; i++) {
+		for (uint32_t k = 0; k < SHA512_DIGEST_LENGTH / sizeof(uint64_t); k++) {
+			words[i][k] = ReadBE64(p);
+			p += sizeof(uint64_t);
+		}
+	}
+	/* the second half of g is constant padding, see pbkdf2_hmac_sha512_Init */
+	memset(pctx->g + 8, 0, sizeof(pctx->g) / 2);
+	pctx->g[8] = 0x8000000000000000;
+	pctx->g[15] = (SHA512_BLOCK_LENGTH + SHA512_DIGEST_LENGTH) * 8;
+	pctx->first = (char)in[5];
+	pctx->iterations = ReadBE32(in + 8);
+	return 1;
+}
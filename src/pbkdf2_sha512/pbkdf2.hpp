@@ -26,6 +26,8 @@
 
 //#include "/bip39_core.h"
 #include "sha2.hpp"
+#include "sha256_lanes.h"
+#include "sha512_lanes.h"
 
 typedef struct _PBKDF2_HMAC_SHA256_CTX {
 	uint32_t odig[SHA256_DIGEST_LENGTH / sizeof(uint32_t)];
@@ -41,16 +43,41 @@ typedef struct _PBKDF2_HMAC_SHA512_CTX {
 	uint64_t f[SHA512_DIGEST_LENGTH / sizeof(uint64_t)];
 	uint64_t g[SHA512_BLOCK_LENGTH / sizeof(uint64_t)];
 	char first;
+	uint32_t iterations;
 } PBKDF2_HMAC_SHA512_CTX;
 
+/*
+ * Serialized PBKDF2-HMAC-SHA512 state, all integers big-endian:
+ *   magic "PBKS", version, first flag, 2 zero bytes, completed iterations (4),
+ *   odig, idig, f, g[0..7] (64 each), first 4 bytes of SHA-256 over the preceding bytes.
+ * The blob is as sensitive as the password itself; encrypt it before it leaves memory.
+ */
+#define PBKDF2_HMAC_SHA512_STATE_VERSION 1
+#define PBKDF2_HMAC_SHA512_STATE_LENGTH (12 + 4 * SHA512_DIGEST_LENGTH + 4)
+
 void pbkdf2_hmac_sha256_Init(PBKDF2_HMAC_SHA256_CTX* pctx, const uint8_t* pass, int passlen, const uint8_t* salt, int saltlen);
 void pbkdf2_hmac_sha256_Update(PBKDF2_HMAC_SHA256_CTX* pctx, uint32_t iterations);
 void pbkdf2_hmac_sha256_Final(PBKDF2_HMAC_SHA256_CTX* pctx, uint8_t* key);
 void pbkdf2_hmac_sha256(const uint8_t* pass, int passlen, const uint8_t* salt, int saltlen, uint32_t iterations, uint8_t* key);
 
+/*
+ * Derives `lanes` independent keys of SHA256_DIGEST_LENGTH bytes each into keys[0..lanes),
+ * lane l with iterations[l] iterations; all lanes run as long as the highest count.
+ * `lanes` follows the sha256_Transform_lanes rules for the chosen kernel.
+ */
+void pbkdf2_hmac_sha256_lanes(sha512_kernel kernel, size_t lanes, const uint8_t* const* pass, const int* passlen, const uint8_t* const* salt, const int* saltlen, const uint32_t* iterations, uint8_t* keys);
+
 void pbkdf2_hmac_sha512_Init(PBKDF2_HMAC_SHA512_CTX* pctx, const uint8_t* pass, int passlen, const uint8_t* salt, int saltlen);
 void pbkdf2_hmac_sha512_Update(PBKDF2_HMAC_SHA512_CTX* pctx, uint32_t iterations);
 void pbkdf2_hmac_sha512_Final(PBKDF2_HMAC_SHA512_CTX* pctx, uint8_t* key);
 void pbkdf2_hmac_sha512(const uint8_t* pass, int passlen, const uint8_t* salt, int saltlen, uint32_t iterations, uint8_t* key);
+void pbkdf2_hmac_sha512_Export(const PBKDF2_HMAC_SHA512_CTX* pctx, uint8_t out[PBKDF2_HMAC_SHA512_STATE_LENGTH]);
+int pbkdf2_hmac_sha512_Import(PBKDF2_HMAC_SHA512_CTX* pctx, const uint8_t* in, size_t inlen);
+
+/*
+ * Derives `lanes` independent keys of SHA512_DIGEST_LENGTH bytes each into keys[0..lanes).
+ * `lanes` follows the sha512_Transform_lanes rules for the chosen kernel.
+ */
+void pbkdf2_hmac_sha512_lanes(sha512_kernel kernel, size_t lanes, const uint8_t* const* pass, const int* passlen, const uint8_t* const* salt, const int* saltlen, uint32_t iterations, uint8_t* keys);
 
 #endif
@@ -0,0 +1,170 @@
+#include "ripemd160.h"
+
+#include "memzero.h"
+
+#include <cstring>
+
+const uint32_t ripemd160_initial_hash_value[5] = {
+    0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+const uint8_t RMD160_R[2][80] = {
+    {0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15, 7,  4,  13, 1,
+     10, 6,  15, 3,  12, 0,  9,  5,  2,  14, 11, 8,  3,  10, 14, 4,  9,  15, 8,  1,
+     2,  7,  0,  6,  13, 11, 5,  12, 1,  9,  11, 10, 0,  8,  12, 4,  13, 3,  7,  15,
+     14, 5,  6,  2,  4,  0,  5,  9,  7,  12, 2,  10, 14, 1,  3,  8,  11, 6,  15, 13},
+    {5,  14, 7,  0,  9, 2,  11, 4,  13, 6,  15, 8,  1,  10, 3,  12, 6,  11, 3,  7,
+     0,  13, 5,  10, 14, 15, 8,  12, 4,  9,  1,  2,  15, 5,  1,  3,  7,  14, 6,  9,
+     11, 8,  12, 2,  10, 0,  4,  13, 8,  6,  4,  1,  3,  11, 15, 0,  5,  12, 2,  13,
+     9,  7,  10, 14, 12, 15, 10, 4,  1,  5,  8,  7,  6,  2,  13, 14, 0,  3,  9,  11}};
+
+const uint8_t RMD160_S[2][80] = {
+    {11, 14, 15, 12, 5,  8,  7,  9,  11, 13, 14, 15, 6,  7,  9,  8,  7,  6,  8,  13,
+     11, 9,  7,  15, 7,  12, 15, 9,  11, 7,  13, 12, 11, 13, 6,  7,  14, 9,  13, 15,
+     14, 8,  13, 6,  5,  12, 7,  5,  11, 12, 14, 15, 14, 15, 9,  8,  9,  14, 5,  6,
+     8,  6,  5,  12, 9,  15, 5,  11, 6,  8,  13, 12, 5,  12, 13, 14, 11, 8,  5,  6},
+    {8,  9,  9,  11, 13, 15, 15, 5,  7,  7,  8,  11, 14, 14, 12, 6,  9,  13, 15, 7,
+     12, 8,  9,  11, 7,  7,  12, 7,  6,  15, 13, 11, 9,  7,  15, 11, 8,  6,  6,  14,
+     12, 13, 5,  14, 13, 13, 7,  5,  15, 5,  8,  11, 14, 14, 6,  14, 6,  9,  12, 9,
+     12, 5,  15, 8,  8,  5,  12, 9,  12, 5,  14, 6,  8,  13, 6,  5,  15, 13, 11, 11}};
+
+const uint32_t RMD160_K[2][5] = {
+    {0x00000000, 0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xa953fd4e},
+    {0x50a28be6, 0x5c4dd124, 0x6d703ef3, 0x7a6d76e9, 0x00000000}};
+
+static inline uint32_t rol32(uint32_t x, int n)
+{
+    return (x << n) | (x >> (32 - n));
+}
+
+// Boolean function of round `R`; the right line runs them in reverse order.
+template <int R>
+static inline uint32_t rmd_f(uint32_t x, uint32_t y, uint32_t z)
+{
+    switch (R) {
+    case 0:
+        return x ^ y ^ z;
+    case 1:
+        return (x & y) | (~x & z);
+    case 2:
+        return (x | ~y) ^ z;
+    case 3:
+        return (x & z) | (y & ~z);
+    default:
+        return x ^ (y | ~z);
+    }
+}
+
+// The 16 steps of round `R` on both lines.
+template <int R>
+static inline void rmd_round(const uint32_t* data, uint32_t* l, uint32_t* r)
+{
+    for (int j = R * 16; j < R * 16 + 16; j++) {
+        uint32_t t =
+            rol32(l[0] + rmd_f<R>(l[1], l[2], l[3]) + data[RMD160_R[0][j]] + RMD160_K[0][R],
+                  RMD160_S[0][j]) +
+            l[4];
+        l[0] = l[4];
+        l[4] = l[3];
+        l[3] = rol32(l[2], 10);
+        l[2] = l[1];
+        l[1] = t;
+        t = rol32(r[0] + rmd_f<4 - R>(r[1], r[2], r[3]) + data[RMD160_R[1][j]] + RMD160_K[1][R],
+                  RMD160_S[1][j]) +
+            r[4];
+        r[0] = r[4];
+        r[4] = r[3];
+        r[3] = rol32(r[2], 10);
+        r[2] = r[1];
+        r[1] = t;
+    }
+}
+
+void ripemd160_Transform(const uint32_t* state_in, const uint32_t* data, uint32_t* state_out)
+{
+    // a..e of the left and right lines
+    uint32_t l[5], r[5];
+    for (int i = 0; i < 5; i++) {
+        l[i] = r[i] = state_in[i];
+    }
+    rmd_round<0>(data, l, r);
+    rmd_round<1>(data, l, r);
+    rmd_round<2>(data, l, r);
+    rmd_round<3>(data, l, r);
+    rmd_round<4>(data, l, r);
+    const uint32_t t = state_in[1] + l[2] + r[3];
+    state_out[1] = state_in[2] + l[3] + r[4];
+    state_out[2] = state_in[3] + l[4] + r[0];
+    state_out[3] = state_in[4] + l[0] + r[1];
+    state_out[4] = state_in[0] + l[1] + r[2];
+    state_out[0] = t;
+}
+
+static void ripemd160_block(RIPEMD160_CTX* context, const uint8_t* block)
+{
+    uint32_t words[16];
+    for (int i = 0; i < 16; i++) {
+        words[i] = (uint32_t)block[4 * i] | (uint32_t)block[4 * i + 1] << 8 |
+                   (uint32_t)block[4 * i + 2] << 16 | (uint32_t)block[4 * i + 3] << 24;
+    }
+    ripemd160_Transform(context->state, words, context->state);
+    memzero(words, sizeof(words));
+}
+
+void ripemd160_Init(RIPEMD160_CTX* context)
+{
+    memcpy(context->state, ripemd160_initial_hash_value, sizeof(context->state));
+    context->bitcount = 0;
+    memzero(context->buffer, sizeof(context->buffer));
+}
+
+void ripemd160_Update(RIPEMD160_CTX* context, const uint8_t* data, size_t len)
+{
+    size_t used = (context->bitcount >> 3) % RIPEMD160_BLOCK_LENGTH;
+    context->bitcount += (uint64_t)len << 3;
+    if (used) {
+        const size_t take =
+            len < RIPEMD160_BLOCK_LENGTH - used ? len : RIPEMD160_BLOCK_LENGTH - used;
+        memcpy(context->buffer + used, data, take);
+        data += take;
+        len -= take;
+        if (used + take < RIPEMD160_BLOCK_LENGTH)
+            return;
+        ripemd160_block(context, context->buffer);
+    }
+    for (; len >= RIPEMD160_BLOCK_LENGTH; len -= RIPEMD160_BLOCK_LENGTH) {
+        ripemd160_block(context, data);
+        data += RIPEMD160_BLOCK_LENGTH;
+    }
+    memcpy(context->buffer, data, len);
+}
+
+void ripemd160_Final(RIPEMD160_CTX* context, uint8_t digest[RIPEMD160_DIGEST_LENGTH])
+{
+    const uint64_t bitcount = context->bitcount;
+    size_t used = (bitcount >> 3) % RIPEMD160_BLOCK_LENGTH;
+    context->buffer[used++] = 0x80;
+    if (used > RIPEMD160_BLOCK_LENGTH - 8) {
+        memset(context->buffer + used, 0, RIPEMD160_BLOCK_LENGTH - used);
+        ripemd160_block(context, context->buffer);
+        used = 0;
+    }
+    memset(context->buffer + used, 0, RIPEMD160_BLOCK_LENGTH - 8 - used);
+    for (int i = 0; i < 8; i++) {
+        context->buffer[RIPEMD160_BLOCK_LENGTH - 8 + i] = (uint8_t)(bitcount >> (8 * i));
+    }
+    ripemd160_block(context, context->buffer);
+    for (int i = 0; i < 5; i++) {
+        for (int b = 0; b < 4; b++) {
+            digest[4 * i + b] = (uint8_t)(context->state[i] >> (8 * b));
+        }
+    }
+    memzero(context, sizeof(RIPEMD160_CTX));
+}
+
+void ripemd160_Raw(const uint8_t* data, size_t len, uint8_t digest[RIPEMD160_DIGEST_LENGTH])
+{
+    RIPEMD160_CTX context;
+    ripemd160_Init(&context);
+    ripemd160_Update(&context, data, len);
+    ripemd160_Final(&context, digest);
+}
@@ -0,0 +1,29 @@
+#ifndef __RIPEMD160_H__
+#define __RIPEMD160_H__
+
+#include <cstddef>
+#include <cstdint>
+
+#define RIPEMD160_BLOCK_LENGTH 64
+#define RIPEMD160_DIGEST_LENGTH 20
+
+typedef struct _RIPEMD160_CTX {
+    uint32_t state[5];
+    uint64_t bitcount;
+    uint8_t buffer[RIPEMD160_BLOCK_LENGTH];
+} RIPEMD160_CTX;
+
+extern const uint32_t ripemd160_initial_hash_value[5];
+// Message word order, rotation amounts and round constants of the left [0] and right [1] lines.
+extern const uint8_t RMD160_R[2][80];
+extern const uint8_t RMD160_S[2][80];
+extern const uint32_t RMD160_K[2][5];
+
+// `data` holds the 16 little-endian words of one block. state_out may alias state_in.
+void ripemd160_Transform(const uint32_t* state_in, const uint32_t* data, uint32_t* state_out);
+void ripemd160_Init(RIPEMD160_CTX*);
+void ripemd160_Update(RIPEMD160_CTX*, const uint8_t*, size_t);
+void ripemd160_Final(RIPEMD160_CTX*, uint8_t[RIPEMD160_DIGEST_LENGTH]);
+void ripemd160_Raw(const uint8_t*, size_t, uint8_t[RIPEMD160_DIGEST_LENGTH]);
+
+#endif
@@ -94,6 +94,8 @@ typedef struct _SHA512_CTX {
 
 extern const uint32_t sha256_initial_hash_value[8];
 extern const uint64_t sha512_initial_hash_value[8];
+extern const uint32_t K256[64];
+extern const uint64_t K512[80];
 
 void sha1_Transform(const uint32_t* state_in, const uint32_t* data, uint32_t* state_out);
 void sha1_Init(trezor::SHA1_CTX*);
@@ -0,0 +1,245 @@
+#include "sha256_lanes.h"
+
+#include "memzero.h"
+#include "sha2.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#    define SHA256_LANES_X86 1
+#    include <immintrin.h>
+#endif
+
+#ifdef SHA256_LANES_X86
+
+// Message words are already native integers, so unlike the byte-oriented reference code no
+// shuffle is needed on load. The state is kept as ABEF/CDGH, the order sha256rnds2 expects.
+__attribute__((target("sha,sse4.1"))) static void sha256_transform_shani(
+    const uint32_t* state_in, const uint32_t* data, uint32_t* state_out)
+{
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)state_in), 0xb1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(state_in + 4)), 0x1b);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+    const __m128i abef = state0, cdgh = state1;
+
+    __m128i w[16];
+    for (int i = 0; i < 16; i++) {
+        if (i < 4) {
+            w[i] = _mm_loadu_si128((const __m128i*)(data + 4 * i));
+        } else {
+            w[i] = _mm_add_epi32(
+                _mm_sha256msg1_epu32(w[i - 4], w[i - 3]), _mm_alignr_epi8(w[i - 1], w[i - 2], 4));
+            w[i] = _mm_sha256msg2_epu32(w[i], w[i - 1]);
+        }
+        __m128i msg = _mm_add_epi32(w[i], _mm_loadu_si128((const __m128i*)(K256 + 4 * i)));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0e));
+    }
+
+    state0 = _mm_add_epi32(state0, abef);
+    state1 = _mm_add_epi32(state1, cdgh);
+    tmp = _mm_shuffle_epi32(state0, 0x1b);
+    state1 = _mm_shuffle_epi32(state1, 0xb1);
+    _mm_storeu_si128((__m128i*)state_out, _mm_blend_epi16(tmp, state1, 0xf0));
+    _mm_storeu_si128((__m128i*)(state_out + 4), _mm_alignr_epi8(state1, tmp, 8));
+}
+
+#endif /* SHA256_LANES_X86 */
+
+int sha256_shani_supported(void)
+{
+#ifdef SHA256_LANES_X86
+    static const int supported =
+        __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1");
+    return supported;
+#else
+    return 0;
+#endif
+}
+
+void sha256_Transform_single(const uint32_t* state_in, const uint32_t* data, uint32_t* state_out)
+{
+#ifdef SHA256_LANES_X86
+    if (sha256_shani_supported()) {
+        sha256_transform_shani(state_in, data, state_out);
+        return;
+    }
+#endif
+    sha256_Transform(state_in, data, state_out);
+}
+
+static void sha256_transform_scalar(
+    size_t lanes, const uint32_t* state_in, const uint32_t* data, uint32_t* state_out)
+{
+    uint32_t state[8];
+    uint32_t block[16];
+    for (size_t l = 0; l < lanes; l++) {
+        for (int i = 0; i < 16; i++) {
+            block[i] = data[i * lanes + l];
+        }
+        for (int i = 0; i < 8; i++) {
+            state[i] = state_in[i * lanes + l];
+        }
+        sha256_Transform_single(state, block, state);
+        for (int i = 0; i < 8; i++) {
+            state_out[i * lanes + l] = state[i];
+        }
+    }
+    memzero(block, sizeof(block));
+    memzero(state, sizeof(state));
+}
+
+#ifdef SHA256_LANES_X86
+
+#    define AVX2_ROR32(x, n) \
+        _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+#    define AVX2_XOR3(x, y, z) _mm256_xor_si256(_mm256_xor_si256((x), (y)), (z))
+
+__attribute__((target("avx2"))) static void sha256_transform_avx2(
+    size_t lanes, const uint32_t* state_in, const uint32_t* data, uint32_t* state_out)
+{
+    for (size_t g = 0; g < lanes; g += 8) {
+        __m256i s[8], w[16];
+        for (int i = 0; i < 8; i++) {
+            s[i] = _mm256_loadu_si256((const __m256i*)(state_in + i * lanes + g));
+        }
+        for (int i = 0; i < 16; i++) {
+            w[i] = _mm256_loadu_si256((const __m256i*)(data + i * lanes + g));
+        }
+        __m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], h6 = s[6], h = s[7];
+        for (int j = 0; j < 64; j++) {
+            __m256i wj;
+            if (j < 16) {
+                wj = w[j];
+            } else {
+                __m256i w1 = w[(j + 1) & 15], w14 = w[(j + 14) & 15];
+                __m256i s0 =
+                    AVX2_XOR3(AVX2_ROR32(w1, 7), AVX2_ROR32(w1, 18), _mm256_srli_epi32(w1, 3));
+                __m256i s1 = AVX2_XOR3(
+                    AVX2_ROR32(w14, 17), AVX2_ROR32(w14, 19), _mm256_srli_epi32(w14, 10));
+                wj = _mm256_add_epi32(
+                    _mm256_add_epi32(w[j & 15], s1), _mm256_add_epi32(w[(j + 9) & 15], s0));
+                w[j & 15] = wj;
+            }
+            __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, h6));
+            __m256i maj = _mm256_or_si256(
+                _mm256_and_si256(_mm256_or_si256(a, b), c), _mm256_and_si256(a, b));
+            __m256i t1 = _mm256_add_epi32(
+                _mm256_add_epi32(
+                    h, AVX2_XOR3(AVX2_ROR32(e, 6), AVX2_ROR32(e, 11), AVX2_ROR32(e, 25))),
+                _mm256_add_epi32(_mm256_add_epi32(ch, _mm256_set1_epi32((int)K256[j])), wj));
+            __m256i t2 = _mm256_add_epi32(
+                AVX2_XOR3(AVX2_ROR32(a, 2), AVX2_ROR32(a, 13), AVX2_ROR32(a, 22)), maj);
+            h = h6;
+            h6 = f;
+            f = e;
+            e = _mm256_add_epi32(d, t1);
+            d = c;
+            c = b;
+            b = a;
+            a = _mm256_add_epi32(t1, t2);
+        }
+        __m256i r[8] = {a, b, c, d, e, f, h6, h};
+        for (int i = 0; i < 8; i++) {
+            _mm256_storeu_si256(
+                (__m256i*)(state_out + i * lanes + g), _mm256_add_epi32(s[i], r[i]));
+        }
+    }
+}
+
+#    define AVX512_XOR3(x, y, z) _mm512_ternarylogic_epi32((x), (y), (z), 0x96)
+
+__attribute__((target("avx512f"))) static void sha256_transform_avx512(
+    size_t lanes, const uint32_t* state_in, const uint32_t* data, uint32_t* state_out)
+{
+    for (size_t g = 0; g < lanes; g += 16) {
+        __m512i s[8], w[16];
+        for (int i = 0; i < 8; i++) {
+            s[i] = _mm512_loadu_si512((const void*)(state_in + i * lanes + g));
+        }
+        for (int i = 0; i < 16; i++) {
+            w[i] = _mm512_loadu_si512((const void*)(data + i * lanes + g));
+        }
+        __m512i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], h6 = s[6], h = s[7];
+        for (int j = 0; j < 64; j++) {
+            __m512i wj;
+            if (j < 16) {
+                wj = w[j];
+            } else {
+                __m512i w1 = w[(j + 1) & 15], w14 = w[(j + 14) & 15];
+                __m512i s0 = AVX512_XOR3(
+                    _mm512_ror_epi32(w1, 7), _mm512_ror_epi32(w1, 18), _mm512_srli_epi32(w1, 3));
+                __m512i s1 = AVX512_XOR3(
+                    _mm512_ror_epi32(w14, 17),
+                    _mm512_ror_epi32(w14, 19),
+                    _mm512_srli_epi32(w14, 10));
+                wj = _mm512_add_epi32(
+                    _mm512_add_epi32(w[j & 15], s1), _mm512_add_epi32(w[(j + 9) & 15], s0));
+                w[j & 15] = wj;
+            }
+            // 0xca selects f where e is set and g elsewhere, 0xe8 is the majority function.
+            __m512i ch = _mm512_ternarylogic_epi32(e, f, h6, 0xca);
+            __m512i maj = _mm512_ternarylogic_epi32(a, b, c, 0xe8);
+            __m512i t1 = _mm512_add_epi32(
+                _mm512_add_epi32(
+                    h,
+                    AVX512_XOR3(
+                        _mm512_ror_epi32(e, 6), _mm512_ror_epi32(e, 11), _mm512_ror_epi32(e, 25))),
+                _mm512_add_epi32(_mm512_add_epi32(ch, _mm512_set1_epi32((int)K256[j])), wj));
+            __m512i t2 = _mm512_add_epi32(
+                AVX512_XOR3(
+                    _mm512_ror_epi32(a, 2), _mm512_ror_epi32(a, 13), _mm512_ror_epi32(a, 22)),
+                maj);
+            h = h6;
+            h6 = f;
+            f = e;
+            e = _mm512_add_epi32(d, t1);
+            d = c;
+            c = b;
+            b = a;
+            a = _mm512_add_epi32(t1, t2);
+        }
+        __m512i r[8] = {a, b, c, d, e, f, h6, h};
+        for (int i = 0; i < 8; i++) {
+            _mm512_storeu_si512((void*)(state_out + i * lanes + g), _mm512_add_epi32(s[i], r[i]));
+        }
+    }
+}
+
+#endif /* SHA256_LANES_X86 */
+
+size_t sha256_kernel_width(sha512_kernel kernel)
+{
+    switch (kernel) {
+    case SHA512_KERNEL_AVX2:
+        return 8;
+    case SHA512_KERNEL_AVX512:
+        return 16;
+    default:
+        return 1;
+    }
+}
+
+void sha256_Transform_lanes(
+    sha512_kernel kernel,
+    size_t lanes,
+    const uint32_t* state_in,
+    const uint32_t* data,
+    uint32_t* state_out)
+{
+    if (!sha512_kernel_supported(kernel)) {
+        kernel = SHA512_KERNEL_SCALAR;
+    }
+    switch (kernel) {
+#ifdef SHA256_LANES_X86
+    case SHA512_KERNEL_AVX2:
+        sha256_transform_avx2(lanes, state_in, data, state_out);
+        return;
+    case SHA512_KERNEL_AVX512:
+        sha256_transform_avx512(lanes, state_in, data, state_out);
+        return;
+#endif
+    default:
+        sha256_transform_scalar(lanes, state_in, data, state_out);
+        return;
+    }
+}
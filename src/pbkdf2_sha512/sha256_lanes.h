@@ -0,0 +1,36 @@
+#ifndef __SHA256_LANES_H__
+#define __SHA256_LANES_H__
+
+#include "sha512_lanes.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Upper bound on the number of independent streams hashed by one call.
+#define SHA256_MAX_LANES 32
+
+// Lanes one vector of the kernel holds: 1, or 8 and 16 32-bit lanes for AVX2 and AVX-512.
+// Kernel selection, support and the kill switch are shared with the SHA-512 lanes.
+size_t sha256_kernel_width(sha512_kernel kernel);
+
+// Non-zero if the CPU has the SHA extensions (SHA-NI).
+int sha256_shani_supported(void);
+
+// sha256_Transform, on the SHA extensions when the CPU has them.
+void sha256_Transform_single(const uint32_t* state_in, const uint32_t* data, uint32_t* state_out);
+
+/*
+ * Runs sha256_Transform on `lanes` independent streams at once, with the buffer layout of
+ * sha512_Transform_lanes: word i of lane l at [i * lanes + l]. `lanes` must be a multiple of
+ * sha256_kernel_width() and at most SHA256_MAX_LANES. The scalar kernel hashes one stream
+ * at a time with sha256_Transform_single. state_out may alias state_in or the first
+ * 8 * lanes words of data.
+ */
+void sha256_Transform_lanes(
+    sha512_kernel kernel,
+    size_t lanes,
+    const uint32_t* state_in,
+    const uint32_t* data,
+    uint32_t* state_out);
+
+#endif
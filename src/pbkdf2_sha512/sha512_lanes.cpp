@@ -0,0 +1,252 @@
+#include "sha512_lanes.h"
+
+#include "memzero.h"
+#include "sha2.hpp"
+
+#include <atomic>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#    define SHA512_LANES_X86 1
+#    include <immintrin.h>
+#endif
+
+static void sha512_transform_scalar(
+    size_t lanes, const uint64_t* state_in, const uint64_t* data, uint64_t* state_out)
+{
+    uint64_t state[8];
+    uint64_t block[16];
+    for (size_t l = 0; l < lanes; l++) {
+        for (int i = 0; i < 16; i++) {
+            block[i] = data[i * lanes + l];
+        }
+        for (int i = 0; i < 8; i++) {
+            state[i] = state_in[i * lanes + l];
+        }
+        sha512_Transform(state, block, state);
+        for (int i = 0; i < 8; i++) {
+            state_out[i * lanes + l] = state[i];
+        }
+    }
+    memzero(block, sizeof(block));
+    memzero(state, sizeof(state));
+}
+
+#ifdef SHA512_LANES_X86
+
+#    define AVX2_ROR(x, n) \
+        _mm256_or_si256(_mm256_srli_epi64((x), (n)), _mm256_slli_epi64((x), 64 - (n)))
+#    define AVX2_XOR3(x, y, z) _mm256_xor_si256(_mm256_xor_si256((x), (y)), (z))
+
+__attribute__((target("avx2"))) static void sha512_transform_avx2(
+    size_t lanes, const uint64_t* state_in, const uint64_t* data, uint64_t* state_out)
+{
+    for (size_t g = 0; g < lanes; g += 4) {
+        __m256i s[8], w[16];
+        for (int i = 0; i < 8; i++) {
+            s[i] = _mm256_loadu_si256((const __m256i*)(state_in + i * lanes + g));
+        }
+        for (int i = 0; i < 16; i++) {
+            w[i] = _mm256_loadu_si256((const __m256i*)(data + i * lanes + g));
+        }
+        __m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], h6 = s[6], h = s[7];
+        for (int j = 0; j < 80; j++) {
+            __m256i wj;
+            if (j < 16) {
+                wj = w[j];
+            } else {
+                __m256i w1 = w[(j + 1) & 15], w14 = w[(j + 14) & 15];
+                __m256i s0 = AVX2_XOR3(AVX2_ROR(w1, 1), AVX2_ROR(w1, 8), _mm256_srli_epi64(w1, 7));
+                __m256i s1 = AVX2_XOR3(
+                    AVX2_ROR(w14, 19), AVX2_ROR(w14, 61), _mm256_srli_epi64(w14, 6));
+                wj = _mm256_add_epi64(
+                    _mm256_add_epi64(w[j & 15], s1), _mm256_add_epi64(w[(j + 9) & 15], s0));
+                w[j & 15] = wj;
+            }
+            __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, h6));
+            __m256i maj = _mm256_or_si256(
+                _mm256_and_si256(_mm256_or_si256(a, b), c), _mm256_and_si256(a, b));
+            __m256i t1 = _mm256_add_epi64(
+                _mm256_add_epi64(h, AVX2_XOR3(AVX2_ROR(e, 14), AVX2_ROR(e, 18), AVX2_ROR(e, 41))),
+                _mm256_add_epi64(
+                    _mm256_add_epi64(ch, _mm256_set1_epi64x((long long)K512[j])), wj));
+            __m256i t2 = _mm256_add_epi64(
+                AVX2_XOR3(AVX2_ROR(a, 28), AVX2_ROR(a, 34), AVX2_ROR(a, 39)), maj);
+            h = h6;
+            h6 = f;
+            f = e;
+            e = _mm256_add_epi64(d, t1);
+            d = c;
+            c = b;
+            b = a;
+            a = _mm256_add_epi64(t1, t2);
+        }
+        __m256i r[8] = {a, b, c, d, e, f, h6, h};
+        for (int i = 0; i < 8; i++) {
+            _mm256_storeu_si256(
+                (__m256i*)(state_out + i * lanes + g), _mm256_add_epi64(s[i], r[i]));
+        }
+    }
+}
+
+#    define AVX512_XOR3(x, y, z) _mm512_ternarylogic_epi64((x), (y), (z), 0x96)
+
+__attribute__((target("avx512f"))) static void sha512_transform_avx512(
+    size_t lanes, const uint64_t* state_in, const uint64_t* data, uint64_t* state_out)
+{
+    for (size_t g = 0; g < lanes; g += 8) {
+        __m512i s[8], w[16];
+        for (int i = 0; i < 8; i++) {
+            s[i] = _mm512_loadu_si512((const void*)(state_in + i * lanes + g));
+        }
+        for (int i = 0; i < 16; i++) {
+            w[i] = _mm512_loadu_si512((const void*)(data + i * lanes + g));
+        }
+        __m512i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], h6 = s[6], h = s[7];
+        for (int j = 0; j < 80; j++) {
+            __m512i wj;
+            if (j < 16) {
+                wj = w[j];
+            } else {
+                __m512i w1 = w[(j + 1) & 15], w14 = w[(j + 14) & 15];
+                __m512i s0 = AVX512_XOR3(
+                    _mm512_ror_epi64(w1, 1), _mm512_ror_epi64(w1, 8), _mm512_srli_epi64(w1, 7));
+                __m512i s1 = AVX512_XOR3(
+                    _mm512_ror_epi64(w14, 19),
+                    _mm512_ror_epi64(w14, 61),
+                    _mm512_srli_epi64(w14, 6));
+                wj = _mm512_add_epi64(
+                    _mm512_add_epi64(w[j & 15], s1), _mm512_add_epi64(w[(j + 9) & 15], s0));
+                w[j & 15] = wj;
+            }
+            // 0xca selects f where e is set and g elsewhere, 0xe8 is the majority function.
+            __m512i ch = _mm512_ternarylogic_epi64(e, f, h6, 0xca);
+            __m512i maj = _mm512_ternarylogic_epi64(a, b, c, 0xe8);
+            __m512i t1 = _mm512_add_epi64(
+                _mm512_add_epi64(
+                    h,
+                    AVX512_XOR3(
+                        _mm512_ror_epi64(e, 14), _mm512_ror_epi64(e, 18), _mm512_ror_epi64(e, 41))),
+                _mm512_add_epi64(_mm512_add_epi64(ch, _mm512_set1_epi64((long long)K512[j])), wj));
+            __m512i t2 = _mm512_add_epi64(
+                AVX512_XOR3(
+                    _mm512_ror_epi64(a, 28), _mm512_ror_epi64(a, 34), _mm512_ror_epi64(a, 39)),
+                maj);
+            h = h6;
+            h6 = f;
+            f = e;
+            e = _mm512_add_epi64(d, t1);
+            d = c;
+            c = b;
+            b = a;
+            a = _mm512_add_epi64(t1, t2);
+        }
+        __m512i r[8] = {a, b, c, d, e, f, h6, h};
+        for (int i = 0; i < 8; i++) {
+            _mm512_storeu_si512((void*)(state_out + i * lanes + g), _mm512_add_epi64(s[i], r[i]));
+        }
+    }
+}
+
+#endif /* SHA512_LANES_X86 */
+
+static std::atomic<unsigned> sha512_kernels_disabled{0};
+
+static int sha512_kernel_disabled(sha512_kernel kernel)
+{
+    return (sha512_kernels_disabled.load(std::memory_order_relaxed) >> kernel) & 1;
+}
+
+void sha512_kernel_disable(sha512_kernel kernel)
+{
+    if (kernel != SHA512_KERNEL_SCALAR && kernel < SHA512_KERNEL_COUNT) {
+        sha512_kernels_disabled.fetch_or(1u << kernel);
+    }
+}
+
+void sha512_kernel_enable(sha512_kernel kernel)
+{
+    if (kernel < SHA512_KERNEL_COUNT) {
+        sha512_kernels_disabled.fetch_and(~(1u << kernel));
+    }
+}
+
+const char* sha512_kernel_name(sha512_kernel kernel)
+{
+    switch (kernel) {
+    case SHA512_KERNEL_SCALAR:
+        return "scalar";
+    case SHA512_KERNEL_AVX2:
+        return "avx2";
+    case SHA512_KERNEL_AVX512:
+        return "avx512";
+    default:
+        return "unknown";
+    }
+}
+
+size_t sha512_kernel_width(sha512_kernel kernel)
+{
+    switch (kernel) {
+    case SHA512_KERNEL_AVX2:
+        return 4;
+    case SHA512_KERNEL_AVX512:
+        return 8;
+    default:
+        return 1;
+    }
+}
+
+int sha512_kernel_supported(sha512_kernel kernel)
+{
+    if (sha512_kernel_disabled(kernel)) {
+        return 0;
+    }
+    switch (kernel) {
+    case SHA512_KERNEL_SCALAR:
+        return 1;
+#ifdef SHA512_LANES_X86
+    case SHA512_KERNEL_AVX2:
+        return __builtin_cpu_supports("avx2");
+    case SHA512_KERNEL_AVX512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+        return 0;
+    }
+}
+
+sha512_kernel sha512_kernel_default(void)
+{
+    if (sha512_kernel_supported(SHA512_KERNEL_AVX512)) {
+        return SHA512_KERNEL_AVX512;
+    }
+    if (sha512_kernel_supported(SHA512_KERNEL_AVX2)) {
+        return SHA512_KERNEL_AVX2;
+    }
+    return SHA512_KERNEL_SCALAR;
+}
+
+void sha512_Transform_lanes(
+    sha512_kernel kernel,
+    size_t lanes,
+    const uint64_t* state_in,
+    const uint64_t* data,
+    uint64_t* state_out)
+{
+    if (sha512_kernel_disabled(kernel)) {
+        kernel = SHA512_KERNEL_SCALAR;
+    }
+    switch (kernel) {
+#ifdef SHA512_LANES_X86
+    case SHA512_KERNEL_AVX2:
+        sha512_transform_avx2(lanes, state_in, data, state_out);
+        return;
+    case SHA512_KERNEL_AVX512:
+        sha512_transform_avx512(lanes, state_in, data, state_out);
+        return;
+#endif
+    default:
+        sha512_transform_scalar(lanes, state_in, data, state_out);
+        return;
+    }
+}
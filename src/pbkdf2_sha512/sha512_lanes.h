@@ -0,0 +1,48 @@
+#ifndef __SHA512_LANES_H__
+#define __SHA512_LANES_H__
+
+#include <cstddef>
+#include <cstdint>
+
+// Upper bound on the number of independent streams hashed by one call.
+#define SHA512_MAX_LANES 16
+
+typedef enum _sha512_kernel {
+    SHA512_KERNEL_SCALAR = 0,
+    SHA512_KERNEL_AVX2 = 1,
+    SHA512_KERNEL_AVX512 = 2,
+    SHA512_KERNEL_COUNT
+} sha512_kernel;
+
+const char* sha512_kernel_name(sha512_kernel kernel);
+
+// Number of lanes one vector of the kernel holds (1, 4 or 8).
+size_t sha512_kernel_width(sha512_kernel kernel);
+
+// Non-zero if the kernel was compiled in, the running CPU supports it and it was not disabled.
+int sha512_kernel_supported(sha512_kernel kernel);
+
+// Process-wide kill switch: calls for a disabled kernel run the scalar reference instead.
+void sha512_kernel_disable(sha512_kernel kernel);
+void sha512_kernel_enable(sha512_kernel kernel);
+
+// Widest supported kernel.
+sha512_kernel sha512_kernel_default(void);
+
+/*
+ * Runs sha512_Transform on `lanes` independent streams at once.
+ *
+ * Buffers are word-interleaved: word i of lane l is stored at [i * lanes + l],
+ * so state_in/state_out hold 8 * lanes words and data holds 16 * lanes words.
+ * `lanes` must be a multiple of sha512_kernel_width() and at most
+ * SHA512_MAX_LANES. state_out may alias state_in or the first 8 * lanes words
+ * of data.
+ */
+void sha512_Transform_lanes(
+    sha512_kernel kernel,
+    size_t lanes,
+    const uint64_t* state_in,
+    const uint64_t* data,
+    uint64_t* state_out);
+
+#endif
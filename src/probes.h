@@ -0,0 +1,35 @@
+#ifndef PROBES_H
+#define PROBES_H
+
+/*
+ * USDT (sys/sdt.h) probes under the "bip39" provider, e.g.
+ *   bpftrace -e 'usdt:./app:bip39:generate_seed__entry { ... }'
+ *
+ * A probe compiles to a single nop plus an ELF note, so it costs nothing until a tracer
+ * attaches. Arguments are still evaluated, so only pass values that are already at hand.
+ * Without <sys/sdt.h>, or when built with BIP39_NO_USDT, the macros expand to nothing.
+ */
+#if !defined(BIP39_NO_USDT) && defined(__has_include)
+#    if __has_include(<sys/sdt.h>)
+#        include <sys/sdt.h>
+#        define BIP39_HAVE_USDT 1
+#    endif
+#endif
+
+#ifdef BIP39_HAVE_USDT
+#    define BIP39_PROBE(name) DTRACE_PROBE(bip39, name)
+#    define BIP39_PROBE1(name, a) DTRACE_PROBE1(bip39, name, a)
+#    define BIP39_PROBE2(name, a, b) DTRACE_PROBE2(bip39, name, a, b)
+#    define BIP39_PROBE3(name, a, b, c) DTRACE_PROBE3(bip39, name, a, b, c)
+#    define BIP39_PROBE4(name, a, b, c, d) DTRACE_PROBE4(bip39, name, a, b, c, d)
+#else
+#    define BIP39_PROBE(name) \
+        do {                  \
+        } while (0)
+#    define BIP39_PROBE1(name, a) BIP39_PROBE(name)
+#    define BIP39_PROBE2(name, a, b) BIP39_PROBE(name)
+#    define BIP39_PROBE3(name, a, b, c) BIP39_PROBE(name)
+#    define BIP39_PROBE4(name, a, b, c, d) BIP39_PROBE(name)
+#endif
+
+#endif // PROBES_H
@@ -0,0 +1,170 @@
+#include "recovery.h"
+#include "bip39.h"
+#include "pbkdf2_sha512/sha2.hpp"
+#include "utils.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace
+{
+constexpr size_t WORDLIST_SIZE = 2048;
+}    // namespace
+
+RecoveryEnumerator::RecoveryEnumerator(std::vector<std::vector<uint16_t>> candidates)
+    : m_candidates(std::move(candidates)), m_wordCount(m_candidates.size())
+{
+    if (m_wordCount < 12 || m_wordCount > 24 || m_wordCount % 3 != 0)
+        throw MnemonicException("Invalid word count");
+    for (auto& c : m_candidates) {
+        std::sort(c.begin(), c.end());
+        c.erase(std::unique(c.begin(), c.end()), c.end());
+        if (c.empty() || c.back() >= WORDLIST_SIZE)
+            throw MnemonicException("Invalid word candidates");
+    }
+    m_checksumBits = m_wordCount / 3;
+    m_entropyLength = m_wordCount * 4 / 3;
+
+    for (size_t p = 0; p + 1 < m_wordCount; p++) {
+        const uint64_t radix = m_candidates[p].size();
+        if (radix == 1)
+            continue;
+        if (m_size > UINT64_MAX / radix)
+            throw MnemonicException("Search space too large");
+        m_size *= radix;
+        m_order.push_back(p);
+    }
+    std::stable_sort(m_order.begin(), m_order.end(), [this](size_t a, size_t b) {
+        return m_candidates[a].size() > m_candidates[b].size();
+    });
+
+    m_lastAllowed.assign(WORDLIST_SIZE, false);
+    for (uint16_t w : m_candidates.back()) {
+        m_lastAllowed[w] = true;
+        const uint16_t prefix = (uint16_t)(w >> m_checksumBits);
+        if (m_lastPrefixes.empty() || m_lastPrefixes.back() != prefix)
+            m_lastPrefixes.push_back(prefix);
+    }
+}
+
+std::vector<std::vector<uint16_t>> RecoveryEnumerator::parsePattern(
+    const std::string& pattern, Wordlist* wordlist)
+{
+    if (wordlist == nullptr || wordlist->empty())
+        throw MnemonicException("Invalid wordlist");
+    std::vector<std::vector<uint16_t>> result;
+    std::istringstream tokens(pattern);
+    for (std::string token; tokens >> token;) {
+        std::vector<uint16_t> set;
+        if (token == "?") {
+            for (size_t i = 0; i < WORDLIST_SIZE; i++) {
+                set.push_back((uint16_t)i);
+            }
+        } else if (token.back() == '*') {
+            const std::string prefix = token.substr(0, token.size() - 1);
+            for (size_t i = 0; i < WORDLIST_SIZE; i++) {
+                if (wordlist->getWord((int)i).compare(0, prefix.size(), prefix) == 0)
+                    set.push_back((uint16_t)i);
+            }
+        } else {
+            std::istringstream words(token);
+            for (std::string word; std::getline(words, word, '|');) {
+                const int index = wordlist->findIndexCT(word);
+                if (index < 0)
+                    throw MnemonicException("Word not in wordlist: " + word);
+                set.push_back((uint16_t)index);
+            }
+        }
+        if (set.empty())
+            throw MnemonicException("No word matches " + token);
+        result.push_back(std::move(set));
+    }
+    return result;
+}
+
+double RecoveryEnumerator::expectedMatches() const noexcept
+{
+    return (double)m_size * (double)m_candidates.back().size() / (double)(1u << m_checksumBits);
+}
+
+std::pair<uint64_t, uint64_t> RecoveryEnumerator::range(uint64_t part, uint64_t parts) const
+{
+    if (parts == 0 || part >= parts)
+        throw MnemonicException("Invalid range");
+    auto bound = [&](uint64_t i) {
+        return (uint64_t)((unsigned __int128)m_size * i / parts);
+    };
+    return {bound(part), bound(part + 1)};
+}
+
+uint64_t RecoveryEnumerator::enumerate(uint64_t begin, uint64_t end, const Visit& visit) const
+{
+    end = std::min(end, m_size);
+    if (begin >= end)
+        return 0;
+    const size_t digits = m_order.size();
+    const size_t last = m_wordCount - 1;
+
+    // SHA-256 block of the entropy: checksum bits are never stored, only the padding follows
+    uint32_t block[16] = {};
+    block[m_entropyLength / 4] = 0x80000000;
+    block[15] = (uint32_t)(m_entropyLength * 8);
+    uint16_t words[24];
+    for (size_t p = 0; p < last; p++) {
+        words[p] = m_candidates[p][0];
+    }
+
+    // Gray digits of step `begin`: digit d sweeps its candidates up and down, reversing each
+    // time a slower digit moves
+    std::vector<uint64_t> sweep(digits);
+    std::vector<uint8_t> up(digits);
+    std::vector<size_t> value(digits);
+    uint64_t below = 1;
+    for (size_t d = 0; d < digits; d++) {
+        const uint64_t radix = m_candidates[m_order[d]].size();
+        const uint64_t q = begin / below;
+        sweep[d] = q % radix;
+        up[d] = (q / radix) % 2 == 0;
+        value[d] = up[d] ? sweep[d] : radix - 1 - sweep[d];
+        words[m_order[d]] = m_candidates[m_order[d]][value[d]];
+        below *= radix;
+    }
+    for (size_t p = 0; p < last; p++) {
+        BIP39_Utils::writeBits(block, p * 11, words[p]);
+    }
+
+    uint8_t entropy[32];
+    uint32_t state[8];
+    const size_t prefixBits = 11 - m_checksumBits;
+    uint64_t found = 0;
+    for (uint64_t step = begin;;) {
+        for (uint16_t prefix : m_lastPrefixes) {
+            BIP39_Utils::writeBits(block, last * 11, prefix, prefixBits);
+            sha256_Transform(sha256_initial_hash_value, block, state);
+            const uint16_t word =
+                (uint16_t)(prefix << m_checksumBits | state[0] >> (32 - m_checksumBits));
+            if (!m_lastAllowed[word])
+                continue;
+            words[last] = word;
+            for (size_t i = 0; i < m_entropyLength; i++) {
+                entropy[i] = (uint8_t)(block[i / 4] >> (24 - 8 * (i % 4)));
+            }
+            visit(words, entropy);
+            found++;
+        }
+        if (++step == end)
+            break;
+        size_t d = 0;
+        while (sweep[d] == m_candidates[m_order[d]].size() - 1) {
+            sweep[d] = 0;
+            up[d] ^= 1;
+            d++;
+        }
+        sweep[d]++;
+        value[d] = up[d] ? value[d] + 1 : value[d] - 1;
+        const size_t p = m_order[d];
+        words[p] = m_candidates[p][value[d]];
+        BIP39_Utils::writeBits(block, p * 11, words[p]);
+    }
+    return found;
+}
@@ -0,0 +1,67 @@
+#ifndef RECOVERY_H
+#define RECOVERY_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "wordlist.h"
+
+/*
+ * Enumerates the mnemonics allowed by per-position word candidates, visiting only those with
+ * a valid checksum.
+ *
+ * Positions with one candidate are fixed. The others, except the last word, form a
+ * mixed-radix counter walked in reflected Gray-code order, largest candidate sets changing
+ * fastest, so each step rewrites the 11 bits of a single word in the packed entropy. The
+ * last word is not enumerated: for each of its distinct entropy bit prefixes one SHA-256
+ * gives the checksum and so the only word that can complete the phrase, which is kept if it
+ * is a candidate. Steps are numbered 0..size()-1 and any range of them can be enumerated on
+ * its own, for threads or shards.
+ */
+class RecoveryEnumerator
+{
+public:
+    // Word indices and packed entropy (entropyLength() bytes) of a checksum-valid candidate.
+    using Visit = std::function<void(const uint16_t* words, const uint8_t* entropy)>;
+
+    // candidates[p]: wordlist indices allowed at position p, for 12, 15, 18, 21 or 24 words.
+    explicit RecoveryEnumerator(std::vector<std::vector<uint16_t>> candidates);
+
+    /*
+     * One token per position, separated by spaces: a word, "?" for any word, "pr*" for the
+     * words starting with "pr", or "one|two|three" for a set. Throws MnemonicException on
+     * words missing from the wordlist or patterns that match nothing.
+     */
+    static std::vector<std::vector<uint16_t>> parsePattern(
+        const std::string& pattern, Wordlist* wordlist = Wordlist::english());
+
+    size_t wordCount() const noexcept { return m_wordCount; }
+    size_t entropyLength() const noexcept { return m_entropyLength; }
+
+    // Number of steps: the product of the enumerated positions' candidate counts.
+    uint64_t size() const noexcept { return m_size; }
+
+    // Expected visits over all steps, before duplicates in the last word's prefixes.
+    double expectedMatches() const noexcept;
+
+    // Contiguous step range `part` of `parts`, for threads or shards.
+    std::pair<uint64_t, uint64_t> range(uint64_t part, uint64_t parts) const;
+
+    // Visits the checksum-valid candidates of steps [begin, end); returns how many.
+    uint64_t enumerate(uint64_t begin, uint64_t end, const Visit& visit) const;
+
+private:
+    std::vector<std::vector<uint16_t>> m_candidates;
+    std::vector<size_t> m_order;           // enumerated positions, fastest changing first
+    std::vector<uint16_t> m_lastPrefixes;  // distinct entropy prefixes of the last word
+    std::vector<bool> m_lastAllowed;       // 2048 flags: candidates of the last word
+    size_t m_wordCount;
+    size_t m_entropyLength;
+    size_t m_checksumBits;
+    uint64_t m_size{1};
+};
+
+#endif // RECOVERY_H
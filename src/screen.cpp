@@ -0,0 +1,379 @@
+#include "screen.h"
+#include "bip39.h"
+#include "fingerprint.h"
+#include "mnemonic.h"
+#include "pbkdf2_sha512/memzero.h"
+#include "pbkdf2_sha512/sha2.hpp"
+#include "utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#ifndef _WIN32
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace
+{
+const char MAGIC[4] = {'B', 'S', 'C', 'R'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr int MAX_SEED_ATTEMPTS = 100;
+
+struct Record
+{
+    uint64_t hash;
+    uint8_t length;
+    uint8_t reserved[7];
+    uint8_t entropy[32];
+};
+static_assert(sizeof(Record) == 48, "screen records are 48 bytes");
+
+std::atomic<const MnemonicScreen*> installedScreen{nullptr};
+
+// records store the unkeyed fingerprint, so its definition is part of the file format
+uint64_t entropyHash(const uint8_t* entropy, size_t length)
+{
+    return MnemonicFingerprint::hash64(entropy, length);
+}
+
+uint64_t mix64(uint64_t x)
+{
+    return MnemonicFingerprint::mix64(x);
+}
+
+bool validLength(size_t length)
+{
+    return length >= 16 && length <= 32 && length % 4 == 0;
+}
+
+uint32_t reduce(uint32_t hash, uint64_t n)
+{
+    return (uint32_t)(((uint64_t)hash * n) >> 32);
+}
+
+uint8_t fingerprint(uint64_t hash)
+{
+    return (uint8_t)(hash ^ (hash >> 32));
+}
+
+// The three slots of a filter hash, one in each third of the table.
+void slots(uint64_t hash, uint64_t blockLength, uint64_t out[3])
+{
+    const uint64_t r1 = (hash << 21) | (hash >> 43);
+    const uint64_t r2 = (hash << 42) | (hash >> 22);
+    out[0] = reduce((uint32_t)hash, blockLength);
+    out[1] = reduce((uint32_t)r1, blockLength) + blockLength;
+    out[2] = reduce((uint32_t)r2, blockLength) + 2 * blockLength;
+}
+
+// Peels the 3-hypergraph of `keys`; fills `fp` and returns false when `seed` does not work.
+bool buildFilter(
+    const std::vector<uint64_t>& keys,
+    uint64_t seed,
+    uint64_t blockLength,
+    std::vector<uint8_t>& fp)
+{
+    const uint64_t capacity = 3 * blockLength;
+    std::vector<uint32_t> count(capacity, 0);
+    std::vector<uint64_t> xorKeys(capacity, 0);
+    uint64_t s[3];
+    for (uint64_t key : keys) {
+        slots(mix64(key + seed), blockLength, s);
+        for (uint64_t i : s) {
+            ++count[i];
+            xorKeys[i] ^= key;
+        }
+    }
+
+    std::vector<uint64_t> queue;
+    for (uint64_t i = 0; i < capacity; i++) {
+        if (count[i] == 1)
+            queue.push_back(i);
+    }
+    std::vector<std::pair<uint64_t, uint64_t>> stack;    // key, slot it owns
+    stack.reserve(keys.size());
+    while (!queue.empty()) {
+        const uint64_t slot = queue.back();
+        queue.pop_back();
+        if (count[slot] != 1)
+            continue;
+        const uint64_t key = xorKeys[slot];
+        stack.emplace_back(key, slot);
+        slots(mix64(key + seed), blockLength, s);
+        for (uint64_t i : s) {
+            xorKeys[i] ^= key;
+            if (--count[i] == 1)
+                queue.push_back(i);
+        }
+    }
+    if (stack.size() != keys.size())
+        return false;
+
+    fp.assign(capacity, 0);
+    for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+        const uint64_t hash = mix64(it->first + seed);
+        slots(hash, blockLength, s);
+        fp[it->second] = 0;
+        fp[it->second] = fingerprint(hash) ^ fp[s[0]] ^ fp[s[1]] ^ fp[s[2]];
+    }
+    return true;
+}
+
+bool recordLess(const Record& a, const Record& b)
+{
+    if (a.hash != b.hash)
+        return a.hash < b.hash;
+    if (a.length != b.length)
+        return a.length < b.length;
+    return memcmp(a.entropy, b.entropy, sizeof(a.entropy)) < 0;
+}
+
+bool recordEqual(const Record& a, const Record& b)
+{
+    return a.hash == b.hash && a.length == b.length &&
+           memcmp(a.entropy, b.entropy, sizeof(a.entropy)) == 0;
+}
+}    // namespace
+
+struct MnemonicScreen::Header
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t recordSize;
+    uint64_t seed;
+    uint64_t count;
+    uint64_t blockLength;
+    uint64_t filterOffset;
+    uint64_t recordsOffset;
+    uint64_t fileSize;
+};
+
+size_t MnemonicScreen::build(const std::vector<std::string>& entropies, const std::string& path)
+{
+    std::vector<Record> records;
+    records.reserve(entropies.size());
+    for (const auto& e : entropies) {
+        if (!validLength(e.size()))
+            throw MnemonicException("Invalid screening entropy length");
+        Record r{};
+        r.length = (uint8_t)e.size();
+        memcpy(r.entropy, e.data(), e.size());
+        r.hash = entropyHash(r.entropy, r.length);
+        records.push_back(r);
+    }
+    std::sort(records.begin(), records.end(), recordLess);
+    records.erase(std::unique(records.begin(), records.end(), recordEqual), records.end());
+
+    std::vector<uint64_t> keys;
+    keys.reserve(records.size());
+    for (const auto& r : records) {
+        if (keys.empty() || keys.back() != r.hash)
+            keys.push_back(r.hash);
+    }
+
+    Header h{};
+    memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.byteOrder = BYTE_ORDER_MARK;
+    h.recordSize = sizeof(Record);
+    h.count = records.size();
+    h.blockLength = (32 + keys.size() * 123 / 100) / 3 + 1;
+    std::vector<uint8_t> fp;
+    std::mt19937_64 seeds(keys.size());
+    int attempt = 0;
+    do {
+        if (++attempt > MAX_SEED_ATTEMPTS)
+            throw MnemonicException("Failed to build screening filter");
+        h.seed = seeds();
+    } while (!buildFilter(keys, h.seed, h.blockLength, fp));
+    h.filterOffset = sizeof(Header);
+    h.recordsOffset = (h.filterOffset + fp.size() + 7) / 8 * 8;
+    h.fileSize = h.recordsOffset + records.size() * sizeof(Record);
+
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        const char padding[8] = {};
+        file.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        file.write(reinterpret_cast<const char*>(fp.data()), fp.size());
+        file.write(padding, h.recordsOffset - h.filterOffset - fp.size());
+        file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+        if (!file)
+            throw MnemonicException("Failed to write screening file: " + tmp);
+    }
+    for (auto& r : records) {
+        memzero(r.entropy, sizeof(r.entropy));
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw MnemonicException("Failed to write screening file: " + path);
+    }
+    return h.count;
+}
+
+size_t MnemonicScreen::buildFromList(const std::string& listPath, const std::string& path)
+{
+    std::ifstream list(listPath);
+    if (!list)
+        throw MnemonicException("Failed to read screening list: " + listPath);
+    std::vector<std::string> entropies;
+    std::string line;
+    while (std::getline(list, line)) {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' '))
+            line.pop_back();
+        if (line.empty() || line[0] == '#')
+            continue;
+        if (BIP39::validateEntropy(line)) {
+            entropies.emplace_back(BIP39_Utils::base16Decode(line));
+            continue;
+        }
+        std::istringstream split(line);
+        std::vector<std::string> words;
+        for (std::string w; split >> w;) {
+            words.push_back(w);
+        }
+        const bool known = std::all_of(words.begin(), words.end(), [](const std::string& w) {
+            return Wordlist::english()->findIndexCT(w) >= 0;
+        });
+        if (!known)
+            continue;
+        try {
+            // reverse() rather than Words(): an installed screen must not filter its own input
+            const Mnemonic m = BIP39(words.size()).wordList(Wordlist::english()).reverse(words);
+            entropies.emplace_back(BIP39_Utils::base16Decode(m.entropy));
+        } catch (const MnemonicException&) {
+        }
+    }
+    return build(entropies, path);
+}
+
+MnemonicScreen::MnemonicScreen(const std::string& path)
+{
+#ifndef _WIN32
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw MnemonicException("Failed to open screening file: " + path);
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* map = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            // filter probes are random; the default readahead would only waste page cache
+            posix_madvise(map, (size_t)st.st_size, POSIX_MADV_RANDOM);
+            m_data = static_cast<const uint8_t*>(map);
+            m_size = (size_t)st.st_size;
+        }
+    }
+    ::close(fd);
+#else
+    std::ifstream file(path, std::ios::binary);
+    m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#endif
+    const Header* h = header();
+    const bool valid = m_data && m_size >= sizeof(Header) &&
+                       memcmp(h->magic, MAGIC, sizeof(MAGIC)) == 0 && h->version == VERSION &&
+                       h->byteOrder == BYTE_ORDER_MARK && h->recordSize == sizeof(Record) &&
+                       h->fileSize == m_size && h->blockLength > 0 && h->blockLength < m_size &&
+                       h->count < m_size &&
+                       h->filterOffset + 3 * h->blockLength <= h->recordsOffset &&
+                       h->recordsOffset + h->count * sizeof(Record) == m_size &&
+                       h->recordsOffset % 8 == 0;
+    if (!valid) {
+#ifndef _WIN32
+        if (m_data)
+            munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+        throw MnemonicException("Invalid screening file: " + path);
+    }
+}
+
+MnemonicScreen::~MnemonicScreen()
+{
+#ifndef _WIN32
+    if (m_data)
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+}
+
+const MnemonicScreen::Header* MnemonicScreen::header() const noexcept
+{
+    return reinterpret_cast<const Header*>(m_data);
+}
+
+const uint8_t* MnemonicScreen::fingerprints() const noexcept
+{
+    return m_data + header()->filterOffset;
+}
+
+const uint8_t* MnemonicScreen::records() const noexcept
+{
+    return m_data + header()->recordsOffset;
+}
+
+size_t MnemonicScreen::size() const noexcept
+{
+    return header()->count;
+}
+
+void MnemonicScreen::digest(uint8_t out[32]) const noexcept
+{
+    sha256_Raw(m_data, m_size, out);
+}
+
+bool MnemonicScreen::mayContain(const uint8_t* entropy, size_t length) const noexcept
+{
+    if (!validLength(length))
+        return false;
+    const Header* h = header();
+    const uint64_t hash = mix64(entropyHash(entropy, length) + h->seed);
+    uint64_t s[3];
+    slots(hash, h->blockLength, s);
+    const uint8_t* fp = fingerprints();
+    return fingerprint(hash) == (fp[s[0]] ^ fp[s[1]] ^ fp[s[2]]);
+}
+
+bool MnemonicScreen::contains(const uint8_t* entropy, size_t length) const noexcept
+{
+    if (!mayContain(entropy, length))
+        return false;
+    Record key{};
+    key.hash = entropyHash(entropy, length);
+    key.length = (uint8_t)length;
+    memcpy(key.entropy, entropy, length);
+    const Record* first = reinterpret_cast<const Record*>(records());
+    const Record* last = first + header()->count;
+    const Record* it = std::lower_bound(first, last, key, recordLess);
+    const bool found = it != last && recordEqual(*it, key);
+    memzero(key.entropy, sizeof(key.entropy));
+    return found;
+}
+
+bool MnemonicScreen::contains(const Mnemonic& mnemonic) const
+{
+    std::string entropy = BIP39_Utils::base16Decode(mnemonic.entropy);
+    const bool found = contains(reinterpret_cast<const uint8_t*>(entropy.data()), entropy.size());
+    memzero(&entropy[0], entropy.size());
+    return found;
+}
+
+void MnemonicScreen::install(const MnemonicScreen* screen) noexcept
+{
+    installedScreen.store(screen);
+}
+
+const MnemonicScreen* MnemonicScreen::installed() noexcept
+{
+    return installedScreen.load(std::memory_order_acquire);
+}
@@ -0,0 +1,62 @@
+#ifndef SCREEN_H
+#define SCREEN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Mnemonic;
+
+/*
+ * Screening against known-weak or leaked mnemonics.
+ *
+ * A screen file holds an xor filter (8-bit fingerprints, about 9.8 bits per entry and a
+ * 0.4% false positive rate) over the entropies, followed by the sorted entropies themselves
+ * for an exact check of filter hits. The file is mapped read-only, so opening it costs no
+ * more than the pages that lookups touch.
+ */
+class MnemonicScreen
+{
+public:
+    // Builds a screen file from raw entropies (16 to 32 bytes each). Returns the number of
+    // distinct entries written.
+    static size_t build(const std::vector<std::string>& entropies, const std::string& path);
+    // Same from a text file with one hex entropy or English phrase per line; lines that are
+    // neither (and '#' comments) are skipped.
+    static size_t buildFromList(const std::string& listPath, const std::string& path);
+
+    // Maps `path`; throws MnemonicException when it is not a valid screen file.
+    explicit MnemonicScreen(const std::string& path);
+    ~MnemonicScreen();
+    MnemonicScreen(const MnemonicScreen&) = delete;
+    MnemonicScreen& operator=(const MnemonicScreen&) = delete;
+
+    size_t size() const noexcept;
+    // SHA-256 of the whole file, which identifies the screened set.
+    void digest(uint8_t out[32]) const noexcept;
+
+    // Filter only: false means certainly absent, true means present or a false positive.
+    bool mayContain(const uint8_t* entropy, size_t length) const noexcept;
+    // Filter plus exact check of the stored entropies.
+    bool contains(const uint8_t* entropy, size_t length) const noexcept;
+    bool contains(const Mnemonic& mnemonic) const;
+
+    // Screen consulted by BIP39::Generate, BIP39::Entropy and BIP39::Words, or nullptr
+    // (the default). The caller keeps the screen alive while it is installed.
+    static void install(const MnemonicScreen* screen) noexcept;
+    static const MnemonicScreen* installed() noexcept;
+
+private:
+    struct Header;
+
+    const Header* header() const noexcept;
+    const uint8_t* fingerprints() const noexcept;
+    const uint8_t* records() const noexcept;
+
+    const uint8_t* m_data{nullptr};
+    size_t m_size{0};
+    std::vector<uint8_t> m_buffer;    // file contents where mmap is unavailable
+};
+
+#endif // SCREEN_H
@@ -0,0 +1,441 @@
+#include "secp256k1.h"
+#include "pbkdf2_sha512/memzero.h"
+
+#include <cstring>
+#include <vector>
+
+namespace
+{
+typedef unsigned __int128 uint128;
+
+// Field elements mod p = 2^256 - 2^32 - 977 as four little-endian 64-bit limbs, always < p.
+struct Fe
+{
+    uint64_t v[4];
+};
+
+const uint64_t P[4] = {
+    0xfffffffefffffc2fULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL};
+const uint64_t N[4] = {
+    0xbfd25e8cd0364141ULL, 0xbaaedce6af48a03bULL, 0xfffffffffffffffeULL, 0xffffffffffffffffULL};
+constexpr uint64_t P_COMPLEMENT = 0x1000003d1ULL;    // 2^256 mod p
+
+// r = a - m when a >= m, else a; `carry` is a bit above a's top limb.
+inline void reduceOnce(uint64_t* r, const uint64_t* a, uint64_t carry, const uint64_t* m)
+{
+    uint64_t t[4];
+    uint64_t borrow = 0;
+    for (int i = 0; i < 4; i++) {
+        const uint128 d = (uint128)a[i] - m[i] - borrow;
+        t[i] = (uint64_t)d;
+        borrow = (uint64_t)(d >> 64) & 1;
+    }
+    // keep a only when it had no carry and the subtraction borrowed
+    const uint64_t keep = 0 - ((1 - carry) & borrow);
+    for (int i = 0; i < 4; i++) {
+        r[i] = (a[i] & keep) | (t[i] & ~keep);
+    }
+}
+
+inline void feAdd(Fe& r, const Fe& a, const Fe& b)
+{
+    uint64_t s[4];
+    uint128 c = 0;
+    for (int i = 0; i < 4; i++) {
+        c += (uint128)a.v[i] + b.v[i];
+        s[i] = (uint64_t)c;
+        c >>= 64;
+    }
+    reduceOnce(r.v, s, (uint64_t)c, P);
+}
+
+inline void feSub(Fe& r, const Fe& a, const Fe& b)
+{
+    uint64_t d[4];
+    uint64_t borrow = 0;
+    for (int i = 0; i < 4; i++) {
+        const uint128 t = (uint128)a.v[i] - b.v[i] - borrow;
+        d[i] = (uint64_t)t;
+        borrow = (uint64_t)(t >> 64) & 1;
+    }
+    const uint64_t mask = 0 - borrow;
+    uint128 c = 0;
+    for (int i = 0; i < 4; i++) {
+        c += (uint128)d[i] + (P[i] & mask);
+        r.v[i] = (uint64_t)c;
+        c >>= 64;
+    }
+}
+
+void feMul(Fe& r, const Fe& a, const Fe& b)
+{
+    uint64_t w[8] = {};
+    for (int i = 0; i < 4; i++) {
+        uint128 c = 0;
+        for (int j = 0; j < 4; j++) {
+            c += (uint128)a.v[i] * b.v[j] + w[i + j];
+            w[i + j] = (uint64_t)c;
+            c >>= 64;
+        }
+        w[i + 4] = (uint64_t)c;
+    }
+    // fold the high half in twice: 2^256 = P_COMPLEMENT mod p
+    uint64_t s[4];
+    uint128 c = 0;
+    for (int i = 0; i < 4; i++) {
+        c += (uint128)w[i + 4] * P_COMPLEMENT + w[i];
+        s[i] = (uint64_t)c;
+        c >>= 64;
+    }
+    c = (uint128)(uint64_t)c * P_COMPLEMENT;
+    for (int i = 0; i < 4; i++) {
+        c += s[i];
+        s[i] = (uint64_t)c;
+        c >>= 64;
+    }
+    // a last carry leaves s below 2^34, so adding P_COMPLEMENT cannot carry again
+    const uint64_t extra = (uint64_t)c * P_COMPLEMENT;
+    c = (uint128)s[0] + extra;
+    s[0] = (uint64_t)c;
+    c >>= 64;
+    for (int i = 1; i < 4; i++) {
+        c += s[i];
+        s[i] = (uint64_t)c;
+        c >>= 64;
+    }
+    reduceOnce(r.v, s, 0, P);
+}
+
+inline void feSqr(Fe& r, const Fe& a)
+{
+    feMul(r, a, a);
+}
+
+inline void feSqrN(Fe& r, const Fe& a, int n)
+{
+    r = a;
+    for (int i = 0; i < n; i++) {
+        feSqr(r, r);
+    }
+}
+
+// a^(p-2), with the addition chain over runs of ones in p-2 used by libsecp256k1.
+void feInv(Fe& r, const Fe& a)
+{
+    Fe x2, x3, x6, x9, x11, x22, x44, x88, x176, x220, x223, t;
+    feSqr(x2, a);
+    feMul(x2, x2, a);
+    feSqr(x3, x2);
+    feMul(x3, x3, a);
+    feSqrN(x6, x3, 3);
+    feMul(x6, x6, x3);
+    feSqrN(x9, x6, 3);
+    feMul(x9, x9, x3);
+    feSqrN(x11, x9, 2);
+    feMul(x11, x11, x2);
+    feSqrN(x22, x11, 11);
+    feMul(x22, x22, x11);
+    feSqrN(x44, x22, 22);
+    feMul(x44, x44, x22);
+    feSqrN(x88, x44, 44);
+    feMul(x88, x88, x44);
+    feSqrN(x176, x88, 88);
+    feMul(x176, x176, x88);
+    feSqrN(x220, x176, 44);
+    feMul(x220, x220, x44);
+    feSqrN(x223, x220, 3);
+    feMul(x223, x223, x3);
+    feSqrN(t, x223, 23);
+    feMul(t, t, x22);
+    feSqrN(t, t, 5);
+    feMul(t, t, a);
+    feSqrN(t, t, 3);
+    feMul(t, t, x2);
+    feSqrN(t, t, 2);
+    feMul(r, t, a);
+}
+
+void feFromBytes(Fe& r, const uint8_t* b)
+{
+    for (int i = 0; i < 4; i++) {
+        uint64_t v = 0;
+        for (int k = 0; k < 8; k++) {
+            v = v << 8 | b[(3 - i) * 8 + k];
+        }
+        r.v[i] = v;
+    }
+}
+
+void feToBytes(uint8_t* b, const Fe& a)
+{
+    for (int i = 0; i < 4; i++) {
+        for (int k = 0; k < 8; k++) {
+            b[(3 - i) * 8 + k] = (uint8_t)(a.v[i] >> (56 - 8 * k));
+        }
+    }
+}
+
+inline void feCmov(Fe& r, const Fe& a, uint64_t mask)
+{
+    for (int i = 0; i < 4; i++) {
+        r.v[i] = (r.v[i] & ~mask) | (a.v[i] & mask);
+    }
+}
+
+struct Affine
+{
+    Fe x, y;
+};
+
+struct Jacobian
+{
+    Fe x, y, z;
+};
+
+// dbl-2009-l for a = 0.
+void pointDouble(Jacobian& r, const Jacobian& p)
+{
+    Fe a, b, c, d, e, f, t;
+    feSqr(a, p.x);
+    feSqr(b, p.y);
+    feSqr(c, b);
+    feAdd(t, p.x, b);
+    feSqr(t, t);
+    feSub(t, t, a);
+    feSub(t, t, c);
+    feAdd(d, t, t);
+    feAdd(e, a, a);
+    feAdd(e, e, a);
+    feSqr(f, e);
+    Fe z;
+    feMul(z, p.y, p.z);
+    feAdd(r.z, z, z);
+    feSub(r.x, f, d);
+    feSub(r.x, r.x, d);
+    feSub(t, d, r.x);
+    feMul(t, e, t);
+    feAdd(c, c, c);
+    feAdd(c, c, c);
+    feAdd(c, c, c);
+    feSub(r.y, t, c);
+}
+
+// madd-2007-bl: p + q for p != +-q, neither at infinity.
+void pointAddAffine(Jacobian& r, const Jacobian& p, const Affine& q)
+{
+    Fe z1z1, u2, s2, h, hh, i, j, rr, v, t;
+    feSqr(z1z1, p.z);
+    feMul(u2, q.x, z1z1);
+    feMul(s2, q.y, p.z);
+    feMul(s2, s2, z1z1);
+    feSub(h, u2, p.x);
+    feSqr(hh, h);
+    feAdd(i, hh, hh);
+    feAdd(i, i, i);
+    feMul(j, h, i);
+    feSub(rr, s2, p.y);
+    feAdd(rr, rr, rr);
+    feMul(v, p.x, i);
+    Jacobian out;
+    feSqr(out.x, rr);
+    feSub(out.x, out.x, j);
+    feSub(out.x, out.x, v);
+    feSub(out.x, out.x, v);
+    feSub(t, v, out.x);
+    feMul(t, rr, t);
+    feMul(out.y, p.y, j);
+    feAdd(out.y, out.y, out.y);
+    feSub(out.y, t, out.y);
+    feAdd(out.z, p.z, h);
+    feSqr(out.z, out.z);
+    feSub(out.z, out.z, z1z1);
+    feSub(out.z, out.z, hh);
+    r = out;
+}
+
+// Affine coordinates of `count` points with one inversion (Montgomery's trick).
+void toAffine(const Jacobian* points, size_t count, Affine* out)
+{
+    if (count == 0)
+        return;
+    std::vector<Fe> prefix(count);
+    prefix[0] = points[0].z;
+    for (size_t i = 1; i < count; i++) {
+        feMul(prefix[i], prefix[i - 1], points[i].z);
+    }
+    Fe inv;
+    feInv(inv, prefix[count - 1]);
+    for (size_t i = count; i-- > 0;) {
+        Fe zinv = inv;
+        if (i > 0) {
+            feMul(zinv, inv, prefix[i - 1]);
+            feMul(inv, inv, points[i].z);
+        }
+        Fe zinv2, zinv3;
+        feSqr(zinv2, zinv);
+        feMul(zinv3, zinv2, zinv);
+        feMul(out[i].x, points[i].x, zinv2);
+        feMul(out[i].y, points[i].y, zinv3);
+    }
+    memzero(prefix.data(), prefix.size() * sizeof(Fe));
+}
+
+constexpr int WINDOWS = 64;
+constexpr int WINDOW_ENTRIES = 15;
+
+// table[w * 15 + d - 1] = d * 16^w * G
+const Affine* generatorTable()
+{
+    static const std::vector<Affine> table = [] {
+        static const uint8_t GX[32] = {
+            0x79, 0xbe, 0x66, 0x7e, 0xf9, 0xdc, 0xbb, 0xac, 0x55, 0xa0, 0x62,
+            0x95, 0xce, 0x87, 0x0b, 0x07, 0x02, 0x9b, 0xfc, 0xdb, 0x2d, 0xce,
+            0x28, 0xd9, 0x59, 0xf2, 0x81, 0x5b, 0x16, 0xf8, 0x17, 0x98};
+        static const uint8_t GY[32] = {
+            0x48, 0x3a, 0xda, 0x77, 0x26, 0xa3, 0xc4, 0x65, 0x5d, 0xa4, 0xfb,
+            0xfc, 0x0e, 0x11, 0x08, 0xa8, 0xfd, 0x17, 0xb4, 0x48, 0xa6, 0x85,
+            0x54, 0x19, 0x9c, 0x47, 0xd0, 0x8f, 0xfb, 0x10, 0xd4, 0xb8};
+        Affine base;
+        feFromBytes(base.x, GX);
+        feFromBytes(base.y, GY);
+        std::vector<Jacobian> points(WINDOWS * WINDOW_ENTRIES);
+        for (int w = 0; w < WINDOWS; w++) {
+            Jacobian* row = &points[w * WINDOW_ENTRIES];
+            row[0] = Jacobian{base.x, base.y, Fe{{1, 0, 0, 0}}};
+            pointDouble(row[1], row[0]);
+            for (int d = 2; d < WINDOW_ENTRIES; d++) {
+                pointAddAffine(row[d], row[d - 1], base);
+            }
+            // next base: 16 * base = 2 * (8 * base)
+            Jacobian next;
+            pointDouble(next, row[7]);
+            toAffine(&next, 1, &base);
+        }
+        std::vector<Affine> affine(points.size());
+        toAffine(points.data(), points.size(), affine.data());
+        return affine;
+    }();
+    return table.data();
+}
+
+void scalarFromBytes(uint64_t* r, const uint8_t* b)
+{
+    for (int i = 0; i < 4; i++) {
+        uint64_t v = 0;
+        for (int k = 0; k < 8; k++) {
+            v = v << 8 | b[(3 - i) * 8 + k];
+        }
+        r[i] = v;
+    }
+}
+
+// 1 when a < N, without branches.
+uint64_t belowN(const uint64_t* a)
+{
+    uint64_t borrow = 0;
+    for (int i = 0; i < 4; i++) {
+        const uint128 d = (uint128)a[i] - N[i] - borrow;
+        borrow = (uint64_t)(d >> 64) & 1;
+    }
+    return borrow;
+}
+
+uint64_t isZero(const uint64_t* a)
+{
+    const uint64_t any = a[0] | a[1] | a[2] | a[3];
+    return 1 ^ ((any | (0 - any)) >> 63);
+}
+
+// k * G in Jacobian coordinates, for 0 < k < n.
+void generatorMultiply(Jacobian& r, const uint8_t* key)
+{
+    const Affine* table = generatorTable();
+    Jacobian acc{Fe{{0, 0, 0, 0}}, Fe{{0, 0, 0, 0}}, Fe{{1, 0, 0, 0}}};
+    uint64_t infinity = ~0ULL;
+    for (int w = 0; w < WINDOWS; w++) {
+        const uint8_t byte = key[31 - w / 2];
+        const uint64_t digit = w % 2 ? byte >> 4 : byte & 15;
+        Affine entry{Fe{{0, 0, 0, 0}}, Fe{{0, 0, 0, 0}}};
+        for (int d = 0; d < WINDOW_ENTRIES; d++) {
+            const uint64_t eq = (uint64_t)(d + 1) ^ digit;
+            const uint64_t match = ((eq | (0 - eq)) >> 63) - 1;    // all ones when equal
+            feCmov(entry.x, table[w * WINDOW_ENTRIES + d].x, match);
+            feCmov(entry.y, table[w * WINDOW_ENTRIES + d].y, match);
+        }
+        Jacobian sum;
+        pointAddAffine(sum, acc, entry);
+        // the sum is meaningless while acc is at infinity: then the entry itself is taken
+        const Jacobian start{entry.x, entry.y, Fe{{1, 0, 0, 0}}};
+        feCmov(sum.x, start.x, infinity);
+        feCmov(sum.y, start.y, infinity);
+        feCmov(sum.z, start.z, infinity);
+        // a zero digit adds nothing
+        const uint64_t zero = ((digit | (0 - digit)) >> 63) - 1;
+        feCmov(sum.x, acc.x, zero);
+        feCmov(sum.y, acc.y, zero);
+        feCmov(sum.z, acc.z, zero);
+        acc = sum;
+        infinity &= zero;
+        memzero(&entry, sizeof(entry));
+    }
+    r = acc;
+    memzero(&acc, sizeof(acc));
+}
+}    // namespace
+
+bool Secp256k1::isValidPrivateKey(const uint8_t* key) noexcept
+{
+    uint64_t k[4];
+    scalarFromBytes(k, key);
+    const bool valid = belowN(k) & (1 ^ isZero(k));
+    memzero(k, sizeof(k));
+    return valid;
+}
+
+bool Secp256k1::addTweak(uint8_t* key, const uint8_t* tweak) noexcept
+{
+    uint64_t k[4], t[4], s[4];
+    scalarFromBytes(k, key);
+    scalarFromBytes(t, tweak);
+    uint128 c = 0;
+    for (int i = 0; i < 4; i++) {
+        c += (uint128)k[i] + t[i];
+        s[i] = (uint64_t)c;
+        c >>= 64;
+    }
+    reduceOnce(s, s, (uint64_t)c, N);
+    const bool valid = belowN(t) & (1 ^ isZero(s));
+    if (valid) {
+        for (int i = 0; i < 4; i++) {
+            for (int b = 0; b < 8; b++) {
+                key[(3 - i) * 8 + b] = (uint8_t)(s[i] >> (56 - 8 * b));
+            }
+        }
+    }
+    memzero(k, sizeof(k));
+    memzero(t, sizeof(t));
+    memzero(s, sizeof(s));
+    return valid;
+}
+
+void Secp256k1::publicKeys(const uint8_t* keys, size_t count, uint8_t* out)
+{
+    std::vector<Jacobian> points(count);
+    for (size_t i = 0; i < count; i++) {
+        generatorMultiply(points[i], keys + i * PRIVATE_KEY_LENGTH);
+    }
+    std::vector<Affine> affine(count);
+    toAffine(points.data(), count, affine.data());
+    for (size_t i = 0; i < count; i++) {
+        uint8_t* pub = out + i * PUBLIC_KEY_LENGTH;
+        pub[0] = 0x02 | (uint8_t)(affine[i].y.v[0] & 1);
+        feToBytes(pub + 1, affine[i].x);
+    }
+    memzero(points.data(), points.size() * sizeof(Jacobian));
+    memzero(affine.data(), affine.size() * sizeof(Affine));
+}
+
+void Secp256k1::publicKey(const uint8_t* key, uint8_t* out)
+{
+    publicKeys(key, 1, out);
+}
@@ -0,0 +1,34 @@
+#ifndef SECP256K1_H
+#define SECP256K1_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * The parts of secp256k1 that key derivation needs: private key checks and tweaks mod n, and
+ * public keys k*G. Keys are 32-byte big-endian scalars.
+ *
+ * k*G sums one precomputed multiple of 16^w*G per 4-bit window of k. Every table entry of a
+ * window is read and the wanted one selected with masks, and the field arithmetic has no
+ * data-dependent branches, so timing and memory access do not depend on the key.
+ */
+class Secp256k1
+{
+public:
+    static constexpr size_t PRIVATE_KEY_LENGTH = 32;
+    static constexpr size_t PUBLIC_KEY_LENGTH = 33;    // compressed
+
+    // 0 < key < n.
+    static bool isValidPrivateKey(const uint8_t* key) noexcept;
+
+    // key = key + tweak mod n, as in BIP32 private child derivation. Returns false and leaves
+    // key unchanged when tweak >= n or the sum is zero.
+    static bool addTweak(uint8_t* key, const uint8_t* tweak) noexcept;
+
+    // Compressed public keys of `count` back to back valid private keys. The conversion to
+    // affine coordinates shares one field inversion across the batch.
+    static void publicKeys(const uint8_t* keys, size_t count, uint8_t* out);
+    static void publicKey(const uint8_t* key, uint8_t* out);
+};
+
+#endif // SECP256K1_H
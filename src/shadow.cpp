@@ -0,0 +1,201 @@
+#include "shadow.h"
+#include "pbkdf2_sha512/memzero.h"
+#include "pbkdf2_sha512/pbkdf2.hpp"
+#include "trace.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+constexpr size_t MAX_QUEUED = 1024;
+constexpr int SEED_LENGTH = 64;
+constexpr uint32_t ROUNDS = 2048;
+
+struct Sample
+{
+    sha512_kernel kernel;
+    std::string phrase;
+    std::string salt;
+    uint8_t seed[SEED_LENGTH];
+
+    void wipe()
+    {
+        memzero(&phrase[0], phrase.size());
+        memzero(&salt[0], salt.size());
+        memzero(seed, sizeof(seed));
+    }
+};
+
+class Checker
+{
+public:
+    ~Checker()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (worker.joinable())
+            worker.join();
+        for (auto& s : queue) {
+            s.wipe();
+        }
+    }
+
+    void push(Sample&& s)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queue.size() >= MAX_QUEUED) {
+                s.wipe();
+                ++dropped;
+                return;
+            }
+            if (!worker.joinable())
+                worker = std::thread(&Checker::run, this);
+            queue.emplace_back(std::move(s));
+        }
+        wake.notify_one();
+    }
+
+    void drain()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return queue.empty() && !busy; });
+    }
+
+    std::atomic<unsigned> rate{0};
+    std::atomic<bool> disableKernel{true};
+    std::atomic<uint64_t> checked{0};
+    std::atomic<uint64_t> mismatches{0};
+    std::atomic<uint64_t> dropped{0};
+    std::function<void(sha512_kernel)> handler;
+    std::mutex mutex;
+
+private:
+    void run()
+    {
+        Trace::nameThread("shadow checker");
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            {
+                BIP39_TRACE_SCOPE("shadow queue wait");
+                wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            }
+            if (stopping)
+                return;
+            Sample s = std::move(queue.front());
+            queue.pop_front();
+            busy = true;
+            lock.unlock();
+
+            BIP39_TRACE_SCOPE("shadow check");
+            uint8_t reference[SEED_LENGTH];
+            pbkdf2_hmac_sha512(
+                reinterpret_cast<const uint8_t*>(s.phrase.data()),
+                (int)s.phrase.size(),
+                reinterpret_cast<const uint8_t*>(s.salt.data()),
+                (int)s.salt.size(),
+                ROUNDS,
+                reference);
+            const bool match = memcmp(reference, s.seed, SEED_LENGTH) == 0;
+            memzero(reference, sizeof(reference));
+            s.wipe();
+            ++checked;
+            if (!match) {
+                ++mismatches;
+                if (disableKernel)
+                    sha512_kernel_disable(s.kernel);
+            }
+
+            lock.lock();
+            if (!match && handler) {
+                auto h = handler;
+                lock.unlock();
+                h(s.kernel);
+                lock.lock();
+            }
+            busy = false;
+            if (queue.empty())
+                idle.notify_all();
+        }
+    }
+
+    std::deque<Sample> queue;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::thread worker;
+    bool busy{false};
+    bool stopping{false};
+};
+
+Checker& checker()
+{
+    static Checker instance;
+    return instance;
+}
+}    // namespace
+
+void ShadowCheck::enable(unsigned sampleRate, bool disableKernelOnMismatch)
+{
+    checker().disableKernel = disableKernelOnMismatch;
+    checker().rate = sampleRate;
+}
+
+void ShadowCheck::disable()
+{
+    checker().rate = 0;
+}
+
+bool ShadowCheck::enabled() noexcept
+{
+    return checker().rate.load(std::memory_order_relaxed) != 0;
+}
+
+void ShadowCheck::onMismatch(std::function<void(sha512_kernel)> handler)
+{
+    std::lock_guard<std::mutex> lock(checker().mutex);
+    checker().handler = std::move(handler);
+}
+
+uint64_t ShadowCheck::checked() noexcept
+{
+    return checker().checked;
+}
+
+uint64_t ShadowCheck::mismatches() noexcept
+{
+    return checker().mismatches;
+}
+
+uint64_t ShadowCheck::dropped() noexcept
+{
+    return checker().dropped;
+}
+
+void ShadowCheck::drain()
+{
+    checker().drain();
+}
+
+void ShadowCheck::sample(
+    sha512_kernel kernel, const std::string& phrase, const std::string& salt, const uint8_t* seed)
+{
+    const unsigned rate = checker().rate.load(std::memory_order_relaxed);
+    if (rate == 0)
+        return;
+    // per-thread counters keep the sampling decision free of shared writes
+    thread_local uint64_t counter = 0;
+    if (++counter % rate != 0)
+        return;
+
+    Sample s{kernel, phrase, salt, {}};
+    memcpy(s.seed, seed, SEED_LENGTH);
+    checker().push(std::move(s));
+}
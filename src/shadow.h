@@ -0,0 +1,38 @@
+#ifndef SHADOW_H
+#define SHADOW_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "pbkdf2_sha512/sha512_lanes.h"
+
+/*
+ * Shadow mode: a sample of the seeds produced by the accelerated batch path is recomputed
+ * with the scalar pbkdf2_hmac_sha512 on a background thread and compared.
+ */
+class ShadowCheck
+{
+public:
+    // Check one in every `sampleRate` batch results; 0 turns shadow mode off.
+    static void enable(unsigned sampleRate, bool disableKernelOnMismatch = true);
+    static void disable();
+    static bool enabled() noexcept;
+
+    // Called from the background thread with the kernel that produced a wrong seed.
+    static void onMismatch(std::function<void(sha512_kernel)> handler);
+
+    static uint64_t checked() noexcept;
+    static uint64_t mismatches() noexcept;
+    // Samples skipped because the queue was full; the hot path never waits for the checker.
+    static uint64_t dropped() noexcept;
+
+    // Blocks until every queued sample has been checked.
+    static void drain();
+
+    // Hot-path hook of the batch engine, cheap when the result is not sampled.
+    static void sample(
+        sha512_kernel kernel, const std::string& phrase, const std::string& salt, const uint8_t* seed);
+};
+
+#endif // SHADOW_H
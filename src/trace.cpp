@@ -0,0 +1,301 @@
+#include "trace.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    define TRACE_SIGNAL_PIPE 1
+#    include <cerrno>
+#    include <fcntl.h>
+#    include <unistd.h>
+#endif
+
+std::atomic<bool> Trace::s_enabled{false};
+
+namespace
+{
+constexpr size_t CHUNK_EVENTS = 4096;
+// Caps memory at about 24 MiB per thread; later spans of that thread are dropped.
+constexpr size_t MAX_CHUNKS = 256;
+
+struct Event
+{
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+};
+
+struct Chunk
+{
+    Event events[CHUNK_EVENTS];
+    std::atomic<size_t> count{0};
+    std::atomic<Chunk*> next{nullptr};
+};
+
+// Written only by its thread; the count/next release stores publish events to dump().
+struct ThreadBuffer
+{
+    explicit ThreadBuffer(uint32_t id) : tid{id}, head{new Chunk}, tail{head} {}
+    ~ThreadBuffer()
+    {
+        for (Chunk* c = head; c;) {
+            Chunk* next = c->next.load();
+            delete c;
+            c = next;
+        }
+    }
+
+    uint32_t tid;
+    std::atomic<const char*> name{nullptr};
+    Chunk* head;
+    Chunk* tail;
+    size_t chunks{1};
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    // Buffers of exited threads, handed to the next new thread with their events kept, so
+    // the batch engines' short-lived workers do not add a buffer per call.
+    std::vector<ThreadBuffer*> retired;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::string exitPath;
+    std::string signalPath;
+    std::once_flag signalThread;
+};
+
+Registry& registry()
+{
+    static Registry* instance = new Registry;    // outlives threads still tracing at exit
+    return *instance;
+}
+
+// Retires the thread's buffer when the thread exits.
+struct BufferOwner
+{
+    ~BufferOwner()
+    {
+        if (!buffer)
+            return;
+        auto& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.retired.push_back(buffer);
+        buffer = nullptr;
+    }
+
+    ThreadBuffer* buffer = nullptr;
+};
+
+ThreadBuffer& threadBuffer()
+{
+    thread_local BufferOwner owner;
+    if (!owner.buffer) {
+        auto& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (!r.retired.empty()) {
+            owner.buffer = r.retired.back();
+            r.retired.pop_back();
+        } else {
+            r.buffers.emplace_back(new ThreadBuffer((uint32_t)r.buffers.size() + 1));
+            owner.buffer = r.buffers.back().get();
+        }
+    }
+    return *owner.buffer;
+}
+
+#ifdef TRACE_SIGNAL_PIPE
+// Written by the signal handler, read by the dump thread; -1 until dumpOnSignal.
+int signalPipe[2] = {-1, -1};
+
+void onSignal(int)
+{
+    const int saved = errno;
+    const char request = 1;
+    // non-blocking: requests beyond a full pipe are already pending
+    const ssize_t written = write(signalPipe[1], &request, 1);
+    (void)written;
+    errno = saved;
+}
+
+// Dumps once per request, on its own thread so a dump does not wait for workers to make
+// progress: a stalled batch is what it is most often asked for.
+void signalDumpThread()
+{
+    for (;;) {
+        char request;
+        const ssize_t n = read(signalPipe[0], &request, 1);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return;
+        std::string path;
+        {
+            auto& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            path = r.signalPath;
+        }
+        Trace::dump(path);
+    }
+}
+
+void startSignalThread()
+{
+    if (pipe(signalPipe) != 0)
+        return;
+    for (int fd : signalPipe) {
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    fcntl(signalPipe[1], F_SETFL, fcntl(signalPipe[1], F_GETFL) | O_NONBLOCK);
+    std::thread(signalDumpThread).detach();
+}
+#endif
+
+void dumpAtExitHandler()
+{
+    Trace::dump(registry().exitPath);
+}
+
+struct EnvironmentSetup
+{
+    EnvironmentSetup()
+    {
+        const char* path = std::getenv("BIP39_TRACE");
+        if (!path || !*path)
+            return;
+        Trace::enable();
+        Trace::dumpAtExit(path);
+#ifdef SIGUSR1
+        Trace::dumpOnSignal(SIGUSR1, path);
+#endif
+    }
+} environmentSetup;
+}    // namespace
+
+void Trace::enable() noexcept
+{
+    registry();
+    s_enabled.store(true);
+}
+
+void Trace::disable() noexcept
+{
+    s_enabled.store(false);
+}
+
+void Trace::nameThread(const char* name)
+{
+    if (!enabled())
+        return;
+    threadBuffer().name.store(name);
+}
+
+uint64_t Trace::now() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - registry().start)
+        .count();
+}
+
+size_t Trace::bufferCount()
+{
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.buffers.size();
+}
+
+void Trace::record(const char* name, uint64_t begin, uint64_t end) noexcept
+{
+    ThreadBuffer& b = threadBuffer();
+    size_t n = b.tail->count.load(std::memory_order_relaxed);
+    if (n == CHUNK_EVENTS) {
+        if (b.chunks == MAX_CHUNKS)
+            return;
+        Chunk* c = new (std::nothrow) Chunk;
+        if (!c)
+            return;
+        b.tail->next.store(c, std::memory_order_release);
+        b.tail = c;
+        ++b.chunks;
+        n = 0;
+    }
+    b.tail->events[n] = {name, begin, end};
+    b.tail->count.store(n + 1, std::memory_order_release);
+}
+
+bool Trace::dump(const std::string& path)
+{
+    auto& r = registry();
+    std::vector<ThreadBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (auto& b : r.buffers) {
+            buffers.push_back(b.get());
+        }
+    }
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    bool first = true;
+    for (ThreadBuffer* b : buffers) {
+        const char* name = b->name.load();
+        fprintf(
+            file,
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+            "\"args\":{\"name\":\"%s\"}}",
+            first ? "" : ",\n",
+            b->tid,
+            name ? name : "thread");
+        first = false;
+        for (Chunk* c = b->head; c; c = c->next.load(std::memory_order_acquire)) {
+            const size_t count = c->count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < count; i++) {
+                const Event& e = c->events[i];
+                fprintf(
+                    file,
+                    ",\n{\"name\":\"%s\",\"cat\":\"bip39\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                    "\"ts\":%.3f,\"dur\":%.3f}",
+                    e.name,
+                    b->tid,
+                    e.begin / 1000.0,
+                    (e.end - e.begin) / 1000.0);
+            }
+        }
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
+
+void Trace::dumpAtExit(const std::string& path)
+{
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    if (r.exitPath.empty())
+        std::atexit(dumpAtExitHandler);
+    r.exitPath = path;
+}
+
+void Trace::dumpOnSignal(int signal, const std::string& path)
+{
+#ifdef TRACE_SIGNAL_PIPE
+    auto& r = registry();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.signalPath = path;
+    }
+    std::call_once(r.signalThread, startSignalThread);
+    if (signalPipe[1] >= 0)
+        std::signal(signal, onSignal);
+#else
+    (void)signal;
+    (void)path;
+#endif
+}
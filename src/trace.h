@@ -0,0 +1,71 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/*
+ * Optional span tracing exported as Chrome/Perfetto trace-event JSON.
+ *
+ * Every thread appends to its own buffer without locks; buffers are only read by dump().
+ * A thread that exits leaves its buffer, events included, to the next thread that traces.
+ * Setting BIP39_TRACE=<file> enables tracing at startup, dumps at exit and, on POSIX,
+ * whenever SIGUSR1 is received (from a dedicated thread, so a stalled batch still dumps).
+ */
+class Trace
+{
+public:
+    static void enable() noexcept;
+    static void disable() noexcept;
+    static bool enabled() noexcept
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    // Names the calling thread in the trace viewer; ignored while tracing is disabled.
+    static void nameThread(const char* name);
+
+    static bool dump(const std::string& path);
+    static void dumpAtExit(const std::string& path);
+    // Dumps to `path` whenever `signal` arrives. The handler only wakes a dump thread, which
+    // writes the file whatever the traced threads are doing. POSIX only.
+    static void dumpOnSignal(int signal, const std::string& path);
+
+    // Per-thread buffers allocated so far: at most the peak number of tracing threads.
+    static size_t bufferCount();
+
+    static uint64_t now() noexcept;
+    // `name` must have static storage duration.
+    static void record(const char* name, uint64_t begin, uint64_t end) noexcept;
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name) noexcept
+        : m_name{Trace::enabled() ? name : nullptr}
+        , m_begin{m_name ? Trace::now() : 0}
+    {
+    }
+    ~TraceSpan()
+    {
+        if (m_name)
+            Trace::record(m_name, m_begin, Trace::now());
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t m_begin;
+};
+
+#define BIP39_TRACE_CONCAT_(a, b) a##b
+#define BIP39_TRACE_CONCAT(a, b) BIP39_TRACE_CONCAT_(a, b)
+#define BIP39_TRACE_SCOPE(name) TraceSpan BIP39_TRACE_CONCAT(traceSpan_, __LINE__)(name)
+
+#endif // TRACE_H
@@ -1,4 +1,7 @@
 #include "utils.h"
+#include "pbkdf2_sha512/common.h"
+#include "pbkdf2_sha512/memzero.h"
+#include "pbkdf2_sha512/sha2.hpp"
 
 #include <iterator>
 #include <sstream>
@@ -157,4 +160,39 @@ bool hashEquals(const std::string& known, const std::string& user)
     }
     return (result == 0);
 }
+void entropyToWordIndices(const uint8_t* entropy, size_t length, uint16_t* indices)
+{
+    uint32_t stream[16] = {0};
+    uint8_t hash[SHA256_DIGEST_LENGTH];
+    sha256_Raw(entropy, length, hash);
+    for (size_t i = 0; i < length / 4; i++) {
+        stream[i] = ReadBE32(entropy + 4 * i);
+    }
+    stream[length / 4] = (uint32_t)hash[0] << 24;
+    for (size_t p = 0; p < length * 3 / 4; p++) {
+        indices[p] = (uint16_t)readBits(stream, p * 11);
+    }
+    memzero(stream, sizeof(stream));
+    memzero(hash, sizeof(hash));
+}
+
+bool wordIndicesToEntropy(const uint16_t* indices, size_t count, uint8_t* entropy)
+{
+    uint32_t stream[16] = {0};
+    for (size_t p = 0; p < count; p++) {
+        writeBits(stream, p * 11, indices[p]);
+    }
+    const size_t length = count * 4 / 3;
+    for (size_t i = 0; i < length / 4; i++) {
+        WriteBE32(entropy + 4 * i, stream[i]);
+    }
+    uint8_t hash[SHA256_DIGEST_LENGTH];
+    sha256_Raw(entropy, length, hash);
+    const unsigned checksumBits = (unsigned)(count / 3);
+    const bool valid = ((stream[length / 4] >> 24 ^ hash[0]) >> (8 - checksumBits)) == 0;
+    memzero(stream, sizeof(stream));
+    memzero(hash, sizeof(hash));
+    return valid;
+}
+
 }    // namespace BIP39_Utils
@@ -1,6 +1,8 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <sstream>
 #include <string>
@@ -38,6 +40,36 @@ std::string base16Encode(const std::string& input);
 
 bool hashEquals(const std::string& known, const std::string& user);
 
+/*
+ * Mnemonic bit streams: the entropy followed by its checksum, big-endian, in 32-bit words
+ * laid out as in a SHA-256 block. Word `position` of a phrase is the 11 bits at offset
+ * 11 * position. A stream of 16 words holds any phrase, with room to read past its end.
+ */
+inline void writeBits(uint32_t* stream, size_t offset, uint32_t value, size_t bits = 11)
+{
+    const size_t i = offset / 32;
+    const unsigned shift = (unsigned)(64 - offset % 32 - bits);
+    const uint64_t mask = ((uint64_t{1} << bits) - 1) << shift;
+    const uint64_t pair = ((uint64_t)stream[i] << 32 | stream[i + 1]) & ~mask;
+    const uint64_t merged = pair | ((uint64_t)value << shift);
+    stream[i] = (uint32_t)(merged >> 32);
+    stream[i + 1] = (uint32_t)merged;
+}
+
+inline uint32_t readBits(const uint32_t* stream, size_t offset, size_t bits = 11)
+{
+    const size_t i = offset / 32;
+    const uint64_t pair = (uint64_t)stream[i] << 32 | stream[i + 1];
+    return (uint32_t)(pair >> (64 - offset % 32 - bits)) & (uint32_t)((1u << bits) - 1);
+}
+
+// The length * 3 / 4 word indices of `entropy`, 16 to 32 bytes in steps of 4.
+void entropyToWordIndices(const uint8_t* entropy, size_t length, uint16_t* indices);
+
+// The count * 4 / 3 bytes of entropy the word indices (each below 2048) hold, 12 to 24 of
+// them in steps of 3. Returns whether the checksum matches; the entropy is written either way.
+bool wordIndicesToEntropy(const uint16_t* indices, size_t count, uint8_t* entropy);
+
 }    // namespace BIP39_Utils
 
 #endif // UTILS_H
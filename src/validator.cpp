@@ -0,0 +1,126 @@
+#include "validator.h"
+#include "bip39.h"
+#include "pbkdf2_sha512/common.h"
+#include "pbkdf2_sha512/memzero.h"
+#include "pbkdf2_sha512/sha256_lanes.h"
+#include "pbkdf2_sha512/sha2.hpp"
+#include "screen.h"
+#include "utils.h"
+
+PhraseValidator::PhraseValidator(int wordCount, Wordlist* wordlist)
+    : m_wordlist(wordlist), m_wordCount((size_t)wordCount)
+{
+    if (wordCount < 12 || wordCount > 24 || wordCount % 3 != 0)
+        throw MnemonicException("Invalid word count");
+    if (wordlist == nullptr || wordlist->empty())
+        throw MnemonicException("Invalid wordlist");
+}
+
+PhraseValidator::~PhraseValidator()
+{
+    memzero(m_bits, sizeof(m_bits));
+}
+
+PhraseStatus PhraseValidator::push(const char* word, size_t length) noexcept
+{
+    if (m_size == m_wordCount)
+        return PhraseStatus::TooManyWords;
+    const int index = m_wordlist->findIndexCT(word, length);
+    if (index < 0) {
+        m_status = PhraseStatus::UnknownWord;
+        m_errorPosition = (int)m_size;
+        return m_status;
+    }
+    BIP39_Utils::writeBits(m_bits, m_size * 11, (uint32_t)index);
+    m_status = PhraseStatus::Incomplete;
+    m_errorPosition = -1;
+    if (++m_size == m_wordCount)
+        finish();
+    return m_status;
+}
+
+void PhraseValidator::finish() noexcept
+{
+    // the entropy is a whole number of 32-bit words, the checksum starts the next one
+    const size_t entropyWords = m_wordCount / 3;
+    const size_t checksumBits = m_wordCount / 3;
+    uint32_t block[16] = {0};
+    uint32_t state[8];
+    for (size_t i = 0; i < entropyWords; i++) {
+        block[i] = m_bits[i];
+    }
+    block[entropyWords] = 0x80000000;
+    block[15] = (uint32_t)(entropyWords * 32);
+    sha256_Transform_single(sha256_initial_hash_value, block, state);
+    const uint32_t diff = (state[0] ^ m_bits[entropyWords]) >> (32 - checksumBits);
+    memzero(block, sizeof(block));
+    memzero(state, sizeof(state));
+
+    if (diff != 0) {
+        m_status = PhraseStatus::BadChecksum;
+        m_errorPosition = (int)m_wordCount - 1;
+        return;
+    }
+    const MnemonicScreen* screen = MnemonicScreen::installed();
+    if (screen) {
+        uint8_t bytes[32];
+        entropy(bytes);
+        const bool listed = screen->contains(bytes, entropyLength());
+        memzero(bytes, sizeof(bytes));
+        if (listed) {
+            m_status = PhraseStatus::Screened;
+            return;
+        }
+    }
+    m_status = PhraseStatus::Complete;
+}
+
+void PhraseValidator::pop() noexcept
+{
+    if (m_size > 0) {
+        m_size--;
+        BIP39_Utils::writeBits(m_bits, m_size * 11, 0);
+    }
+    m_status = PhraseStatus::Incomplete;
+    m_errorPosition = -1;
+}
+
+void PhraseValidator::reset() noexcept
+{
+    memzero(m_bits, sizeof(m_bits));
+    m_size = 0;
+    m_status = PhraseStatus::Incomplete;
+    m_errorPosition = -1;
+}
+
+uint16_t PhraseValidator::word(size_t position) const noexcept
+{
+    return (uint16_t)BIP39_Utils::readBits(m_bits, position * 11);
+}
+
+void PhraseValidator::entropy(uint8_t* out) const noexcept
+{
+    for (size_t i = 0; i < m_wordCount / 3; i++) {
+        WriteBE32(out + 4 * i, m_bits[i]);
+    }
+}
+
+Mnemonic PhraseValidator::mnemonic() const
+{
+    if (m_status != PhraseStatus::Complete)
+        throw MnemonicException("Phrase is not complete and valid");
+    Mnemonic mnemonic;
+    uint8_t bytes[32];
+    entropy(bytes);
+    mnemonic.entropy = BIP39_Utils::base16Encode(
+        std::string(reinterpret_cast<const char*>(bytes), entropyLength()));
+    memzero(bytes, sizeof(bytes));
+    for (size_t p = 0; p < m_wordCount; p++) {
+        const uint16_t index = word(p);
+        mnemonic.wordsIndex.emplace_back(index);
+        mnemonic.words.emplace_back(m_wordlist->getWord(index));
+        mnemonic.rawBinaryChunks.emplace_back(index);
+        ++mnemonic.m_wordsCount;
+    }
+    return mnemonic;
+}
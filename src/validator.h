@@ -0,0 +1,73 @@
+#ifndef VALIDATOR_H
+#define VALIDATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "mnemonic.h"
+#include "wordlist.h"
+
+enum class PhraseStatus
+{
+    Incomplete,     // every word so far is in the wordlist
+    Complete,       // all words in and the checksum matches
+    UnknownWord,    // the pushed word is not in the wordlist and was not taken
+    TooManyWords,   // returned by a push after the last word; the state is unchanged
+    BadChecksum,    // all words in, the checksum does not match
+    Screened,       // valid, but on the installed screening list
+};
+
+/*
+ * Validates a phrase one word at a time, for restore screens and streaming imports.
+ *
+ * Each push looks the word up in constant time and writes its 11 bits into a packed buffer
+ * that is laid out as the SHA-256 block of the entropy, so the last push checks the checksum
+ * with a single transform. Nothing is allocated after construction and the buffer is wiped
+ * on reset and destruction.
+ */
+class PhraseValidator
+{
+public:
+    // Throws MnemonicException on a word count other than 12, 15, 18, 21 or 24, or an empty
+    // wordlist.
+    explicit PhraseValidator(int wordCount = 12, Wordlist* wordlist = Wordlist::english());
+    ~PhraseValidator();
+    PhraseValidator(const PhraseValidator&) = delete;
+    PhraseValidator& operator=(const PhraseValidator&) = delete;
+
+    // Appends a word; an unknown word is not taken, so the caller can push a correction.
+    PhraseStatus push(const char* word, size_t length) noexcept;
+    PhraseStatus push(const std::string& word) noexcept { return push(word.data(), word.size()); }
+    // Drops the last word, e.g. to retry one that failed the checksum.
+    void pop() noexcept;
+    void reset() noexcept;
+
+    // Status after the last push or pop.
+    PhraseStatus status() const noexcept { return m_status; }
+    // Position of the rejected word for UnknownWord, of the last word for BadChecksum, or -1.
+    int errorPosition() const noexcept { return m_errorPosition; }
+    size_t size() const noexcept { return m_size; }
+    size_t wordCount() const noexcept { return m_wordCount; }
+    size_t entropyLength() const noexcept { return m_wordCount * 4 / 3; }
+    // Wordlist index of the word at `position` < size().
+    uint16_t word(size_t position) const noexcept;
+    // Writes the entropyLength() bytes of entropy of a complete phrase.
+    void entropy(uint8_t* out) const noexcept;
+
+    // The phrase as a Mnemonic; throws MnemonicException unless the status is Complete.
+    Mnemonic mnemonic() const;
+
+private:
+    void finish() noexcept;
+
+    Wordlist* m_wordlist;
+    size_t m_wordCount;
+    size_t m_size{0};
+    PhraseStatus m_status{PhraseStatus::Incomplete};
+    int m_errorPosition{-1};
+    // the words as a big-endian bit stream; 16 words leave room for two-word updates
+    uint32_t m_bits[16]{};
+};
+
+#endif // VALIDATOR_H
@@ -0,0 +1,201 @@
+#include "vanity.h"
+#include "bip39.h"
+#include "hdnode.h"
+#include "pbkdf2_sha512/memzero.h"
+#include "trace.h"
+#include "utils.h"
+#include "watchonly.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+const char BECH32_CHARSET[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+const char BASE58_ALPHABET[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+bool allIn(const std::string& text, size_t from, const char* alphabet)
+{
+    return text.find_first_not_of(alphabet, from) == std::string::npos;
+}
+
+// Matches among `count` seeds: the index of the first one and the string that matched.
+size_t matchSeeds(
+    const BatchConfig& config,
+    const VanityOptions& options,
+    const uint8_t* seeds,
+    size_t count,
+    std::string& match)
+{
+    std::vector<HDNode> masters = HDBatch::masters(config, seeds, count, SeedBatch::SEED_LENGTH);
+    std::vector<std::string> candidates;
+    if (options.target == VanityTarget::Fingerprint) {
+        HDBatch::publicKeys(config, masters);
+        for (const auto& m : masters) {
+            candidates.push_back(BIP39_Utils::base16Encode(
+                std::string(reinterpret_cast<const char*>(m.fingerprint), 4)));
+        }
+        HDBatch::wipe(masters);
+    } else {
+        // m/purpose'/0'/0'/0/0; public keys only where the next step or the address needs them
+        std::vector<HDNode> nodes = std::move(masters);
+        for (uint32_t index : {options.purpose, 0u, 0u}) {
+            auto child = HDBatch::children(config, nodes, {index | HDBatch::HARDENED});
+            HDBatch::wipe(nodes);
+            nodes.swap(child);
+        }
+        std::vector<uint8_t> hashes;
+        for (int level = 0; level < 3; level++) {
+            hashes = HDBatch::publicKeys(config, nodes);
+            if (level == 2)
+                break;
+            auto child = HDBatch::children(config, nodes, {0});
+            HDBatch::wipe(nodes);
+            nodes.swap(child);
+        }
+        HDBatch::wipe(nodes);
+        std::vector<uint8_t> scratch(hashes.size());
+        candidates = WatchOnlyExport::addresses(
+            options.purpose, false, hashes.data(), count, scratch.data());
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (candidates[i].compare(0, options.prefix.size(), options.prefix) == 0) {
+            match = candidates[i];
+            return i;
+        }
+    }
+    return count;
+}
+}    // namespace
+
+VanitySearch::VanitySearch(VanityOptions options) : m_options(std::move(options))
+{
+    const std::string& prefix = m_options.prefix;
+    if (m_options.wordCount < 12 || m_options.wordCount > 24 || m_options.wordCount % 3 != 0)
+        throw MnemonicException("Invalid word count");
+    if (m_options.target == VanityTarget::Fingerprint) {
+        if (prefix.size() > 8 || !allIn(prefix, 0, "0123456789abcdef"))
+            throw MnemonicException("Invalid fingerprint prefix: " + prefix);
+        m_difficulty = std::pow(16.0, (double)prefix.size());
+        return;
+    }
+    switch (m_options.purpose) {
+    case 84:
+        if (prefix.compare(0, 4, "bc1q") != 0 || prefix.size() > 42 ||
+            !allIn(prefix, 4, BECH32_CHARSET))
+            throw MnemonicException("Invalid P2WPKH address prefix: " + prefix);
+        m_difficulty = std::pow(32.0, (double)(prefix.size() - 4));
+        break;
+    case 44:
+    case 49:
+        if (prefix.empty() || prefix[0] != (m_options.purpose == 44 ? '1' : '3') ||
+            prefix.size() > 34 || !allIn(prefix, 1, BASE58_ALPHABET))
+            throw MnemonicException("Invalid Base58 address prefix: " + prefix);
+        m_difficulty = std::pow(58.0, (double)(prefix.size() - 1));
+        break;
+    default:
+        throw MnemonicException("Unsupported purpose");
+    }
+}
+
+VanityResult VanitySearch::run(
+    const std::function<void(const VanityProgress&)>& progress, double interval)
+{
+    BIP39_TRACE_SCOPE("vanity search");
+    const BatchConfig config = HDBatch::config();
+    BatchConfig worker = config;
+    worker.threads = 1;
+    const unsigned threads = m_options.threads ? m_options.threads : config.threads;
+    const size_t batch = m_options.batch ? m_options.batch : 4 * config.lanes;
+    const uint64_t maxAttempts = m_options.maxAttempts;
+
+    std::atomic<uint64_t> claimed{0};     // mnemonics handed to workers
+    std::atomic<uint64_t> attempts{0};    // mnemonics whose addresses were checked
+    std::atomic<bool> done{false};
+    std::mutex mutex;
+    std::condition_variable wake;
+    unsigned running = threads;
+    VanityResult result;
+    std::exception_ptr error;
+    const auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&]() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    auto search = [&]() {
+        std::vector<Mnemonic> mnemonics;
+        std::vector<std::string> phrases;
+        std::vector<uint8_t> seeds(batch * SeedBatch::SEED_LENGTH);
+        try {
+            while (!done.load() && !m_cancelled.load()) {
+                const uint64_t first = claimed.fetch_add(batch);
+                if (maxAttempts && first >= maxAttempts)
+                    break;
+                const size_t count =
+                    maxAttempts ? (size_t)std::min<uint64_t>(batch, maxAttempts - first) : batch;
+                mnemonics.clear();
+                phrases.clear();
+                for (size_t i = 0; i < count; i++) {
+                    mnemonics.push_back(BIP39::Generate(m_options.wordCount));
+                    phrases.push_back(BIP39_Utils::Join(mnemonics.back().words, " "));
+                }
+                SeedBatch::generateSeeds(phrases, m_options.passphrase, seeds.data(), worker);
+                std::string match;
+                const size_t hit = matchSeeds(worker, m_options, seeds.data(), count, match);
+                attempts.fetch_add(count);
+                if (hit < count) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!done.exchange(true)) {
+                        result.found = true;
+                        result.mnemonic = mnemonics[hit];
+                        result.match = match;
+                    }
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+            done.store(true);
+        }
+        memzero(seeds.data(), seeds.size());
+        std::lock_guard<std::mutex> lock(mutex);
+        running--;
+        wake.notify_all();
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (unsigned t = 0; t < threads; t++) {
+        pool.emplace_back(search);
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        const auto period = std::chrono::duration<double>(interval > 0 ? interval : 1.0);
+        while (running > 0) {
+            if (wake.wait_for(lock, period, [&]() { return running == 0; }) || !progress)
+                continue;
+            const double seconds = elapsed();
+            const uint64_t drawn = attempts.load();
+            const double rate = seconds > 0 ? (double)drawn / seconds : 0;
+            lock.unlock();
+            progress({drawn, seconds, rate, rate > 0 ? m_difficulty / rate : INFINITY});
+            lock.lock();
+        }
+    }
+    for (auto& t : pool) {
+        t.join();
+    }
+    if (error)
+        std::rethrow_exception(error);
+
+    result.seconds = elapsed();
+    result.attempts = attempts.load();
+    return result;
+}
@@ -0,0 +1,75 @@
+#ifndef VANITY_H
+#define VANITY_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "mnemonic.h"
+
+enum class VanityTarget
+{
+    Address,        // first receive address, m/purpose'/0'/0'/0/0
+    Fingerprint,    // master key fingerprint, lowercase hex
+};
+
+struct VanityOptions
+{
+    VanityTarget target{VanityTarget::Address};
+    std::string prefix;        // full address prefix ("bc1qxy", "1Ab", "3") or fingerprint hex
+    uint32_t purpose{84};      // 44 P2PKH, 49 P2SH-P2WPKH or 84 P2WPKH
+    int wordCount{12};
+    std::string passphrase;
+    unsigned threads{0};       // 0: the batch configuration's threads
+    size_t batch{0};           // mnemonics per worker round, 0: 4 lane groups
+    uint64_t maxAttempts{0};   // give up after this many mnemonics, 0: no limit
+};
+
+struct VanityProgress
+{
+    uint64_t attempts;
+    double seconds;
+    double rate;               // mnemonics per second
+    double expectedSeconds;    // expected time to a match from now, at this rate
+};
+
+struct VanityResult
+{
+    bool found{false};
+    Mnemonic mnemonic;
+    std::string match;         // the address or fingerprint that matched
+    uint64_t attempts{0};
+    double seconds{0};
+};
+
+/*
+ * Searches random mnemonics for one whose first receive address or master fingerprint starts
+ * with a prefix. Every thread draws fresh mnemonics from BIP39::Generate and runs a round of
+ * them through the lane-parallel PBKDF2 and BIP32 pipelines: only the account, chain and
+ * address keys get public keys, or just the master key for a fingerprint.
+ */
+class VanitySearch
+{
+public:
+    // Throws MnemonicException on a prefix no address of the purpose can start with.
+    explicit VanitySearch(VanityOptions options);
+
+    // Expected number of mnemonics per match; approximate for Base58 prefixes.
+    double difficulty() const noexcept { return m_difficulty; }
+
+    // Blocks until a match, maxAttempts or cancel(), calling `progress` from the calling
+    // thread every `interval` seconds. Returns at once if cancel() came first.
+    VanityResult run(
+        const std::function<void(const VanityProgress&)>& progress = {}, double interval = 1.0);
+
+    // Stops a running search from any thread, or a signal handler.
+    void cancel() noexcept { m_cancelled.store(true); }
+
+private:
+    VanityOptions m_options;
+    double m_difficulty{1};
+    std::atomic<bool> m_cancelled{false};
+};
+
+#endif // VANITY_H
@@ -0,0 +1,208 @@
+#include "watchonly.h"
+#include "address.h"
+#include "bip39.h"
+#include "hdnode.h"
+#include "mnemonic.h"
+#include "pbkdf2_sha512/hash160_lanes.h"
+#include "pbkdf2_sha512/memzero.h"
+#include "trace.h"
+#include "utils.h"
+
+#include <cstring>
+
+namespace
+{
+constexpr uint32_t HARDENED = HDBatch::HARDENED;
+
+inline void storeBE32(uint32_t w, uint8_t* p)
+{
+    p[0] = (uint8_t)(w >> 24);
+    p[1] = (uint8_t)(w >> 16);
+    p[2] = (uint8_t)(w >> 8);
+    p[3] = (uint8_t)w;
+}
+
+uint32_t xpubVersion(uint32_t purpose, bool testnet)
+{
+    switch (purpose) {
+    case 44:
+        return testnet ? 0x043587CF : 0x0488B21E;    // tpub, xpub
+    case 49:
+        return testnet ? 0x044A5262 : 0x049D7CB2;    // upub, ypub
+    case 84:
+        return testnet ? 0x045F1CF6 : 0x04B24746;    // vpub, zpub
+    }
+    throw MnemonicException("Unsupported purpose");
+}
+
+std::string hex(const uint8_t* data, size_t length)
+{
+    return BIP39_Utils::base16Encode(std::string(reinterpret_cast<const char*>(data), length));
+}
+
+void writeStrings(std::ostream& out, const std::vector<std::string>& strings)
+{
+    out << '[';
+    for (size_t i = 0; i < strings.size(); i++) {
+        out << (i ? ",\"" : "\"") << strings[i] << '"';
+    }
+    out << ']';
+}
+
+void writeLE32(std::ostream& out, uint32_t value)
+{
+    const char bytes[4] = {
+        (char)value, (char)(value >> 8), (char)(value >> 16), (char)(value >> 24)};
+    out.write(bytes, sizeof(bytes));
+}
+}    // namespace
+
+std::vector<WatchOnlyWallet> WatchOnlyExport::derive(
+    const std::vector<Mnemonic>& mnemonics, const WatchOnlyOptions& options)
+{
+    for (uint32_t purpose : options.purposes) {
+        xpubVersion(purpose, options.testnet);
+        if (purpose & HARDENED)
+            throw MnemonicException("Unsupported purpose");
+    }
+    if ((options.account & HARDENED) || options.gap > HARDENED)
+        throw MnemonicException("Invalid derivation path");
+    BIP39_TRACE_SCOPE("watch-only export");
+
+    const BatchConfig config = HDBatch::config();
+    const uint32_t coin = options.testnet ? 1 : 0;
+    const size_t wallets = mnemonics.size();
+    const size_t purposes = options.purposes.size();
+    const size_t gap = options.gap;
+
+    std::vector<uint8_t> seeds = SeedBatch::generateSeeds(mnemonics, options.passphrase);
+    std::vector<HDNode> masters =
+        HDBatch::masters(config, seeds.data(), wallets, SeedBatch::SEED_LENGTH);
+    memzero(seeds.data(), seeds.size());
+    HDBatch::publicKeys(config, masters);
+
+    // m/purpose'/coin'/account'/chain/index, one level at a time for all wallets
+    std::vector<uint32_t> purposeIndices;
+    for (uint32_t purpose : options.purposes) {
+        purposeIndices.push_back(purpose | HARDENED);
+    }
+    std::vector<HDNode> purposeNodes = HDBatch::children(config, masters, purposeIndices);
+    std::vector<HDNode> coins = HDBatch::children(config, purposeNodes, {coin | HARDENED});
+    HDBatch::wipe(purposeNodes);
+    HDBatch::publicKeys(config, coins);
+    std::vector<HDNode> accounts = HDBatch::children(config, coins, {options.account | HARDENED});
+    HDBatch::publicKeys(config, accounts);
+    std::vector<HDNode> chains = HDBatch::children(config, accounts, {0, 1});
+    HDBatch::publicKeys(config, chains);
+    std::vector<uint32_t> addressIndices(gap);
+    for (uint32_t i = 0; i < gap; i++) {
+        addressIndices[i] = i;
+    }
+    std::vector<HDNode> leaves = HDBatch::children(config, chains, addressIndices);
+    HDBatch::wipe(chains);
+    const std::vector<uint8_t> keyHashes = HDBatch::publicKeys(config, leaves);
+    HDBatch::wipe(leaves);
+
+    std::vector<WatchOnlyWallet> result(wallets);
+    std::vector<uint8_t> hashes(2 * gap * HASH160_DIGEST_LENGTH);
+    for (size_t w = 0; w < wallets; w++) {
+        memcpy(result[w].fingerprint, masters[w].fingerprint, 4);
+        result[w].accounts.resize(purposes);
+        for (size_t a = 0; a < purposes; a++) {
+            const size_t n = w * purposes + a;
+            const HDNode& node = accounts[n];
+            WatchOnlyAccount& account = result[w].accounts[a];
+            account.purpose = options.purposes[a];
+            account.path = "m/" + std::to_string(account.purpose) + "'/" + std::to_string(coin) +
+                           "'/" + std::to_string(options.account) + "'";
+
+            uint8_t* s = account.serialized;
+            storeBE32(xpubVersion(account.purpose, options.testnet), s);
+            s[4] = 3;
+            memcpy(s + 5, coins[n].fingerprint, 4);
+            storeBE32(options.account | HARDENED, s + 9);
+            memcpy(s + 13, node.chain, 32);
+            memcpy(s + 45, node.pub, 33);
+            account.xpub =
+                AddressCodec::base58CheckEncode(s, WatchOnlyAccount::SERIALIZED_LENGTH);
+
+            std::vector<std::string> strings = WatchOnlyExport::addresses(
+                account.purpose,
+                options.testnet,
+                &keyHashes[n * 2 * gap * HASH160_DIGEST_LENGTH],
+                2 * gap,
+                hashes.data());
+            account.receive.assign(strings.begin(), strings.begin() + gap);
+            account.change.assign(strings.begin() + gap, strings.end());
+            account.receiveHashes.assign(
+                hashes.begin(), hashes.begin() + gap * HASH160_DIGEST_LENGTH);
+            account.changeHashes.assign(hashes.begin() + gap * HASH160_DIGEST_LENGTH, hashes.end());
+        }
+    }
+    HDBatch::wipe(masters);
+    HDBatch::wipe(coins);
+    HDBatch::wipe(accounts);
+    return result;
+}
+
+std::vector<std::string> WatchOnlyExport::addresses(
+    uint32_t purpose, bool testnet, const uint8_t* keyHashes, size_t count, uint8_t* hashes)
+{
+    switch (purpose) {
+    case 44:
+        memcpy(hashes, keyHashes, count * HASH160_DIGEST_LENGTH);
+        return AddressCodec::base58Addresses(testnet ? 0x6f : 0x00, hashes, count);
+    case 49:
+        // P2SH-P2WPKH: the script hash of the redeem script OP_0 <key hash>
+        for (size_t i = 0; i < count; i++) {
+            uint8_t script[2 + HASH160_DIGEST_LENGTH] = {0x00, 0x14};
+            memcpy(script + 2, keyHashes + i * HASH160_DIGEST_LENGTH, HASH160_DIGEST_LENGTH);
+            hash160_Raw(script, sizeof(script), hashes + i * HASH160_DIGEST_LENGTH);
+        }
+        return AddressCodec::base58Addresses(testnet ? 0xc4 : 0x05, hashes, count);
+    default:
+        memcpy(hashes, keyHashes, count * HASH160_DIGEST_LENGTH);
+        return AddressCodec::segwitAddresses(testnet ? "tb" : "bc", hashes, count);
+    }
+}
+
+void WatchOnlyExport::writeJsonl(std::ostream& out, const std::vector<WatchOnlyWallet>& wallets)
+{
+    for (const auto& wallet : wallets) {
+        out << "{\"fingerprint\":\"" << hex(wallet.fingerprint, 4) << "\",\"accounts\":[";
+        for (size_t a = 0; a < wallet.accounts.size(); a++) {
+            const WatchOnlyAccount& account = wallet.accounts[a];
+            out << (a ? "," : "") << "{\"path\":\"" << account.path << "\",\"xpub\":\""
+                << account.xpub << "\",\"receive\":";
+            writeStrings(out, account.receive);
+            out << ",\"change\":";
+            writeStrings(out, account.change);
+            out << '}';
+        }
+        out << "]}\n";
+    }
+}
+
+void WatchOnlyExport::writeBinary(std::ostream& out, const std::vector<WatchOnlyWallet>& wallets)
+{
+    const std::vector<WatchOnlyAccount> none;
+    const auto& first = wallets.empty() ? none : wallets[0].accounts;
+    out.write("BWO1", 4);
+    writeLE32(out, (uint32_t)first.size());
+    writeLE32(out, first.empty() ? 0 : (uint32_t)first[0].receive.size());
+    for (const auto& wallet : wallets) {
+        out.write(reinterpret_cast<const char*>(wallet.fingerprint), 4);
+        for (const auto& account : wallet.accounts) {
+            writeLE32(out, account.purpose);
+            out.write(
+                reinterpret_cast<const char*>(account.serialized),
+                WatchOnlyAccount::SERIALIZED_LENGTH);
+            out.write(
+                reinterpret_cast<const char*>(account.receiveHashes.data()),
+                account.receiveHashes.size());
+            out.write(
+                reinterpret_cast<const char*>(account.changeHashes.data()),
+                account.changeHashes.size());
+        }
+    }
+}
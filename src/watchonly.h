@@ -0,0 +1,69 @@
+#ifndef WATCHONLY_H
+#define WATCHONLY_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class Mnemonic;
+
+struct WatchOnlyOptions
+{
+    std::vector<uint32_t> purposes{44, 49, 84};    // BIP44 P2PKH, BIP49 P2SH-P2WPKH, BIP84 P2WPKH
+    uint32_t account{0};
+    uint32_t gap{20};          // receive and change addresses per account
+    bool testnet{false};       // coin type 1, tpub/upub/vpub, testnet address prefixes
+    std::string passphrase;
+};
+
+struct WatchOnlyAccount
+{
+    static constexpr size_t SERIALIZED_LENGTH = 78;
+
+    uint32_t purpose;
+    std::string path;     // m/84'/0'/0'
+    std::string xpub;     // Base58Check of `serialized`, xpub/ypub/zpub by purpose
+    uint8_t serialized[SERIALIZED_LENGTH];
+    std::vector<std::string> receive, change;
+    // 20 bytes per address: HASH160 of the key, or of the P2SH-P2WPKH redeem script
+    std::vector<uint8_t> receiveHashes, changeHashes;
+};
+
+struct WatchOnlyWallet
+{
+    uint8_t fingerprint[4];    // master key fingerprint
+    std::vector<WatchOnlyAccount> accounts;
+};
+
+/*
+ * Derives account xpubs and the first receive and change addresses for a batch of mnemonics.
+ * Each derivation level is computed for all wallets at once: HMAC-SHA512 runs on the SHA-512
+ * lane kernels, the HMAC key states of a parent are computed once for all its children,
+ * public keys are computed on all batch threads with one field inversion per chunk, and
+ * HASH160s on the HASH160 lane kernels. Private keys are wiped before returning.
+ */
+class WatchOnlyExport
+{
+public:
+    static std::vector<WatchOnlyWallet> derive(
+        const std::vector<Mnemonic>& mnemonics, const WatchOnlyOptions& options = {});
+
+    // Addresses of `count` back to back key HASH160s for a purpose: P2PKH for 44, P2SH-P2WPKH
+    // for 49 and P2WPKH for 84. `hashes` receives the 20-byte hashes the addresses encode.
+    static std::vector<std::string> addresses(
+        uint32_t purpose, bool testnet, const uint8_t* keyHashes, size_t count, uint8_t* hashes);
+
+    // One JSON object per wallet and line.
+    static void writeJsonl(std::ostream& out, const std::vector<WatchOnlyWallet>& wallets);
+
+    /*
+     * Binary export, integers little-endian:
+     *   header: "BWO1", u32 accounts per wallet, u32 gap
+     *   per wallet: 4-byte master fingerprint, then per account: u32 purpose, the 78-byte
+     *   serialized xpub, gap receive and gap change 20-byte hashes
+     */
+    static void writeBinary(std::ostream& out, const std::vector<WatchOnlyWallet>& wallets);
+};
+
+#endif // WATCHONLY_H
@@ -0,0 +1,422 @@
+#include "weakscan.h"
+#include "address.h"
+#include "bip39.h"
+#include "dedup.h"
+#include "hdnode.h"
+#include "pbkdf2_sha512/hash160_lanes.h"
+#include "pbkdf2_sha512/memzero.h"
+#include "pbkdf2_sha512/pbkdf2.hpp"
+#include "screen.h"
+#include "trace.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+constexpr uint32_t HARDENED = HDBatch::HARDENED;
+constexpr size_t MT_N = 624;
+constexpr size_t MT_M = 397;
+
+// The first `count` (at most MT_N - MT_M) outputs of std::mt19937(seed). Only the state
+// words those outputs read are initialized and twisted, about a third of the full state.
+void mt19937Prefix(uint32_t seed, uint32_t* out, size_t count)
+{
+    uint32_t mt[MT_N];
+    const size_t used = count + MT_M + 1;
+    mt[0] = seed;
+    for (size_t i = 1; i < used; i++) {
+        mt[i] = 1812433253u * (mt[i - 1] ^ (mt[i - 1] >> 30)) + (uint32_t)i;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const uint32_t y = (mt[i] & 0x80000000u) | (mt[i + 1] & 0x7fffffffu);
+        uint32_t x = mt[i + MT_M] ^ (y >> 1) ^ ((y & 1) ? 0x9908b0dfu : 0);
+        x ^= x >> 11;
+        x ^= (x << 7) & 0x9d2c5680u;
+        x ^= (x << 15) & 0xefc60000u;
+        out[i] = x ^ (x >> 18);
+    }
+    memzero(mt, used * sizeof(uint32_t));
+}
+
+const char* generatorName(WeakGenerator generator)
+{
+    return generator == WeakGenerator::Mt19937 ? "mt19937" : "minstd";
+}
+
+const char* orderName(WeakByteOrder order)
+{
+    switch (order) {
+    case WeakByteOrder::BigEndian:
+        return "be";
+    case WeakByteOrder::LittleEndian:
+        return "le";
+    default:
+        return "low";
+    }
+}
+
+// Receive address hashes of every purpose for `count` seeds: (seed * purposes + p) *
+// addresses + i, 20 bytes each, as the addresses encode them.
+std::vector<uint8_t> addressHashes(
+    const BatchConfig& config, const WeakScanOptions& options, const uint8_t* seeds, size_t count)
+{
+    std::vector<uint32_t> purposes, indices(options.addresses);
+    for (uint32_t p : options.purposes) {
+        purposes.push_back(p | HARDENED);
+    }
+    for (uint32_t i = 0; i < options.addresses; i++) {
+        indices[i] = i;
+    }
+    std::vector<uint32_t> hardened{HARDENED}, chain{0};
+    std::vector<HDNode> nodes = HDBatch::masters(config, seeds, count, SeedBatch::SEED_LENGTH);
+    for (const std::vector<uint32_t>* level : {&purposes, &hardened, &hardened}) {
+        auto child = HDBatch::children(config, nodes, *level);
+        HDBatch::wipe(nodes);
+        nodes.swap(child);
+    }
+    for (const std::vector<uint32_t>* level : {&chain, &indices}) {
+        HDBatch::publicKeys(config, nodes);
+        auto child = HDBatch::children(config, nodes, *level);
+        HDBatch::wipe(nodes);
+        nodes.swap(child);
+    }
+    std::vector<uint8_t> hashes = HDBatch::publicKeys(config, nodes);
+    HDBatch::wipe(nodes);
+
+    const size_t perSeed = purposes.size() * options.addresses;
+    for (size_t n = 0; n < count * perSeed; n++) {
+        if (options.purposes[n / options.addresses % purposes.size()] != 49)
+            continue;
+        // P2SH-P2WPKH: the script hash of the redeem script OP_0 <key hash>
+        uint8_t script[2 + HASH160_DIGEST_LENGTH] = {0x00, 0x14};
+        memcpy(script + 2, &hashes[n * HASH160_DIGEST_LENGTH], HASH160_DIGEST_LENGTH);
+        hash160_Raw(script, sizeof(script), &hashes[n * HASH160_DIGEST_LENGTH]);
+    }
+    return hashes;
+}
+}    // namespace
+
+size_t WeakSeedScan::buildTargets(
+    const std::vector<std::string>& addresses, const std::string& path, const std::string& hrp)
+{
+    std::vector<std::string> hashes;
+    for (const auto& target : AddressCodec::decodeTargets(addresses, hrp)) {
+        if (!target.valid || target.length != HASH160_DIGEST_LENGTH)
+            continue;
+        if (target.segwit && target.version != 0)
+            continue;
+        hashes.emplace_back(reinterpret_cast<const char*>(target.program), target.length);
+    }
+    return MnemonicScreen::build(hashes, path);
+}
+
+void WeakSeedScan::entropy(
+    WeakGenerator generator,
+    WeakByteOrder order,
+    uint32_t seed,
+    uint8_t* out,
+    size_t length) noexcept
+{
+    uint32_t words[32];
+    const size_t count = order == WeakByteOrder::LowByte ? length : length / 4;
+    if (generator == WeakGenerator::Mt19937) {
+        mt19937Prefix(seed, words, count);
+    } else {
+        std::minstd_rand rng(seed);
+        for (size_t i = 0; i < count; i++) {
+            words[i] = (uint32_t)rng();
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        switch (order) {
+        case WeakByteOrder::BigEndian:
+            for (int b = 0; b < 4; b++) {
+                out[4 * i + b] = (uint8_t)(words[i] >> (24 - 8 * b));
+            }
+            break;
+        case WeakByteOrder::LittleEndian:
+            for (int b = 0; b < 4; b++) {
+                out[4 * i + b] = (uint8_t)(words[i] >> (8 * b));
+            }
+            break;
+        default:
+            out[i] = (uint8_t)words[i];
+        }
+    }
+    memzero(words, sizeof(words));
+}
+
+WeakSeedScan::WeakSeedScan(WeakScanOptions options, const MnemonicScreen& targets)
+    : m_options(std::move(options)), m_targets(targets)
+{
+    const WeakScanOptions& o = m_options;
+    if (o.wordCount < 12 || o.wordCount > 24 || o.wordCount % 3 != 0)
+        throw MnemonicException("Invalid word count");
+    if (o.seedBegin >= o.seedEnd || o.seedEnd > (uint64_t{1} << 32))
+        throw MnemonicException("Invalid seed range");
+    if (o.shards == 0 || o.shard >= o.shards)
+        throw MnemonicException("Invalid shard");
+    if (o.target == WeakScanTarget::Address) {
+        if (o.purposes.empty() || o.addresses == 0)
+            throw MnemonicException("No addresses to derive");
+        for (uint32_t p : o.purposes) {
+            if (p != 44 && p != 49 && p != 84)
+                throw MnemonicException("Unsupported purpose");
+        }
+    }
+    const uint64_t span = o.seedEnd - o.seedBegin;
+    m_begin = o.seedBegin + span * o.shard / o.shards;
+    m_end = o.seedBegin + span * (o.shard + 1) / o.shards;
+    m_next = m_begin;
+    if (!o.checkpointPath.empty()) {
+        m_identity = checkpointIdentity();
+        loadCheckpoint();
+    }
+}
+
+std::string WeakSeedScan::checkpointIdentity() const
+{
+    uint8_t digest[SeedBatch::SEED_LENGTH];
+    m_targets.digest(digest);
+    std::string identity = "targets " +
+                           BIP39_Utils::base16Encode(std::string((const char*)digest, 32)) + '\n';
+    if (m_options.target == WeakScanTarget::Address) {
+        // salted and stretched like a seed, so the passphrase is no easier to guess from the
+        // checkpoint than from the addresses under audit
+        static const char salt[] = "bip39-weakscan passphrase";
+        pbkdf2_hmac_sha512(
+            reinterpret_cast<const uint8_t*>(m_options.passphrase.data()),
+            (int)m_options.passphrase.size(),
+            reinterpret_cast<const uint8_t*>(salt),
+            (int)sizeof(salt) - 1,
+            2048,
+            digest);
+        identity += "passphrase " +
+                    BIP39_Utils::base16Encode(std::string((const char*)digest, 32)) + '\n';
+    }
+    memzero(digest, sizeof(digest));
+    return identity;
+}
+
+std::string WeakSeedScan::checkpointHeader() const
+{
+    std::ostringstream header;
+    header << "bip39-weakscan 2\n"
+           << "generator " << generatorName(m_options.generator) << '\n'
+           << "order " << orderName(m_options.byteOrder) << '\n'
+           << "words " << m_options.wordCount << '\n'
+           << "range " << m_begin << ' ' << m_end << '\n';
+    if (m_options.target == WeakScanTarget::Entropy) {
+        header << "target entropy\n";
+    } else {
+        header << "target address";
+        for (uint32_t p : m_options.purposes) {
+            header << ' ' << p;
+        }
+        header << " x" << m_options.addresses << '\n';
+    }
+    header << m_identity;
+    return header.str();
+}
+
+void WeakSeedScan::loadCheckpoint()
+{
+    std::ifstream in(m_options.checkpointPath);
+    if (!in)
+        return;
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const std::string header = checkpointHeader();
+    uint64_t next = 0;
+    if (text.compare(0, header.size(), header) != 0 ||
+        sscanf(text.c_str() + header.size(), "next %llu", (unsigned long long*)&next) != 1)
+        throw MnemonicException(
+            "Checkpoint does not match the scan options: " + m_options.checkpointPath);
+    m_next = std::min(std::max(next, m_begin), m_end);
+}
+
+void WeakSeedScan::saveCheckpoint(uint64_t next) const
+{
+    // written beside the checkpoint and renamed over it, so a crash leaves the old one intact
+    const std::string temp = m_options.checkpointPath + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::trunc);
+        out << checkpointHeader() << "next " << next << '\n';
+        if (!out.flush())
+            throw MnemonicException("Failed to write checkpoint: " + temp);
+    }
+    if (std::rename(temp.c_str(), m_options.checkpointPath.c_str()) != 0)
+        throw MnemonicException("Failed to write checkpoint: " + m_options.checkpointPath);
+}
+
+uint64_t WeakSeedScan::run(
+    const std::function<void(const WeakScanMatch&)>& match,
+    const std::function<void(const WeakScanProgress&)>& progress,
+    double interval)
+{
+    BIP39_TRACE_SCOPE("weak seed scan");
+    const BatchConfig config = HDBatch::config();
+    BatchConfig worker = config;
+    worker.threads = 1;
+    const unsigned threads = m_options.threads ? m_options.threads : config.threads;
+    const size_t batch = m_options.batch ? m_options.batch : 4 * config.lanes;
+    const size_t length = (size_t)m_options.wordCount * 4 / 3;
+    const bool addresses = m_options.target == WeakScanTarget::Address;
+    const uint64_t start = m_next;
+    const uint64_t blocks = (m_end - start + batch - 1) / batch;
+
+    std::atomic<uint64_t> nextBlock{0};
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::set<uint64_t> finished;    // completed blocks past the contiguous prefix
+    uint64_t doneBlocks = 0;
+    uint64_t matches = 0;
+    unsigned running = threads;
+    std::exception_ptr error;
+    const auto begun = std::chrono::steady_clock::now();
+    auto elapsed = [&]() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - begun).count();
+    };
+    // with the mutex held
+    auto watermark = [&]() { return std::min(m_end, start + doneBlocks * batch); };
+
+    auto scan = [&]() {
+        std::vector<uint8_t> entropies(batch * length);
+        std::vector<std::string> phrases;
+        std::vector<uint8_t> seeds;
+        Trace::nameThread("weak scan worker");
+        try {
+            for (uint64_t b; !m_cancelled.load() && (b = nextBlock.fetch_add(1)) < blocks;) {
+                const uint64_t first = start + b * batch;
+                const size_t count = (size_t)std::min<uint64_t>(batch, m_end - first);
+                for (size_t i = 0; i < count; i++) {
+                    entropy(
+                        m_options.generator,
+                        m_options.byteOrder,
+                        (uint32_t)(first + i),
+                        &entropies[i * length],
+                        length);
+                }
+                std::vector<WeakScanMatch> found;
+                auto report = [&](size_t i, uint32_t purpose, uint32_t index) {
+                    found.push_back({(uint32_t)(first + i),
+                                     BIP39_Utils::base16Encode(std::string(
+                                         reinterpret_cast<const char*>(&entropies[i * length]),
+                                         length)),
+                                     purpose,
+                                     index});
+                };
+                if (!addresses) {
+                    for (size_t i = 0; i < count; i++) {
+                        if (m_targets.contains(&entropies[i * length], length))
+                            report(i, 0, 0);
+                    }
+                } else {
+                    phrases.resize(count);
+                    PackedEntropy key{};
+                    key.key[0] = (uint8_t)length;
+                    for (size_t i = 0; i < count; i++) {
+                        memcpy(key.key + 1, &entropies[i * length], length);
+                        phrases[i] = MnemonicDedup::toPhrase(key);
+                    }
+                    memzero(key.key, sizeof(key.key));
+                    seeds.resize(count * SeedBatch::SEED_LENGTH);
+                    SeedBatch::generateSeeds(phrases, m_options.passphrase, seeds.data(), worker);
+                    for (auto& phrase : phrases) {
+                        memzero(&phrase[0], phrase.size());
+                    }
+                    const std::vector<uint8_t> hashes =
+                        addressHashes(worker, m_options, seeds.data(), count);
+                    memzero(seeds.data(), seeds.size());
+                    const size_t perPurpose = m_options.addresses;
+                    const size_t perSeed = m_options.purposes.size() * perPurpose;
+                    for (size_t n = 0; n < count * perSeed; n++) {
+                        if (m_targets.contains(&hashes[n * HASH160_DIGEST_LENGTH], 20)) {
+                            report(
+                                n / perSeed,
+                                m_options.purposes[n % perSeed / perPurpose],
+                                (uint32_t)(n % perPurpose));
+                        }
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                for (const auto& m : found) {
+                    matches++;
+                    if (match)
+                        match(m);
+                }
+                finished.insert(b);
+                while (!finished.empty() && *finished.begin() == doneBlocks) {
+                    finished.erase(finished.begin());
+                    doneBlocks++;
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+            m_cancelled.store(true);
+        }
+        memzero(entropies.data(), entropies.size());
+        std::lock_guard<std::mutex> lock(mutex);
+        running--;
+        wake.notify_all();
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (unsigned t = 0; t < threads; t++) {
+        pool.emplace_back(scan);
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        const bool checkpoints = !m_options.checkpointPath.empty();
+        const double period = std::max(0.01, interval > 0 ? interval : 1.0);
+        double lastSave = 0;
+        while (running > 0) {
+            wake.wait_for(
+                lock, std::chrono::duration<double>(period), [&]() { return running == 0; });
+            if (running == 0)
+                break;
+            const double seconds = elapsed();
+            const uint64_t next = watermark();
+            if (checkpoints && seconds - lastSave >= m_options.checkpointInterval) {
+                lastSave = seconds;
+                try {
+                    saveCheckpoint(next);
+                } catch (...) {
+                    if (!error)
+                        error = std::current_exception();
+                    m_cancelled.store(true);
+                }
+            }
+            if (progress) {
+                const uint64_t scanned = next - start;
+                lock.unlock();
+                progress({next, m_end, scanned, seconds, seconds > 0 ? scanned / seconds : 0});
+                lock.lock();
+            }
+        }
+    }
+    for (auto& t : pool) {
+        t.join();
+    }
+    m_next = watermark();
+    if (error)
+        std::rethrow_exception(error);
+    if (!m_options.checkpointPath.empty())
+        saveCheckpoint(m_next);
+    return matches;
+}
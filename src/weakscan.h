@@ -0,0 +1,133 @@
+#ifndef WEAKSCAN_H
+#define WEAKSCAN_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class MnemonicScreen;
+
+enum class WeakGenerator
+{
+    Mt19937,    // std::mt19937 seeded with the 32-bit seed
+    Minstd,     // std::minstd_rand, the C++ and many C rand() linear congruential generators
+};
+
+// How generator outputs become entropy bytes.
+enum class WeakByteOrder
+{
+    BigEndian,       // four bytes per output, most significant first
+    LittleEndian,    // four bytes per output, least significant first
+    LowByte,         // one byte per output, its low 8 bits
+};
+
+enum class WeakScanTarget
+{
+    Address,    // the 20-byte hashes of addresses, see WeakSeedScan::buildTargets
+    Entropy,    // the entropies themselves, e.g. MnemonicScreen::buildFromList; no PBKDF2
+};
+
+struct WeakScanOptions
+{
+    WeakGenerator generator{WeakGenerator::Mt19937};
+    WeakByteOrder byteOrder{WeakByteOrder::BigEndian};
+    int wordCount{12};
+    uint64_t seedBegin{0};
+    uint64_t seedEnd{uint64_t{1} << 32};
+    uint32_t shard{0};     // this process's part of [seedBegin, seedEnd), of `shards`
+    uint32_t shards{1};
+    WeakScanTarget target{WeakScanTarget::Address};
+    std::vector<uint32_t> purposes{44, 49, 84};
+    uint32_t addresses{5};     // first receive addresses m/purpose'/0'/0'/0/i per purpose
+    std::string passphrase;
+    unsigned threads{0};       // 0: the batch configuration's threads
+    size_t batch{0};           // seeds per worker round, 0: 4 lane groups
+    std::string checkpointPath;    // progress is resumed from and saved here; empty: none
+    double checkpointInterval{60};
+};
+
+struct WeakScanMatch
+{
+    uint32_t seed;
+    std::string entropy;    // hex
+    uint32_t purpose;       // 0 for an entropy match
+    uint32_t index;         // receive address index
+};
+
+struct WeakScanProgress
+{
+    uint64_t next;       // every seed below this one is done
+    uint64_t end;
+    uint64_t scanned;    // seeds scanned by this run
+    double seconds;
+    double rate;         // seeds per second
+};
+
+/*
+ * Audits mnemonics from weak generators: a PRNG seeded with 32 bits (or a timestamp) can
+ * only ever produce 2^32 entropies, so all of them can be derived and compared against the
+ * addresses under audit.
+ *
+ * Each seed's entropy becomes a packed English mnemonic, a seed from the lane-parallel
+ * PBKDF2 and the first receive addresses of every purpose from the batched BIP32 code; the
+ * address hashes (or, for entropy targets, the entropies) are looked up in a screening
+ * file. Seeds are handed to threads in blocks; --shard splits the range across processes.
+ * The checkpoint records the seed below which every block is done, so an interrupted scan
+ * resumes there and may report matches between that point and the interruption again. It
+ * also records the options, a digest of the targets file and a stretched hash of the
+ * passphrase, and is refused when any of them changed.
+ */
+class WeakSeedScan
+{
+public:
+    // Writes a screening file of the 20-byte hashes of P2PKH, P2SH and P2WPKH addresses
+    // (others are skipped) and returns how many it holds.
+    static size_t buildTargets(
+        const std::vector<std::string>& addresses,
+        const std::string& path,
+        const std::string& hrp = "bc");
+
+    // Entropy of `length` bytes (16 to 32) the generator produces from `seed`.
+    static void entropy(
+        WeakGenerator generator,
+        WeakByteOrder order,
+        uint32_t seed,
+        uint8_t* out,
+        size_t length) noexcept;
+
+    // Throws MnemonicException on invalid options, or a checkpoint written for others.
+    WeakSeedScan(WeakScanOptions options, const MnemonicScreen& targets);
+
+    // First seed of this shard not yet scanned, and the end of the shard.
+    uint64_t next() const noexcept { return m_next; }
+    uint64_t end() const noexcept { return m_end; }
+
+    // Scans the rest of the shard, or until cancel(); a cancel() before run() makes it return
+    // at once. `match` is called under a lock from worker threads, `progress` from the
+    // calling thread every `interval` seconds. Returns the number of matches.
+    uint64_t run(
+        const std::function<void(const WeakScanMatch&)>& match,
+        const std::function<void(const WeakScanProgress&)>& progress = {},
+        double interval = 1.0);
+
+    // Stops a running scan from any thread, or a signal handler; the checkpoint is saved.
+    void cancel() noexcept { m_cancelled.store(true); }
+
+private:
+    std::string checkpointIdentity() const;
+    std::string checkpointHeader() const;
+    void loadCheckpoint();
+    void saveCheckpoint(uint64_t next) const;
+
+    WeakScanOptions m_options;
+    const MnemonicScreen& m_targets;
+    uint64_t m_begin;
+    uint64_t m_end;
+    uint64_t m_next;
+    std::string m_identity;    // checkpoint lines for the targets file and the passphrase
+    std::atomic<bool> m_cancelled{false};
+};
+
+#endif // WEAKSCAN_H
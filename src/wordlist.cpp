@@ -1,14 +1,61 @@
 #include "wordlist.h"
+#include "pbkdf2_sha512/memzero.h"
+#include "probes.h"
+#include "trace.h"
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <fstream>
+#include <map>
+#include <mutex>
 
-std::map<std::string, Wordlist> Wordlist::instances = {};
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#    define WORDLIST_CT_X86 1
+#    include <immintrin.h>
+#endif
+
+namespace
+{
+// A language loaded at most once, failures included; after that, lookups are an atomic load.
+struct LanguageSlot
+{
+    std::once_flag once;
+    std::atomic<Wordlist*> list{nullptr};
+    Wordlist storage;
+
+    Wordlist* get(const char* language)
+    {
+        bool loaded = false;
+        std::call_once(once, [&] {
+            BIP39_PROBE1(wordlist__cache__miss, language);
+            loaded = true;
+            if (storage.Init(language))
+                list.store(&storage, std::memory_order_release);
+        });
+        if (!loaded)
+            BIP39_PROBE1(wordlist__cache__hit, language);
+        return list.load(std::memory_order_acquire);
+    }
+};
+
+const char* const BUILTIN_LANGUAGES[] = {"english", "french", "italian", "spanish"};
+constexpr size_t BUILTIN_COUNT = sizeof(BUILTIN_LANGUAGES) / sizeof(BUILTIN_LANGUAGES[0]);
+
+LanguageSlot builtinSlots[BUILTIN_COUNT];
+
+// Any other language: slots are created under the lock and never freed, so pointers into
+// them stay valid.
+std::mutex otherSlotsMutex;
+std::map<std::string, LanguageSlot> otherSlots;
+}    // namespace
 
 bool Wordlist::Init(const std::string& language) noexcept
 {
+    BIP39_TRACE_SCOPE("wordlist load");
     const std::string wordListFile = language + ".txt";
     std::ifstream file(wordListFile);
     std::string word;
+    m_language = language;
     m_words.reserve(2048);
     m_count = 0;
     while (std::getline(file, word)) {
@@ -21,41 +68,57 @@ bool Wordlist::Init(const std::string& language) noexcept
         m_count = 0;
         return false;
     }
+    packSlots();
     return true;
 }
 
+void Wordlist::packSlots()
+{
+    size_t longest = 0;
+    for (const auto& w : m_words) {
+        longest = std::max(longest, w.size());
+    }
+    m_slotBytes = longest <= 8 ? 8 : longest <= 16 ? 16 : 0;
+    m_slots.assign(m_words.size() * m_slotBytes / 8, 0);
+    for (size_t i = 0; m_slotBytes && i < m_words.size(); i++) {
+        memcpy(reinterpret_cast<uint8_t*>(m_slots.data()) + i * m_slotBytes,
+               m_words[i].data(),
+               m_words[i].size());
+    }
+}
+
 Wordlist* Wordlist::getLanguage(const char* language) noexcept
 {
-    auto it = instances.find(language);
-    if (it != instances.end()) {
-        return &(*it).second;
+    for (size_t i = 0; i < BUILTIN_COUNT; i++) {
+        if (strcmp(language, BUILTIN_LANGUAGES[i]) == 0)
+            return builtinSlots[i].get(BUILTIN_LANGUAGES[i]);
     }
-    auto wordList = Wordlist();
-    if (wordList.Init(language)) {
-        instances[language] = wordList;
-        return &instances[language];
+    LanguageSlot* slot;
+    {
+        std::lock_guard<std::mutex> lock(otherSlotsMutex);
+        slot = &otherSlots[language];
     }
-    return nullptr;
+    return slot->get(language);
 }
 
 Wordlist* Wordlist::english() noexcept
 {
-    return getLanguage("english");
+    return builtinSlots[0].get(BUILTIN_LANGUAGES[0]);
 }
 
 Wordlist* Wordlist::french() noexcept
 {
-    return getLanguage("french");
+    return builtinSlots[1].get(BUILTIN_LANGUAGES[1]);
 }
 
 Wordlist* Wordlist::italian() noexcept
 {
-    return getLanguage("italian");
+    return builtinSlots[2].get(BUILTIN_LANGUAGES[2]);
 }
 
 Wordlist* Wordlist::spanish() noexcept
 {
-    return getLanguage("spanish");
+    return builtinSlots[3].get(BUILTIN_LANGUAGES[3]);
 }
 
 std::string Wordlist::language() const noexcept
@@ -77,6 +140,267 @@ int Wordlist::findIndex(const std::string& searchWord)
     return index;
 }
 
+// Every lookup accumulates (index + 1) of the matching slot into `found` with masks instead of
+// branches, so the whole table is read in the same order whatever the word is.
+static uint64_t ct_scan8_scalar(const uint64_t* slots, size_t count, uint64_t key)
+{
+    uint64_t found = 0;
+    for (size_t i = 0; i < count; i++) {
+        const uint64_t diff = slots[i] ^ key;
+        const uint64_t equal = ((diff | (0 - diff)) >> 63) ^ 1;
+        found |= (0 - equal) & (i + 1);
+    }
+    return found;
+}
+
+static uint64_t ct_scan16_scalar(const uint64_t* slots, size_t count, uint64_t lo, uint64_t hi)
+{
+    uint64_t found = 0;
+    for (size_t i = 0; i < count; i++) {
+        const uint64_t diff = (slots[2 * i] ^ lo) | (slots[2 * i + 1] ^ hi);
+        const uint64_t equal = ((diff | (0 - diff)) >> 63) ^ 1;
+        found |= (0 - equal) & (i + 1);
+    }
+    return found;
+}
+
+// Batched lookups compare every slot read against CT_BATCH keys. Unused keys are zero, which
+// matches no slot since no entry is empty.
+constexpr size_t CT_BATCH = 8;
+
+#ifdef WORDLIST_CT_X86
+
+__attribute__((target("avx2"))) static uint64_t ct_or_lanes(__m256i v)
+{
+    const __m128i x = _mm_or_si128(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return (uint64_t)_mm_cvtsi128_si64(_mm_or_si128(x, _mm_unpackhi_epi64(x, x)));
+}
+
+__attribute__((target("avx2"))) static uint64_t ct_scan8_avx2(
+    const uint64_t* slots, size_t count, uint64_t key)
+{
+    const __m256i k = _mm256_set1_epi64x((long long)key);
+    const __m256i step = _mm256_set1_epi64x(4);
+    __m256i index = _mm256_setr_epi64x(1, 2, 3, 4);
+    __m256i found = _mm256_setzero_si256();
+    for (size_t i = 0; i < count; i += 4) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(slots + i));
+        found = _mm256_or_si256(found, _mm256_and_si256(_mm256_cmpeq_epi64(v, k), index));
+        index = _mm256_add_epi64(index, step);
+    }
+    return ct_or_lanes(found);
+}
+
+__attribute__((target("avx2"))) static uint64_t ct_scan16_avx2(
+    const uint64_t* slots, size_t count, uint64_t lo, uint64_t hi)
+{
+    const __m256i k =
+        _mm256_setr_epi64x((long long)lo, (long long)hi, (long long)lo, (long long)hi);
+    const __m256i step = _mm256_set1_epi64x(2);
+    __m256i index = _mm256_setr_epi64x(1, 1, 2, 2);
+    __m256i found = _mm256_setzero_si256();
+    for (size_t i = 0; i < count; i += 2) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(slots + 2 * i));
+        const __m256i eq = _mm256_cmpeq_epi64(v, k);
+        // a slot matches when both of its halves do
+        const __m256i both = _mm256_and_si256(eq, _mm256_shuffle_epi32(eq, 0x4e));
+        found = _mm256_or_si256(found, _mm256_and_si256(both, index));
+        index = _mm256_add_epi64(index, step);
+    }
+    return ct_or_lanes(found);
+}
+
+__attribute__((target("avx512f"))) static uint64_t ct_scan8_avx512(
+    const uint64_t* slots, size_t count, uint64_t key)
+{
+    const __m512i k = _mm512_set1_epi64((long long)key);
+    const __m512i lane = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    // Four accumulators record the 1-based block number; the slot within the block follows
+    // from which accumulator and lane it landed in, so the loop carries one counter only.
+    __m512i found[4] = {};
+    __m512i block = _mm512_set1_epi64(1);
+    const __m512i one = _mm512_set1_epi64(1);
+    const size_t blocks = count / 32;
+    for (size_t i = 0; i < blocks; i++) {
+        for (int u = 0; u < 4; u++) {
+            const __m512i v = _mm512_loadu_si512((const void*)(slots + 32 * i + 8 * u));
+            found[u] = _mm512_mask_mov_epi64(found[u], _mm512_cmpeq_epi64_mask(v, k), block);
+        }
+        block = _mm512_add_epi64(block, one);
+    }
+    __m512i index = _mm512_setzero_si512();
+    for (int u = 0; u < 4; u++) {
+        // slot + 1 = (block - 1) * 32 + 8u + lane + 1, kept only where a match was recorded
+        const __m512i at = _mm512_add_epi64(
+            _mm512_slli_epi64(_mm512_sub_epi64(found[u], one), 5),
+            _mm512_add_epi64(lane, _mm512_set1_epi64(8 * u + 1)));
+        index = _mm512_or_si512(
+            index, _mm512_maskz_mov_epi64(_mm512_test_epi64_mask(found[u], found[u]), at));
+    }
+    return (uint64_t)_mm512_reduce_or_epi64(index);
+}
+
+__attribute__((target("avx2"))) static void ct_scan8_batch_avx2(
+    const uint64_t* slots, size_t count, const uint64_t* keys, uint64_t* found)
+{
+    __m256i k[CT_BATCH], acc[CT_BATCH];
+    for (size_t q = 0; q < CT_BATCH; q++) {
+        k[q] = _mm256_set1_epi64x((long long)keys[2 * q]);
+        acc[q] = _mm256_setzero_si256();
+    }
+    const __m256i step = _mm256_set1_epi64x(4);
+    __m256i index = _mm256_setr_epi64x(1, 2, 3, 4);
+    for (size_t i = 0; i < count; i += 4) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(slots + i));
+#pragma GCC unroll 8
+        for (size_t q = 0; q < CT_BATCH; q++) {
+            acc[q] = _mm256_or_si256(acc[q], _mm256_and_si256(_mm256_cmpeq_epi64(v, k[q]), index));
+        }
+        index = _mm256_add_epi64(index, step);
+    }
+    for (size_t q = 0; q < CT_BATCH; q++) {
+        found[q] = ct_or_lanes(acc[q]);
+    }
+}
+
+__attribute__((target("avx2"))) static void ct_scan16_batch_avx2(
+    const uint64_t* slots, size_t count, const uint64_t* keys, uint64_t* found)
+{
+    __m256i k[CT_BATCH], acc[CT_BATCH];
+    for (size_t q = 0; q < CT_BATCH; q++) {
+        const long long lo = (long long)keys[2 * q], hi = (long long)keys[2 * q + 1];
+        k[q] = _mm256_setr_epi64x(lo, hi, lo, hi);
+        acc[q] = _mm256_setzero_si256();
+    }
+    const __m256i step = _mm256_set1_epi64x(2);
+    __m256i index = _mm256_setr_epi64x(1, 1, 2, 2);
+    for (size_t i = 0; i < count; i += 2) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(slots + 2 * i));
+#pragma GCC unroll 8
+        for (size_t q = 0; q < CT_BATCH; q++) {
+            const __m256i eq = _mm256_cmpeq_epi64(v, k[q]);
+            const __m256i both = _mm256_and_si256(eq, _mm256_shuffle_epi32(eq, 0x4e));
+            acc[q] = _mm256_or_si256(acc[q], _mm256_and_si256(both, index));
+        }
+        index = _mm256_add_epi64(index, step);
+    }
+    for (size_t q = 0; q < CT_BATCH; q++) {
+        found[q] = ct_or_lanes(acc[q]);
+    }
+}
+
+__attribute__((target("avx512f"))) static void ct_scan8_batch_avx512(
+    const uint64_t* slots, size_t count, const uint64_t* keys, uint64_t* found)
+{
+    __m512i k[CT_BATCH], acc[CT_BATCH];
+    for (size_t q = 0; q < CT_BATCH; q++) {
+        k[q] = _mm512_set1_epi64((long long)keys[2 * q]);
+        acc[q] = _mm512_setzero_si512();
+    }
+    const __m512i step = _mm512_set1_epi64(8);
+    __m512i index = _mm512_setr_epi64(1, 2, 3, 4, 5, 6, 7, 8);
+    for (size_t i = 0; i < count; i += 8) {
+        const __m512i v = _mm512_loadu_si512((const void*)(slots + i));
+#pragma GCC unroll 8
+        for (size_t q = 0; q < CT_BATCH; q++) {
+            acc[q] = _mm512_mask_mov_epi64(acc[q], _mm512_cmpeq_epi64_mask(v, k[q]), index);
+        }
+        index = _mm512_add_epi64(index, step);
+    }
+    for (size_t q = 0; q < CT_BATCH; q++) {
+        found[q] = (uint64_t)_mm512_reduce_or_epi64(acc[q]);
+    }
+}
+
+#endif /* WORDLIST_CT_X86 */
+
+static uint64_t ct_scan(const uint64_t* slots, size_t count, size_t slotBytes, const uint64_t* key)
+{
+#ifdef WORDLIST_CT_X86
+    if (slotBytes == 8 && count % 32 == 0 && __builtin_cpu_supports("avx512f"))
+        return ct_scan8_avx512(slots, count, key[0]);
+    if (slotBytes == 8 && count % 4 == 0 && __builtin_cpu_supports("avx2"))
+        return ct_scan8_avx2(slots, count, key[0]);
+    if (slotBytes == 16 && count % 2 == 0 && __builtin_cpu_supports("avx2"))
+        return ct_scan16_avx2(slots, count, key[0], key[1]);
+#endif
+    if (slotBytes == 8)
+        return ct_scan8_scalar(slots, count, key[0]);
+    return ct_scan16_scalar(slots, count, key[0], key[1]);
+}
+
+static void ct_scan_batch(
+    const uint64_t* slots, size_t count, size_t slotBytes, const uint64_t* keys, uint64_t* found)
+{
+#ifdef WORDLIST_CT_X86
+    if (slotBytes == 8 && count % 8 == 0 && __builtin_cpu_supports("avx512f"))
+        return ct_scan8_batch_avx512(slots, count, keys, found);
+    if (slotBytes == 8 && count % 4 == 0 && __builtin_cpu_supports("avx2"))
+        return ct_scan8_batch_avx2(slots, count, keys, found);
+    if (slotBytes == 16 && count % 2 == 0 && __builtin_cpu_supports("avx2"))
+        return ct_scan16_batch_avx2(slots, count, keys, found);
+#endif
+    // without SIMD the table is scanned per key: the single-key loop compiles tighter than
+    // eight interleaved ones
+    for (size_t q = 0; q < CT_BATCH; q++) {
+        found[q] = ct_scan(slots, count, slotBytes, keys + 2 * q);
+    }
+}
+
+int Wordlist::findIndexCT(const std::string& word) const noexcept
+{
+    return findIndexCT(word.data(), word.size());
+}
+
+int Wordlist::findIndexCT(const char* word, size_t length) const noexcept
+{
+    // the length is not treated as secret: no entry is longer than a slot
+    if (m_slotBytes == 0 || length > m_slotBytes)
+        return -1;
+    uint64_t key[2] = {0, 0};
+    memcpy(key, word, length);
+    // a NUL byte would compare equal to the padding
+    uint64_t nul = 0;
+    for (size_t i = 0; i < length; i++) {
+        nul |= ((uint64_t)(unsigned char)word[i] - 1) >> 63;
+    }
+
+    const uint64_t found = ct_scan(m_slots.data(), m_words.size(), m_slotBytes, key);
+    memzero(key, sizeof(key));
+    return (int)(found & (nul - 1)) - 1;
+}
+
+void Wordlist::findIndexCT(const std::string* words, size_t n, int* out) const noexcept
+{
+    uint64_t keys[2 * CT_BATCH];
+    uint64_t found[CT_BATCH] = {};
+    uint64_t valid[CT_BATCH];
+    for (size_t first = 0; first < n; first += CT_BATCH) {
+        const size_t used = std::min(CT_BATCH, n - first);
+        memset(keys, 0, sizeof(keys));
+        for (size_t q = 0; q < used; q++) {
+            const std::string& word = words[first + q];
+            // as findIndexCT: lengths are public, NUL bytes are masked out
+            valid[q] = m_slotBytes != 0 && word.size() <= m_slotBytes;
+            if (!valid[q])
+                continue;
+            memcpy(keys + 2 * q, word.data(), word.size());
+            uint64_t nul = 0;
+            for (size_t i = 0; i < word.size(); i++) {
+                nul |= ((uint64_t)(unsigned char)word[i] - 1) >> 63;
+            }
+            valid[q] = nul ^ 1;
+        }
+        if (m_slotBytes != 0)
+            ct_scan_batch(m_slots.data(), m_words.size(), m_slotBytes, keys, found);
+        for (size_t q = 0; q < used; q++) {
+            out[first + q] = (int)(found[q] & (0 - valid[q])) - 1;
+        }
+    }
+    memzero(keys, sizeof(keys));
+    memzero(found, sizeof(found));
+}
+
 bool Wordlist::empty() const noexcept
 {
     return m_words.empty();
@@ -1,7 +1,7 @@
 #ifndef WORDLIST_H
 #define WORDLIST_H
 
-#include <map>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -12,6 +12,8 @@ public:
     Wordlist() = default;
     bool Init(const std::string& language) noexcept;
 
+    // Each language is loaded once, on first use; a failed load is remembered and returns
+    // nullptr from then on. Later calls for english/french/italian/spanish take no lock.
     static Wordlist* getLanguage(const char* language) noexcept;
     static Wordlist* english() noexcept;
     static Wordlist* french() noexcept;
@@ -21,11 +23,21 @@ public:
     std::string language() const noexcept;
     std::string getWord(int index) noexcept;
     int findIndex(const std::string& searchWord);
+    // Index of `word`, or -1. Compares against every entry with no branch or memory access
+    // that depends on the word's content; only a word longer than any entry returns early.
+    int findIndexCT(const std::string& word) const noexcept;
+    int findIndexCT(const char* word, size_t length) const noexcept;
+    // Indices of `n` words into `out`, as findIndexCT; one scan of the table serves up to 8.
+    void findIndexCT(const std::string* words, size_t n, int* out) const noexcept;
     bool empty() const noexcept;
 
 private:
-    static std::map<std::string, Wordlist> instances;
+    void packSlots();
+
     std::vector<std::string> m_words;
+    // words zero padded to 8 or 16 bytes, as little-endian 64-bit words, for findIndexCT
+    std::vector<uint64_t> m_slots;
+    size_t m_slotBytes{0};
     std::string m_language;
     int m_count;
 };
@@ -0,0 +1,101 @@
+#include "../src/bip39.h"
+#include "../src/dedup.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static void usage()
+{
+    printf(
+        "usage: bip39-dedup [options] OUTPUT INPUT...\n"
+        "Sorts and deduplicates files of hex entropies or mnemonics (any loaded wordlist),\n"
+        "one per line, and writes the unique entropies in order.\n"
+        "options:\n"
+        "  --format hex|phrase|binary   output records (default hex)\n"
+        "  --memory MB                  in-memory chunk before spilling sorted runs (1024)\n"
+        "  --temp DIR                   directory for the runs (default .)\n"
+        "  --threads N                  parse and sort threads (default all cores)\n"
+        "  --duplicates FILE            write \"hex copies\" for every repeated entropy\n"
+        "  --first-seen                 hash in memory, keep input order instead of sorting\n");
+}
+
+int main(int argc, char** argv)
+{
+    DedupOptions options;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--format") && hasValue) {
+            const std::string format = argv[++i];
+            if (format == "hex") {
+                options.format = DedupFormat::Hex;
+            } else if (format == "phrase") {
+                options.format = DedupFormat::Phrase;
+            } else if (format == "binary") {
+                options.format = DedupFormat::Binary;
+            } else {
+                usage();
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--memory") && hasValue) {
+            options.memoryLimit = (size_t)std::max(1L, atol(argv[++i])) << 20;
+        } else if (!strcmp(argv[i], "--temp") && hasValue) {
+            options.tempDir = argv[++i];
+        } else if (!strcmp(argv[i], "--threads") && hasValue) {
+            options.threads = (unsigned)std::max(0, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--duplicates") && hasValue) {
+            options.duplicatesPath = argv[++i];
+        } else if (!strcmp(argv[i], "--first-seen")) {
+            options.firstSeen = true;
+        } else if (argv[i][0] == '-') {
+            usage();
+            return 2;
+        } else {
+            files.emplace_back(argv[i]);
+        }
+    }
+    if (files.size() < 2) {
+        usage();
+        return 2;
+    }
+    const std::string output = files.front();
+    files.erase(files.begin());
+
+    DedupStats stats;
+    try {
+        stats = MnemonicDedup::run(files, output, options);
+    } catch (const MnemonicException& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    fprintf(
+        stderr,
+        "%llu lines, %llu invalid, %llu records, %llu unique, %llu duplicate records\n",
+        (unsigned long long)stats.lines,
+        (unsigned long long)stats.invalid,
+        (unsigned long long)stats.records,
+        (unsigned long long)stats.unique,
+        (unsigned long long)stats.duplicateRecords);
+    for (const auto& f : stats.formats) {
+        fprintf(stderr, "  %-10s %llu\n", f.first.c_str(), (unsigned long long)f.second);
+    }
+    if (stats.duplicatedKeys) {
+        fprintf(
+            stderr,
+            "%llu entropies repeated, at most %llu times\n",
+            (unsigned long long)stats.duplicatedKeys,
+            (unsigned long long)stats.maxCopies);
+        for (const auto& c : stats.copies) {
+            fprintf(
+                stderr,
+                "  x%-9llu %llu\n",
+                (unsigned long long)c.first,
+                (unsigned long long)c.second);
+        }
+    }
+    if (stats.runs)
+        fprintf(stderr, "merged %zu sorted runs\n", stats.runs);
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "../src/bip39.h"
+#include "../src/utils.h"
+#include "../src/vanity.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static VanitySearch* running = nullptr;
+
+static void interrupt(int)
+{
+    if (running)
+        running->cancel();
+}
+
+static void usage()
+{
+    printf(
+        "usage: bip39-vanity [options] PREFIX\n"
+        "Searches random mnemonics for a first receive address (m/purpose'/0'/0'/0/0) or master\n"
+        "fingerprint starting with PREFIX, on all cores, until a match or Ctrl-C.\n"
+        "options:\n"
+        "  --purpose 44|49|84    address type: P2PKH, P2SH-P2WPKH or P2WPKH (default 84)\n"
+        "  --fingerprint         match the master key fingerprint (hex) instead\n"
+        "  --words N             mnemonic length (default 12)\n"
+        "  --passphrase TEXT     BIP39 passphrase\n"
+        "  --threads N           worker threads (default all cores)\n"
+        "  --max N               give up after N mnemonics\n");
+}
+
+int main(int argc, char** argv)
+{
+    VanityOptions options;
+    bool hasPrefix = false;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--purpose") && hasValue) {
+            options.purpose = (uint32_t)std::max(0L, atol(argv[++i]));
+        } else if (!strcmp(argv[i], "--fingerprint")) {
+            options.target = VanityTarget::Fingerprint;
+        } else if (!strcmp(argv[i], "--words") && hasValue) {
+            options.wordCount = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--passphrase") && hasValue) {
+            options.passphrase = argv[++i];
+        } else if (!strcmp(argv[i], "--threads") && hasValue) {
+            options.threads = (unsigned)std::max(0, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--max") && hasValue) {
+            options.maxAttempts = strtoull(argv[++i], nullptr, 10);
+        } else if (argv[i][0] == '-' || hasPrefix) {
+            usage();
+            return 2;
+        } else {
+            options.prefix = argv[i];
+            hasPrefix = true;
+        }
+    }
+    if (!hasPrefix) {
+        usage();
+        return 2;
+    }
+
+    try {
+        VanitySearch search(options);
+        fprintf(stderr, "difficulty %.0f mnemonics\n", search.difficulty());
+        running = &search;
+        std::signal(SIGINT, interrupt);
+        const VanityResult result = search.run([](const VanityProgress& p) {
+            fprintf(
+                stderr,
+                "%llu mnemonics, %.1f/s, expected %.0f s\n",
+                (unsigned long long)p.attempts,
+                p.rate,
+                p.expectedSeconds);
+        });
+        std::signal(SIGINT, SIG_DFL);
+        running = nullptr;
+        fprintf(
+            stderr,
+            "%llu mnemonics in %.1f s\n",
+            (unsigned long long)result.attempts,
+            result.seconds);
+        if (!result.found)
+            return 1;
+        const std::string phrase = BIP39_Utils::Join(result.mnemonic.words, " ");
+        printf("%s\n%s\n", phrase.c_str(), result.match.c_str());
+    } catch (const MnemonicException& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include "../src/bip39.h"
+#include "../src/mnemonic.h"
+#include "../src/watchonly.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+static void usage()
+{
+    printf(
+        "usage: bip39-watchonly [options] OUTPUT INPUT...\n"
+        "Derives account xpubs and the first receive and change addresses of English mnemonics,\n"
+        "one per line, and writes one JSON object per wallet.\n"
+        "options:\n"
+        "  --binary              write the compact binary export instead\n"
+        "  --purposes LIST       comma separated BIP44/49/84 purposes (default 44,49,84)\n"
+        "  --account N           account index (default 0)\n"
+        "  --gap N               receive and change addresses per account (default 20)\n"
+        "  --testnet             coin type 1 and testnet prefixes\n"
+        "  --passphrase TEXT     BIP39 passphrase of every mnemonic\n"
+        "  --batch N             wallets derived per batch (default 4096)\n");
+}
+
+int main(int argc, char** argv)
+{
+    WatchOnlyOptions options;
+    bool binary = false;
+    size_t batchSize = 4096;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--binary")) {
+            binary = true;
+        } else if (!strcmp(argv[i], "--purposes") && hasValue) {
+            options.purposes.clear();
+            std::stringstream list(argv[++i]);
+            for (std::string item; std::getline(list, item, ',');) {
+                options.purposes.push_back((uint32_t)atol(item.c_str()));
+            }
+        } else if (!strcmp(argv[i], "--account") && hasValue) {
+            options.account = (uint32_t)std::max(0L, atol(argv[++i]));
+        } else if (!strcmp(argv[i], "--gap") && hasValue) {
+            options.gap = (uint32_t)std::max(0L, atol(argv[++i]));
+        } else if (!strcmp(argv[i], "--testnet")) {
+            options.testnet = true;
+        } else if (!strcmp(argv[i], "--passphrase") && hasValue) {
+            options.passphrase = argv[++i];
+        } else if (!strcmp(argv[i], "--batch") && hasValue) {
+            batchSize = (size_t)std::max(1L, atol(argv[++i]));
+        } else if (argv[i][0] == '-') {
+            usage();
+            return 2;
+        } else {
+            files.emplace_back(argv[i]);
+        }
+    }
+    if (files.size() < 2) {
+        usage();
+        return 2;
+    }
+
+    std::ofstream out(files[0], binary ? std::ios::binary : std::ios::out);
+    if (!out) {
+        fprintf(stderr, "Cannot open %s\n", files[0].c_str());
+        return 1;
+    }
+    unsigned long long wallets = 0, invalid = 0;
+    bool header = true;
+    std::vector<Mnemonic> batch;
+    auto flush = [&]() {
+        if (batch.empty())
+            return;
+        auto result = WatchOnlyExport::derive(batch, options);
+        if (binary) {
+            std::ostringstream chunk;
+            WatchOnlyExport::writeBinary(chunk, result);
+            // the 12-byte header only once, in front of the first batch
+            const std::string bytes = chunk.str();
+            out.write(bytes.data() + (header ? 0 : 12), bytes.size() - (header ? 0 : 12));
+            header = false;
+        } else {
+            WatchOnlyExport::writeJsonl(out, result);
+        }
+        wallets += batch.size();
+        batch.clear();
+    };
+
+    try {
+        for (size_t f = 1; f < files.size(); f++) {
+            std::ifstream in(files[f]);
+            if (!in)
+                throw MnemonicException("Cannot open " + files[f]);
+            for (std::string line; std::getline(in, line);) {
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                if (line.empty())
+                    continue;
+                try {
+                    batch.push_back(BIP39::Words(line));
+                } catch (const MnemonicException&) {
+                    invalid++;
+                    continue;
+                }
+                if (batch.size() == batchSize)
+                    flush();
+            }
+        }
+        flush();
+    } catch (const MnemonicException& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    if (binary && header) {
+        WatchOnlyExport::writeBinary(out, {});
+    }
+    fprintf(stderr, "%llu wallets, %llu invalid lines\n", wallets, invalid);
+    return out ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+#include "../src/bip39.h"
+#include "../src/screen.h"
+#include "../src/weakscan.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+static WeakSeedScan* running = nullptr;
+
+static void interrupt(int)
+{
+    if (running)
+        running->cancel();
+}
+
+static void usage()
+{
+    printf(
+        "usage: bip39-weakscan [options] TARGETS\n"
+        "       bip39-weakscan --build ADDRESSES TARGETS\n"
+        "Derives the mnemonic of every seed of a weak 32-bit seeded generator and prints\n"
+        "\"seed entropy purpose index\" for each receive address found in TARGETS, a screening\n"
+        "file built from a list of addresses (or of entropies, with --entropy).\n"
+        "options:\n"
+        "  --build FILE          write TARGETS from one address per line, then exit\n"
+        "  --generator NAME      mt19937 or minstd (default mt19937)\n"
+        "  --order be|le|low     bytes of each output: 4 big/little-endian or the low 1 (be)\n"
+        "  --words N             mnemonic length (default 12)\n"
+        "  --range BEGIN END     seeds to scan (default 0 4294967296)\n"
+        "  --shard K/N           scan part K of N of the range, for separate processes\n"
+        "  --entropy             TARGETS holds entropies: match before any derivation\n"
+        "  --purposes LIST       comma separated BIP44/49/84 purposes (default 44,49,84)\n"
+        "  --addresses N         first receive addresses per purpose (default 5)\n"
+        "  --passphrase TEXT     BIP39 passphrase\n"
+        "  --threads N           worker threads (default all cores)\n"
+        "  --checkpoint FILE     resume from and save progress to FILE every minute\n");
+}
+
+int main(int argc, char** argv)
+{
+    WeakScanOptions options;
+    std::string build, targets;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--build") && hasValue) {
+            build = argv[++i];
+        } else if (!strcmp(argv[i], "--generator") && hasValue) {
+            const std::string name = argv[++i];
+            if (name != "mt19937" && name != "minstd") {
+                usage();
+                return 2;
+            }
+            options.generator = name == "minstd" ? WeakGenerator::Minstd : WeakGenerator::Mt19937;
+        } else if (!strcmp(argv[i], "--order") && hasValue) {
+            const std::string order = argv[++i];
+            if (order == "be") {
+                options.byteOrder = WeakByteOrder::BigEndian;
+            } else if (order == "le") {
+                options.byteOrder = WeakByteOrder::LittleEndian;
+            } else if (order == "low") {
+                options.byteOrder = WeakByteOrder::LowByte;
+            } else {
+                usage();
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--words") && hasValue) {
+            options.wordCount = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--range") && i + 2 < argc) {
+            options.seedBegin = strtoull(argv[++i], nullptr, 0);
+            options.seedEnd = strtoull(argv[++i], nullptr, 0);
+        } else if (!strcmp(argv[i], "--shard") && hasValue) {
+            unsigned shard = 0, shards = 0;
+            if (sscanf(argv[++i], "%u/%u", &shard, &shards) != 2) {
+                usage();
+                return 2;
+            }
+            options.shard = shard;
+            options.shards = shards;
+        } else if (!strcmp(argv[i], "--entropy")) {
+            options.target = WeakScanTarget::Entropy;
+        } else if (!strcmp(argv[i], "--purposes") && hasValue) {
+            options.purposes.clear();
+            std::stringstream list(argv[++i]);
+            for (std::string item; std::getline(list, item, ',');) {
+                options.purposes.push_back((uint32_t)atol(item.c_str()));
+            }
+        } else if (!strcmp(argv[i], "--addresses") && hasValue) {
+            options.addresses = (uint32_t)std::max(0L, atol(argv[++i]));
+        } else if (!strcmp(argv[i], "--passphrase") && hasValue) {
+            options.passphrase = argv[++i];
+        } else if (!strcmp(argv[i], "--threads") && hasValue) {
+            options.threads = (unsigned)std::max(0, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--checkpoint") && hasValue) {
+            options.checkpointPath = argv[++i];
+        } else if (argv[i][0] == '-' || !targets.empty()) {
+            usage();
+            return 2;
+        } else {
+            targets = argv[i];
+        }
+    }
+    if (targets.empty()) {
+        usage();
+        return 2;
+    }
+
+    try {
+        if (!build.empty()) {
+            std::ifstream in(build);
+            if (!in)
+                throw MnemonicException("Failed to read addresses: " + build);
+            std::vector<std::string> addresses;
+            for (std::string line; std::getline(in, line);) {
+                line.erase(line.find_last_not_of(" \t\r") + 1);
+                if (!line.empty())
+                    addresses.push_back(line);
+            }
+            const size_t count = WeakSeedScan::buildTargets(addresses, targets);
+            fprintf(
+                stderr, "%zu of %zu addresses in %s\n", count, addresses.size(), targets.c_str());
+            return 0;
+        }
+
+        MnemonicScreen screen(targets);
+        WeakSeedScan scan(options, screen);
+        fprintf(
+            stderr,
+            "seeds %llu..%llu\n",
+            (unsigned long long)scan.next(),
+            (unsigned long long)scan.end());
+        running = &scan;
+        std::signal(SIGINT, interrupt);
+        const uint64_t matches = scan.run(
+            [](const WeakScanMatch& m) {
+                printf("%u %s %u %u\n", m.seed, m.entropy.c_str(), m.purpose, m.index);
+                fflush(stdout);
+            },
+            [](const WeakScanProgress& p) {
+                fprintf(
+                    stderr,
+                    "next %llu of %llu, %.1f seeds/s\n",
+                    (unsigned long long)p.next,
+                    (unsigned long long)p.end,
+                    p.rate);
+            },
+            10.0);
+        std::signal(SIGINT, SIG_DFL);
+        running = nullptr;
+        fprintf(
+            stderr,
+            "%llu matches, next seed %llu\n",
+            (unsigned long long)matches,
+            (unsigned long long)scan.next());
+        return scan.next() == scan.end() ? 0 : 1;
+    } catch (const MnemonicException& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+}